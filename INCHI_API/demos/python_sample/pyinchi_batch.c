@@ -0,0 +1,345 @@
+/*
+ * International Chemical Identifier (InChI)
+ * Version 1
+ * Software version 1.06
+ * December 15, 2020
+ *
+ * The InChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * Originally developed at NIST.
+ * Modifications and additions by IUPAC and the InChI Trust.
+ * Some portions of code were developed/changed by external contributors
+ * (either contractor or volunteer) which are listed in the file
+ * 'External-contributors' included in this distribution.
+ *
+ * IUPAC/InChI-Trust Licence No.1.0 for the
+ * International Chemical Identifier (InChI)
+ * Copyright (C) IUPAC and InChI Trust
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0,
+ * or any later version.
+ *
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES
+ * whatsoever, whether expressed or implied.
+ * See the IUPAC/InChI-Trust InChI Licence No.1.0 for more details.
+ *
+ * You should have received a copy of the IUPAC/InChI Trust InChI
+ * Licence No. 1.0 with this library; if not, please e-mail:
+ *
+ * info@inchi-trust.org
+ *
+ */
+
+
+
+/*
+    CPython extension module 'inchi_batch' over InChI Software Library.
+
+    Converts many Molfiles per call with MakeINCHIFromMolfileTextBatch()
+    (MakeINCHIFromMolfileTextBatchWithSdfFields() if SDF data are requested):
+    the interpreter lock is released for the whole batch and the records
+    are processed in parallel by the library. str records are passed by
+    their cached UTF-8 buffers and bytes records by their own buffers,
+    so no per-record copy is made on the way in.
+
+    See readme.txt and setup.py for building.
+*/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+
+#include "../../../INCHI_BASE/src/inchi_api.h"
+
+
+/****************************************************************************
+  Get zero-terminated text of str or bytes object; no copy is made.
+  The pointer is valid as long as the object is alive.
+****************************************************************************/
+static const char *get_text( PyObject *obj )
+{
+    if (PyBytes_Check( obj ))
+    {
+        return PyBytes_AS_STRING( obj );
+    }
+    if (PyUnicode_Check( obj ))
+    {
+        return PyUnicode_AsUTF8( obj );
+    }
+    PyErr_SetString( PyExc_TypeError, "records must be str or bytes" );
+
+    return NULL;
+}
+
+
+/****************************************************************************
+  Split SD file text in place into Molfiles at '$$$$' lines.
+  Returns number of records; record pointers are stored in recs
+  (recs == NULL => count only).
+****************************************************************************/
+static Py_ssize_t split_sdf( char *text, const char **recs )
+{
+    Py_ssize_t n = 0;
+    char *p = text, *start = text, *eol;
+
+    while (*p)
+    {
+        eol = strchr( p, '\n' );
+        if (!strncmp( p, "$$$$", 4 ))
+        {
+            if (recs)
+            {
+                recs[n] = start;
+                *p = '\0';
+            }
+            n++;
+            start = eol ? eol + 1 : p + strlen( p );
+        }
+        if (!eol)
+        {
+            break;
+        }
+        p = eol + 1;
+    }
+    /* last record without terminating '$$$$' line */
+    for (p = start; *p && isspace( (unsigned char) *p ); p++)
+    {
+        ;
+    }
+    if (*p)
+    {
+        if (recs)
+        {
+            recs[n] = start;
+        }
+        n++;
+    }
+
+    return n;
+}
+
+
+/****************************************************************************/
+static PyObject *str_or_none( const char *s )
+{
+    if (s && *s)
+    {
+        return PyUnicode_DecodeUTF8( s, (Py_ssize_t) strlen( s ), "replace" );
+    }
+    Py_RETURN_NONE;
+}
+
+
+/****************************************************************************
+  Make dict { label: value } of SDF data items returned by the library
+****************************************************************************/
+static PyObject *sdf_fields_dict( const char *p )
+{
+    PyObject *d, *k, *v;
+    int err;
+
+    if (!p)
+    {
+        Py_RETURN_NONE;
+    }
+    if (!( d = PyDict_New( ) ))
+    {
+        return NULL;
+    }
+    while (*p)
+    {
+        const char *q = p + strlen( p ) + 1;
+        k = str_or_none( p );
+        v = PyUnicode_DecodeUTF8( q, (Py_ssize_t) strlen( q ), "replace" );
+        err = !k || !v || PyDict_SetItem( d, k, v );
+        Py_XDECREF( k );
+        Py_XDECREF( v );
+        if (err)
+        {
+            Py_DECREF( d );
+            return NULL;
+        }
+        p = q + strlen( q ) + 1;
+    }
+
+    return d;
+}
+
+
+/****************************************************************************
+  inchi_batch.from_molfiles( records, options="", key=False, threads=0,
+                             fields=None )
+****************************************************************************/
+static PyObject *from_molfiles( PyObject *self, PyObject *args, PyObject *kwds )
+{
+    static char *kwlist[] = { "records", "options", "key", "threads", "fields", NULL };
+    PyObject *records = NULL, *items = NULL, *res = NULL, *t;
+    const char *options = "", *fields = NULL;
+    int key = 0, threads = 0, ret;
+    Py_ssize_t i, n = 0;
+    char *sdf = NULL, *keys = NULL, *opt = NULL;
+    const char **texts = NULL;
+    inchi_Output *out = NULL;
+    int *codes = NULL;
+    char **values = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords( args, kwds, "O|spiz", kwlist,
+                                      &records, &options, &key, &threads, &fields ))
+    {
+        return NULL;
+    }
+    if (PyBytes_Check( records ) || PyUnicode_Check( records ))
+    {
+        /* whole SD file: one copy of the text, split in place */
+        const char *text = get_text( records );
+        if (!text || !( sdf = strdup( text ) ))
+        {
+            goto nomem;
+        }
+        n = split_sdf( sdf, NULL );
+    }
+    else
+    {
+        /* own the item references while the interpreter lock is released */
+        if (!( items = PySequence_Tuple( records ) ))
+        {
+            return NULL;
+        }
+        n = PyTuple_GET_SIZE( items );
+    }
+    if (n > INT_MAX)
+    {
+        PyErr_SetString( PyExc_OverflowError, "too many records" );
+        goto exit_function;
+    }
+
+    texts = (const char **) calloc( n + 1, sizeof( texts[0] ) );
+    out = (inchi_Output *) calloc( n + 1, sizeof( out[0] ) );
+    codes = (int *) calloc( n + 1, sizeof( codes[0] ) );
+    keys = key ? (char *) calloc( n + 1, INCHI_BATCH_KEY_LEN ) : NULL;
+    values = fields ? (char **) calloc( n + 1, sizeof( values[0] ) ) : NULL;
+    opt = strdup( options );
+    if (!texts || !out || !codes || ( key && !keys ) || ( fields && !values ) || !opt)
+    {
+        goto nomem;
+    }
+    if (sdf)
+    {
+        split_sdf( sdf, texts );
+    }
+    else
+    {
+        for (i = 0; i < n; i++)
+        {
+            if (!( texts[i] = get_text( PyTuple_GET_ITEM( items, i ) ) ))
+            {
+                goto exit_function;
+            }
+        }
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = MakeINCHIFromMolfileTextBatchWithSdfFields( (int) n, texts, opt, fields,
+                                                      out, codes, keys, values, threads );
+    Py_END_ALLOW_THREADS
+
+    if (ret < 0)
+    {
+        PyErr_SetString( PyExc_ValueError, "invalid batch parameters" );
+        goto exit_function;
+    }
+
+    if (!( res = PyList_New( n ) ))
+    {
+        goto exit_function;
+    }
+    for (i = 0; i < n; i++)
+    {
+        t = values
+            ? Py_BuildValue( "(iNNNNNN)", codes[i],
+                             str_or_none( out[i].szInChI ),
+                             str_or_none( out[i].szAuxInfo ),
+                             str_or_none( out[i].szMessage ),
+                             str_or_none( out[i].szLog ),
+                             str_or_none( keys ? keys + i * INCHI_BATCH_KEY_LEN : NULL ),
+                             sdf_fields_dict( values[i] ) )
+            : Py_BuildValue( "(iNNNNN)", codes[i],
+                             str_or_none( out[i].szInChI ),
+                             str_or_none( out[i].szAuxInfo ),
+                             str_or_none( out[i].szMessage ),
+                             str_or_none( out[i].szLog ),
+                             str_or_none( keys ? keys + i * INCHI_BATCH_KEY_LEN : NULL ) );
+        if (!t)
+        {
+            Py_CLEAR( res );
+            goto exit_function;
+        }
+        PyList_SET_ITEM( res, i, t );
+    }
+    goto exit_function;
+
+nomem:
+    if (!PyErr_Occurred( ))
+    {
+        PyErr_NoMemory( );
+    }
+
+exit_function:
+    if (out)
+    {
+        for (i = 0; i < n; i++)
+        {
+            FreeINCHI( out + i );
+        }
+        free( out );
+    }
+    if (values)
+    {
+        for (i = 0; i < n; i++)
+        {
+            FreeINCHISdfFieldValues( values[i] );
+        }
+        free( values );
+    }
+    free( texts );
+    free( codes );
+    free( keys );
+    free( opt );
+    free( sdf );
+    Py_XDECREF( items );
+
+    return res;
+}
+
+
+static PyMethodDef inchi_batch_methods[] =
+{
+    { "from_molfiles", (PyCFunction) (void (*)( void )) from_molfiles, METH_VARARGS | METH_KEYWORDS,
+      "from_molfiles(records, options='', key=False, threads=0, fields=None)\n\n"
+      "records: list of Molfile texts (str or bytes) or a single SD file text.\n"
+      "Returns list of tuples (retcode, inchi, auxinfo, message, log, inchikey);\n"
+      "missing strings are None. threads=0 means one thread per processor.\n"
+      "fields: SDF data item labels separated by commas ('*' for all); if given,\n"
+      "each tuple gets a 7th element, dict {label: value} or None." },
+    { NULL, NULL, 0, NULL }
+};
+
+
+static struct PyModuleDef inchi_batch_module =
+{
+    PyModuleDef_HEAD_INIT, "inchi_batch",
+    "Batch InChI generation over InChI Software Library", -1,
+    inchi_batch_methods
+};
+
+
+/****************************************************************************/
+PyMODINIT_FUNC PyInit_inchi_batch( void )
+{
+    return PyModule_Create( &inchi_batch_module );
+}
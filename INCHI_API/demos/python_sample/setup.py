@@ -0,0 +1,31 @@
+'''
+Build the 'inchi_batch' extension module:
+
+    python3 setup.py build_ext --inplace
+
+The InChI library (libinchi.so.1 / libinchi.dll) must be built first;
+its location may be given in INCHI_LIB_DIR (default ../../bin/Linux).
+'''
+import os
+import sys
+from setuptools import setup, Extension
+
+lib_dir = os.environ.get('INCHI_LIB_DIR', os.path.join('..', '..', 'bin', 'Linux'))
+
+if sys.platform[:3] == 'win':
+    libraries = ['libinchi']
+    extra_link_args = []
+else:
+    # link against the versioned shared object built by libinchi makefile
+    libraries = []
+    extra_link_args = [os.path.join(lib_dir, 'libinchi.so.1'),
+                       '-Wl,-rpath,' + os.path.abspath(lib_dir)]
+
+setup(name='inchi_batch',
+      version='1.6',
+      description='Batch InChI generation over InChI Software Library',
+      ext_modules=[Extension('inchi_batch',
+                             sources=['pyinchi_batch.c'],
+                             library_dirs=[lib_dir],
+                             libraries=libraries,
+                             extra_link_args=extra_link_args)])
@@ -0,0 +1,4 @@
+#!/bin/sh
+mkdir -p ../../../bin/Linux
+make ISLINUX=1 || exit 1
+cd ../../../bin/Linux && LD_LIBRARY_PATH=. ./test_api
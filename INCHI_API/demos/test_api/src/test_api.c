@@ -0,0 +1,531 @@
+/*
+ * International Chemical Identifier (InChI)
+ * Version 1
+ * Software version 1.06
+ * December 15, 2020
+ *
+ * The InChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * Originally developed at NIST.
+ * Modifications and additions by IUPAC and the InChI Trust.
+ * Some portions of code were developed/changed by external contributors
+ * (either contractor or volunteer) which are listed in the file
+ * 'External-contributors' included in this distribution.
+ *
+ * IUPAC/InChI-Trust Licence No.1.0 for the
+ * International Chemical Identifier (InChI)
+ * Copyright (C) IUPAC and InChI Trust
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0,
+ * or any later version.
+ *
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES
+ * whatsoever, whether expressed or implied.
+ * See the IUPAC/InChI-Trust InChI Licence No.1.0 for more details.
+ *
+ * You should have received a copy of the IUPAC/InChI Trust InChI
+ * Licence No. 1.0 with this library; if not, please e-mail:
+ *
+ * info@inchi-trust.org
+ *
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "../../../../INCHI_BASE/src/inchi_api.h"
+
+
+/*
+    Regression tests of InChI API calls whose results are expected
+    to be the same as those of the plain (non-accelerated) code path.
+
+    Usage: test_api
+    Return value: number of failed checks (0 if all passed).
+*/
+
+
+static int nChecks = 0;
+static int nFailed = 0;
+
+
+/****************************************************************************
+ Compare actual and expected return code and string; NULL expected string
+ means that no output string must be produced.
+****************************************************************************/
+static void CheckResult( const char *szWhat,
+                         const char *szInput,
+                         int nRet,
+                         int nExpectedRet,
+                         const char *szOut,
+                         const char *szExpected )
+{
+    int bOk = ( nRet == nExpectedRet );
+
+    if (bOk)
+    {
+        if (!szExpected)
+        {
+            bOk = !szOut || !*szOut;
+        }
+        else
+        {
+            bOk = szOut && !strcmp( szOut, szExpected );
+        }
+    }
+
+    nChecks++;
+    if (!bOk)
+    {
+        nFailed++;
+        fprintf( stderr, "FAILED %s\n  input:    %s\n  got:      %d %s\n  expected: %d %s\n",
+                 szWhat, szInput,
+                 nRet, szOut ? szOut : "(null)",
+                 nExpectedRet, szExpected ? szExpected : "(null)" );
+    }
+}
+
+
+/****************************************************************************
+ GetINCHIfromINCHI: layers dropped as requested by the options,
+ malformed InChI rejected.
+****************************************************************************/
+typedef struct tagInChI2InChICase
+{
+    const char *szOptions;
+    const char *szInChI;
+    int         nRet;
+    const char *szResult;
+} INCHI2INCHI_CASE;
+
+static const INCHI2INCHI_CASE InChI2InChICases[] =
+{
+    /* well-formed input */
+    { "",        "InChI=1S/C2H6O/c1-2-3/h3H,2H2,1H3",
+                 inchi_Ret_OKAY, "InChI=1S/C2H6O/c1-2-3/h3H,2H2,1H3" },
+    { "-FixedH", "InChI=1S/C2H6O/c1-2-3/h3H,2H2,1H3",
+                 inchi_Ret_OKAY, "InChI=1/C2H6O/c1-2-3/h3H,2H2,1H3" },
+    { "",        "InChI=1/C3H6O2/c1-2-3(4)5/h2H2,1H3,(H,4,5)/f/h4H",
+                 inchi_Ret_OKAY, "InChI=1/C3H6O2/c1-2-3(4)5/h2H2,1H3,(H,4,5)" },
+    { "-FixedH", "InChI=1/C3H6O2/c1-2-3(4)5/h2H2,1H3,(H,4,5)/f/h4H",
+                 inchi_Ret_OKAY, "InChI=1/C3H6O2/c1-2-3(4)5/h2H2,1H3,(H,4,5)/f/h4H" },
+    { "",        "InChI=1/C2H6O/c1-2-3/h3H,2H2,1H3/q-1",
+                 inchi_Ret_OKAY, "InChI=1/C2H6O/c1-2-3/h3H,2H2,1H3/q-1" },
+    { "",        "InChI=1/C2H6O/c1-2-3/h3H,2H2,1H3/i1+1",
+                 inchi_Ret_OKAY, "InChI=1/C2H6O/c1-2-3/h3H,2H2,1H3/i1+1" },
+    /* not an option here: the option prefix of this (gcc) build is '-' */
+    { "/FixedH", "InChI=1/C2H4O2/c1-2(3)4/h1H3,(H,3,4)/f/h3H",
+                 inchi_Ret_OKAY, "InChI=1/C2H4O2/c1-2(3)4/h1H3,(H,3,4)" },
+    /* malformed or unusual input */
+    { "",        "InChI=1S/garbage",
+                 inchi_Ret_ERROR, NULL },
+    { "",        "InChI=1S/C2H6O/c1-2-3/h3H,2H2,1H3/q+5/zzz",
+                 inchi_Ret_ERROR, NULL },
+    { "",        "InChI=1S/C2H6O/c1-2-3/h3H,2H2,1H3 extra",
+                 inchi_Ret_ERROR, NULL },
+    { "",        "InChI=1S/C2H6O/c1-2-99/h3H,2H2,1H3",
+                 inchi_Ret_ERROR, NULL },
+    { "",        "InChI=1S/2C2H6O/c2*1-2-3/h2*3H,2*2H2,2*1H3",
+                 inchi_Ret_ERROR, NULL },
+    { "",        "InChI=1/C2H6O/c1-2-3/h3H,2H2,1H4",
+                 inchi_Ret_ERROR, NULL },
+    { "",        "InChI=1/C2H6O/c1-2-3/h3H,2H2,1H3/t9-",
+                 inchi_Ret_ERROR, NULL },
+    { "",        "InChI=1/C3H6O2/c1-2-3(4)5/h2H2,1H3,(H,4,5)/f/h9H",
+                 inchi_Ret_ERROR, NULL },
+    { "-FixedH", "InChI=1/C3H6O2/c1-2-3(4)5/h2H2,1H3,(H,4,5)/f/h9H",
+                 inchi_Ret_ERROR, NULL },
+    { "",        "InChI=1/C3H6O2/c1-2-3(4)5/h2H2,1H3,(H,4,5)/f/h",
+                 inchi_Ret_ERROR, NULL },
+    { "",        "InChI=1/C3H6O2/c1-2-3(4)5/h2H2,1H3/f/h4H",
+                 inchi_Ret_ERROR, NULL },
+    { "",        "InChI=1/C3H6O2/c1-2-3(4)5/h2H2,1H3,(H,4,5)/f/h4H/q+1",
+                 inchi_Ret_OKAY, NULL },
+    { "",        "InChI=1S//c1-2-3",
+                 inchi_Ret_OKAY, NULL }
+};
+
+static void TestInChI2InChI( void )
+{
+    int i;
+    inchi_InputINCHI inp;
+    inchi_Output out;
+
+    for (i = 0; i < (int) ( sizeof( InChI2InChICases ) / sizeof( InChI2InChICases[0] ) ); i++)
+    {
+        int ret;
+        memset( &out, 0, sizeof( out ) );
+        inp.szInChI = (char *) InChI2InChICases[i].szInChI;
+        inp.szOptions = (char *) InChI2InChICases[i].szOptions;
+        ret = GetINCHIfromINCHI( &inp, &out );
+        CheckResult( "GetINCHIfromINCHI", inp.szInChI,
+                     ret, InChI2InChICases[i].nRet,
+                     out.szInChI, InChI2InChICases[i].szResult );
+        FreeINCHI( &out );
+    }
+}
+
+
+/****************************************************************************
+ MakeINCHIFromMolfileTextMultiFlavour: each flavour the same as made by
+ MakeINCHIFromMolfileText; Zn, two acetic acids and water: numbering of
+ identical components in AuxInfo depends on the options of the pass
+****************************************************************************/
+static const char szZnAcetateMolfile[] =
+    "\n"
+    "  test_api\n"
+    "\n"
+    " 10  7  0  0  0  0  0  0  0  0999 V2000\n"
+    "   -0.7692    2.2107    0.0000 O   0  0  0  0  0  0  0  0  0  0  0  0\n"
+    "   -0.7155   -2.3882    0.0000 C   0  0  0  0  0  0  0  0  0  0  0  0\n"
+    "   -1.5040    1.3871    0.0000 C   0  0  0  0  0  0  0  0  0  0  0  0\n"
+    "   -0.5511   -1.9075    0.0000 O   0  0  0  0  0  0  0  0  0  0  0  0\n"
+    "    2.2048   -0.6634    0.0000 O   0  0  0  0  0  0  0  0  0  0  0  0\n"
+    "    1.5716   -2.5684    0.0000 O   0  0  0  0  0  0  0  0  0  0  0  0\n"
+    "    0.7076   -0.3310    0.0000 C   0  0  0  0  0  0  0  0  0  0  0  0\n"
+    "   -2.2066    2.8340    0.0000 Zn  0  0  0  0  0  0  0  0  0  0  0  0\n"
+    "   -2.9681    1.6416    0.0000 O   0  0  0  0  0  0  0  0  0  0  0  0\n"
+    "    2.7608   -2.0049    0.0000 C   0  0  0  0  0  0  0  0  0  0  0  0\n"
+    "  5  2  1  0  0  0  0\n"
+    "  2  6  2  0  0  0  0\n"
+    "  2 10  1  0  0  0  0\n"
+    "  9  7  1  0  0  0  0\n"
+    "  7  4  2  0  0  0  0\n"
+    "  7  3  1  0  0  0  0\n"
+    "  8  5  1  0  0  0  0\n"
+    "M  END\n";
+
+static void TestMultiFlavour( void )
+{
+    static char *szOptions[] = { "", "-RecMet", "-SNon", "-FixedH -RecMet", "/FixedH /SNon" };
+    const int num = (int) ( sizeof( szOptions ) / sizeof( szOptions[0] ) );
+    inchi_Output outputs[sizeof( szOptions ) / sizeof( szOptions[0] )], out;
+    int retcodes[sizeof( szOptions ) / sizeof( szOptions[0] )];
+    int i, ret;
+
+    MakeINCHIFromMolfileTextMultiFlavour( szZnAcetateMolfile, num, szOptions, outputs, retcodes, NULL );
+    for (i = 0; i < num; i++)
+    {
+        memset( &out, 0, sizeof( out ) );
+        ret = MakeINCHIFromMolfileText( szZnAcetateMolfile, szOptions[i], &out );
+        CheckResult( "MakeINCHIFromMolfileTextMultiFlavour InChI", szOptions[i],
+                     retcodes[i], ret, outputs[i].szInChI, out.szInChI );
+        CheckResult( "MakeINCHIFromMolfileTextMultiFlavour AuxInfo", szOptions[i],
+                     retcodes[i], ret, outputs[i].szAuxInfo, out.szAuxInfo );
+        FreeINCHI( &out );
+        FreeINCHI( outputs + i );
+    }
+}
+
+
+/****************************************************************************
+ Molfile of an n x n grid of carbon atoms (n <= 22 to fit V2000 counts):
+ a highly symmetric structure which takes some tens of msec
+****************************************************************************/
+static char *MakeGridMolfile( int n )
+{
+    char *szMol, *p;
+    int i, j, k;
+
+    szMol = (char *) malloc( (size_t) ( 3 * n * n ) * 72 + 128 );
+    if (!szMol)
+    {
+        return NULL;
+    }
+    p = szMol;
+    p += sprintf( p, "grid\n  test_api\n\n%3d%3d  0  0  0  0  0  0  0  0999 V2000\n", n * n, 2 * n * ( n - 1 ) );
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0; j < n; j++)
+        {
+            p += sprintf( p, "%10.4f%10.4f%10.4f C   0  0  0  0  0  0  0  0  0  0  0  0\n", 1.5 * i, 1.5 * j, 0.0 );
+        }
+    }
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0; j < n; j++)
+        {
+            k = i * n + j + 1;
+            if (i + 1 < n)
+            {
+                p += sprintf( p, "%3d%3d  1  0  0  0  0\n", k, k + n );
+            }
+            if (j + 1 < n)
+            {
+                p += sprintf( p, "%3d%3d  1  0  0  0  0\n", k, k + 1 );
+            }
+        }
+    }
+    strcpy( p, "M  END\n" );
+
+    return szMol;
+}
+
+
+/****************************************************************************
+ Threads: InChI made by several threads at once must be the same as made
+ by one thread. The time limit is a few times the time of the slowest
+ record, so it is not exceeded by any thread as long as each thread
+ is timed by its own clock.
+****************************************************************************/
+#define NUM_TEST_THREADS  8
+#define NUM_TEST_RECORDS  2
+#define NUM_TEST_OPTIONS  3
+#define NUM_TEST_CALLS    ( NUM_TEST_RECORDS * NUM_TEST_OPTIONS )
+
+static const char *szThreadMolfile[NUM_TEST_RECORDS];
+static char *szThreadOptions[NUM_TEST_OPTIONS] = { "-WM250", "-WM250 -FixedH -RecMet", "-WM250 -SNon -Key" };
+
+typedef struct tagTestThread
+{
+    int          nFirst;   /* calls are made in rotated order starting from this one */
+    int          nRet[NUM_TEST_CALLS];
+    inchi_Output out[NUM_TEST_CALLS];
+} TEST_THREAD;
+
+static void *TestThreadRun( void *arg )
+{
+    TEST_THREAD *t = (TEST_THREAD *) arg;
+    int i, k;
+
+    for (i = 0; i < NUM_TEST_CALLS; i++)
+    {
+        k = ( t->nFirst + i ) % NUM_TEST_CALLS;
+        t->nRet[k] = MakeINCHIFromMolfileText( szThreadMolfile[k / NUM_TEST_OPTIONS],
+                                               szThreadOptions[k % NUM_TEST_OPTIONS],
+                                               t->out + k );
+    }
+
+    return NULL;
+}
+
+static void TestThreads( void )
+{
+    static TEST_THREAD t[NUM_TEST_THREADS + 1]; /* the last one is the single-threaded reference */
+    TEST_THREAD *ref = t + NUM_TEST_THREADS;
+    pthread_t tid[NUM_TEST_THREADS];
+    char *szGrid;
+    char szWhat[64];
+    int i, k, bStarted[NUM_TEST_THREADS];
+
+    if (!( szGrid = MakeGridMolfile( 22 ) ))
+    {
+        CheckResult( "Threads: out of RAM", "", 1, 0, NULL, NULL );
+        return;
+    }
+    szThreadMolfile[0] = szGrid;
+    szThreadMolfile[1] = szZnAcetateMolfile;
+
+    memset( t, 0, sizeof( t ) );
+    TestThreadRun( ref );
+
+    for (i = 0; i < NUM_TEST_THREADS; i++)
+    {
+        t[i].nFirst = i % NUM_TEST_CALLS;
+        bStarted[i] = !pthread_create( tid + i, NULL, TestThreadRun, t + i );
+        CheckResult( "Threads: pthread_create", "", !bStarted[i], 0, NULL, NULL );
+    }
+    for (i = 0; i < NUM_TEST_THREADS; i++)
+    {
+        if (!bStarted[i])
+        {
+            continue;
+        }
+        pthread_join( tid[i], NULL );
+        for (k = 0; k < NUM_TEST_CALLS; k++)
+        {
+            sprintf( szWhat, "Threads: thread %d record %d InChI", i, k / NUM_TEST_OPTIONS );
+            CheckResult( szWhat, szThreadOptions[k % NUM_TEST_OPTIONS],
+                         t[i].nRet[k], ref->nRet[k], t[i].out[k].szInChI, ref->out[k].szInChI );
+            sprintf( szWhat, "Threads: thread %d record %d AuxInfo", i, k / NUM_TEST_OPTIONS );
+            CheckResult( szWhat, szThreadOptions[k % NUM_TEST_OPTIONS],
+                         t[i].nRet[k], ref->nRet[k], t[i].out[k].szAuxInfo, ref->out[k].szAuxInfo );
+            FreeINCHI( t[i].out + k );
+        }
+    }
+    for (k = 0; k < NUM_TEST_CALLS; k++)
+    {
+        CheckResult( "Threads: single-threaded run", szThreadOptions[k % NUM_TEST_OPTIONS],
+                     ref->nRet[k] == inchi_Ret_OKAY || ref->nRet[k] == inchi_Ret_WARNING, 1, NULL, NULL );
+        FreeINCHI( ref->out + k );
+    }
+    free( szGrid );
+}
+
+
+/****************************************************************************
+ Pool: InChI made by pooled generators, each stage run by its own thread,
+ must be the same as made by GetINCHI. There are fewer jobs than records,
+ so the reader thread waits for the writer thread to release jobs.
+****************************************************************************/
+#define NUM_POOL_JOBS     3
+#define NUM_POOL_RECORDS  8
+
+typedef struct tagTestPool
+{
+    INCHIGEN_POOL_HANDLE pool;
+    int                  nStage;                        /* stage run by this worker */
+    inchi_Input         *pInp;                          /* the records */
+    int                  nRet[NUM_POOL_RECORDS];        /* filled by the writer */
+    char                *szInChI[NUM_POOL_RECORDS];
+} TEST_POOL;
+
+/* n x n grid of carbon atoms; the hydrogens are added by InChI */
+static inchi_Atom *MakeGridAtoms( int n )
+{
+    inchi_Atom *at;
+    int i, j, k;
+
+    at = (inchi_Atom *) calloc( (size_t) ( n * n ), sizeof( at[0] ) );
+    if (!at)
+    {
+        return NULL;
+    }
+    for (i = 0; i < n; i++)
+    {
+        for (j = 0; j < n; j++)
+        {
+            k = i * n + j;
+            strcpy( at[k].elname, "C" );
+            at[k].x = 1.5 * i;
+            at[k].y = 1.5 * j;
+            at[k].num_iso_H[0] = -1;
+            if (i + 1 < n)
+            {
+                at[k].neighbor[at[k].num_bonds] = (AT_NUM) ( k + n );
+                at[k].bond_type[at[k].num_bonds++] = INCHI_BOND_TYPE_SINGLE;
+            }
+            if (j + 1 < n)
+            {
+                at[k].neighbor[at[k].num_bonds] = (AT_NUM) ( k + 1 );
+                at[k].bond_type[at[k].num_bonds++] = INCHI_BOND_TYPE_SINGLE;
+            }
+        }
+    }
+
+    return at;
+}
+
+static void *TestPoolWorker( void *arg )
+{
+    TEST_POOL *t = (TEST_POOL *) arg;
+    INCHIGEN_JOB *job;
+
+    while (( job = INCHIGEN_POOL_Next( t->pool, t->nStage, 1 ) ))
+    {
+        INCHIGEN_POOL_DoNextStage( job );
+        INCHIGEN_POOL_Submit( t->pool, job );
+    }
+
+    return NULL;
+}
+
+static void *TestPoolWriter( void *arg )
+{
+    TEST_POOL *t = (TEST_POOL *) arg;
+    INCHIGEN_JOB *job;
+    int k;
+
+    while (( job = INCHIGEN_POOL_Next( t->pool, INCHIGEN_STAGE_DONE, 1 ) ))
+    {
+        k = (int) ( (inchi_Input *) job->pUserData - t->pInp );
+        if (0 <= k && k < NUM_POOL_RECORDS && !t->szInChI[k])
+        {
+            t->nRet[k] = job->nRetCode;
+            if (job->Output.szInChI && ( t->szInChI[k] = (char *) malloc( strlen( job->Output.szInChI ) + 1 ) ))
+            {
+                strcpy( t->szInChI[k], job->Output.szInChI );
+            }
+        }
+        INCHIGEN_POOL_Release( t->pool, job );
+    }
+
+    return NULL;
+}
+
+static void TestPool( void )
+{
+    static TEST_POOL t[INCHIGEN_NUM_STAGES]; /* workers of stages NONE..CANON, then the writer */
+    TEST_POOL *w = t + INCHIGEN_STAGE_DONE;
+    inchi_Input inp[NUM_POOL_RECORDS];
+    inchi_Output out;
+    INCHIGEN_JOB *job;
+    pthread_t tid[INCHIGEN_NUM_STAGES];
+    char szWhat[64];
+    int i, k, ret, bStarted[INCHIGEN_NUM_STAGES];
+
+    memset( t, 0, sizeof( t ) );
+    memset( inp, 0, sizeof( inp ) );
+    if (!( w->pool = INCHIGEN_POOL_Create( NUM_POOL_JOBS ) ))
+    {
+        CheckResult( "Pool: INCHIGEN_POOL_Create", "", 1, 0, NULL, NULL );
+        return;
+    }
+    for (k = 0; k < NUM_POOL_RECORDS; k++)
+    {
+        inp[k].atom = MakeGridAtoms( k + 1 );
+        inp[k].num_atoms = (AT_NUM) ( ( k + 1 ) * ( k + 1 ) );
+        inp[k].szOptions = szThreadOptions[k % NUM_TEST_OPTIONS];
+    }
+
+    for (i = 0; i < INCHIGEN_NUM_STAGES; i++)
+    {
+        t[i].pool = w->pool;
+        t[i].nStage = i;
+        t[i].pInp = inp;
+        bStarted[i] = !pthread_create( tid + i, NULL, i == INCHIGEN_STAGE_DONE ? TestPoolWriter : TestPoolWorker, t + i );
+        CheckResult( "Pool: pthread_create", "", !bStarted[i], 0, NULL, NULL );
+    }
+    for (k = 0; k < NUM_POOL_RECORDS; k++)
+    {
+        if (!inp[k].atom || !( job = INCHIGEN_POOL_Acquire( w->pool, 1 ) ))
+        {
+            CheckResult( "Pool: INCHIGEN_POOL_Acquire", "", 1, 0, NULL, NULL );
+            break;
+        }
+        job->pInp = inp + k;
+        job->pUserData = inp + k;
+        CheckResult( "Pool: INCHIGEN_POOL_Submit", "", INCHIGEN_POOL_Submit( w->pool, job ), 0, NULL, NULL );
+    }
+    INCHIGEN_POOL_Close( w->pool );
+    CheckResult( "Pool: INCHIGEN_POOL_Acquire after Close", "",
+                 INCHIGEN_POOL_Acquire( w->pool, 1 ) != NULL, 0, NULL, NULL );
+    for (i = 0; i < INCHIGEN_NUM_STAGES; i++)
+    {
+        if (bStarted[i])
+        {
+            pthread_join( tid[i], NULL );
+        }
+    }
+    INCHIGEN_POOL_Destroy( w->pool );
+
+    for (k = 0; k < NUM_POOL_RECORDS; k++)
+    {
+        memset( &out, 0, sizeof( out ) );
+        ret = inp[k].atom ? GetINCHI( inp + k, &out ) : inchi_Ret_ERROR;
+        sprintf( szWhat, "Pool: record %d InChI", k );
+        CheckResult( szWhat, inp[k].szOptions, w->nRet[k], ret, w->szInChI[k], out.szInChI );
+        FreeINCHI( &out );
+        free( w->szInChI[k] );
+        free( inp[k].atom );
+    }
+}
+
+
+/****************************************************************************/
+int main( void )
+{
+    TestInChI2InChI( );
+    TestMultiFlavour( );
+    TestThreads( );
+    TestPool( );
+
+    printf( "%d checks, %d failed\n", nChecks, nFailed );
+
+    return nFailed;
+}
@@ -234,12 +234,24 @@ int InchiToInchi_Input( INCHI_IOSTREAM *inp_molfile,
         at_old = orig_at_data ? orig_at_data->atom : NULL; /*  save pointer to the previous allocation */
         stereo0D_old = orig_at_data ? orig_at_data->stereo0D : NULL;
         szCoordOld = NULL;
-        num_inp_atoms_new =
-            InchiToInchiAtom( inp_molfile, orig_at_data ? &stereo0D_new : NULL, &num_inp_0D_new,
-                          bDoNotAddH, vABParityUnknown, nInputType,
-                          orig_at_data ? &at_new : NULL, MAX_ATOMS,
-                          &num_dimensions_new, &num_inp_bonds_new,
-                          pSdfLabel, pSdfValue, lSdfId, pInpAtomFlags, err, pStrErr );
+        if (inp_molfile->type == INCHI_IOS_TYPE_STRING && nInputType == INPUT_INCHI_PLAIN && orig_at_data)
+        {
+            /* parse AuxInfo in place; structure labels are not needed here */
+            num_inp_atoms_new =
+                AuxInfoToInchiAtom( inp_molfile->s.pStr, inp_molfile->s.nUsedLength, &inp_molfile->s.nPtr,
+                                    &stereo0D_new, &num_inp_0D_new, bDoNotAddH, &at_new,
+                                    &num_dimensions_new, &num_inp_bonds_new,
+                                    pInpAtomFlags, err, pStrErr );
+        }
+        else
+        {
+            num_inp_atoms_new =
+                InchiToInchiAtom( inp_molfile, orig_at_data ? &stereo0D_new : NULL, &num_inp_0D_new,
+                              bDoNotAddH, vABParityUnknown, nInputType,
+                              orig_at_data ? &at_new : NULL, MAX_ATOMS,
+                              &num_dimensions_new, &num_inp_bonds_new,
+                              pSdfLabel, pSdfValue, lSdfId, pInpAtomFlags, err, pStrErr );
+        }
         if (num_inp_atoms_new <= 0 && !*err)
         {
             TREAT_ERR( *err, 0, "Empty structure" );
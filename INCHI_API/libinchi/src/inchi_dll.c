@@ -63,6 +63,7 @@
 #include "../../../INCHI_BASE/src/ichitime.h"
 
 #include "inchi_dll.h"
+#include "inchi_dll_cache.h"
 
 /*************************************************************************
  *
@@ -178,6 +179,19 @@ void INCHI_DECL FreeStdINCHI( inchi_Output *out )
 
 
 
+/****************************************************************************
+
+    SetINCHICancelFlag
+
+****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+void INCHI_DECL SetINCHICancelFlag( volatile int *pbCancel )
+{
+    InchiClockSetCancelFlag( pbCancel );
+}
+
+
+
 /****************************************************************************
 
     FreeStructFromStdINCHI
@@ -381,6 +395,18 @@ static int GetINCHI1( inchi_InputEx *extended_input,
     inchi_Input prev_versions_input;
     inchi_Input *pvinp = &prev_versions_input;
 
+    INCHI_CACHE_KEY cache_key;
+
+    /* Answer a repeated input from the result cache */
+    memset( &cache_key, 0, sizeof( cache_key ) );
+    if (out && inchi_cache_is_on( ) &&
+         inchi_cache_make_key_from_input( &cache_key, extended_input, enforce_std_format ) &&
+         inchi_cache_lookup( &cache_key, out, &nRet ))
+    {
+        inchi_cache_free_key( &cache_key );
+        return nRet;
+    }
+
     pvinp->atom = extended_input->atom;
     pvinp->num_atoms = extended_input->num_atoms;
     pvinp->num_stereo0D = extended_input->num_stereo0D;
@@ -446,7 +472,7 @@ static int GetINCHI1( inchi_InputEx *extended_input,
     memset( szSdfDataValue, 0, sizeof( szSdfDataValue ) );
 
     memset( &CG, 0, sizeof( CG ) );
-    memset( &ic, 0, sizeof( ic ) );
+    InchiClockInit( &ic );
 
     if (!out)
     {
@@ -719,6 +745,9 @@ translate_RetVal:
         default: nRet = inchi_Ret_UNKNOWN; break; /* Unlnown program error */
     }
 
+    inchi_cache_store( &cache_key, out, nRet );
+    inchi_cache_free_key( &cache_key );
+
     return nRet;
 }
 
@@ -2170,7 +2199,7 @@ repeat:
     memset( ip, 0, sizeof( *ip ) );
     memset( szSdfDataValue, 0, sizeof( szSdfDataValue ) );
 
-    memset( &ic, 0, sizeof( ic ) );
+    InchiClockInit( &ic );
     memset( &CG, 0, sizeof( CG ) );
 
     szMainOption[1] = INCHI_OPTION_PREFX;
@@ -2422,6 +2451,698 @@ translate_RetVal:
 }
 
 
+/*  One option set of GetINCHIMultiFlavour() */
+typedef struct tagInchiFlavour
+{
+    char *szBase;    /* options other than FixedH/RecMet, sorted */
+    int   bFixedH;
+    int   bRecMet;
+    int   nLeader;   /* first flavour with the same szBase */
+} INCHI_FLAVOUR;
+
+/*  Makes InChI from the input with the given options */
+typedef int( *INCHI_FLAVOUR_FUNC )( const void *input, char *szOptions, inchi_Output *out );
+
+
+/****************************************************************************
+ Compare two option tokens ignoring case
+****************************************************************************/
+static int CompareOptionTokens( const char *p1, int len1, const char *p2, int len2 )
+{
+    int diff;
+
+    diff = inchi_memicmp( p1, p2, inchi_min( len1, len2 ) );
+
+    return diff ? diff : len1 - len2;
+}
+
+
+/****************************************************************************
+ Check one option of a flavour: returns
+    1 => FixedH, 2 => RecMet, 0 => option does not change layers
+        (timeouts, labels), -1 => any other option
+****************************************************************************/
+static int InChI2InChILayerOption( const char *opt, int len )
+{
+    int i;
+
+    /* other prefixes are not recognized by ReadCommandLineParms() either */
+    if (len < 2 || opt[0] != INCHI_OPTION_PREFX)
+    {
+        return -1;
+    }
+    opt++;
+    len--;
+    if (len == 6 && !inchi_memicmp( opt, "FixedH", 6 ))
+    {
+        return 1;
+    }
+    if (len == 6 && !inchi_memicmp( opt, "RecMet", 6 ))
+    {
+        return 2;
+    }
+    if (len == 8 && !inchi_memicmp( opt, "NoLabels", 8 ))
+    {
+        return 0;
+    }
+    /* W<seconds>, WM<milliseconds> */
+    i = ( len > 2 && !inchi_memicmp( opt, "WM", 2 ) ) ? 2 : ( len > 1 && toupper( UCINT opt[0] ) == 'W' ) ? 1 : 0;
+    if (!i)
+    {
+        return -1;
+    }
+    for (; i < len; i++)
+    {
+        if (!isdigit( UCINT opt[i] ) && opt[i] != '.')
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+/****************************************************************************
+ Cut InChI string szInChI made by a pass with FixedH and RecMet down to
+ the main layers plus Fixed-H layers (if bFixedH) plus Reconnected layers
+ (if bRecMet). Returns
+    1 => *szOutInChI allocated and filled
+    0 => szInChI is not a plain InChI string
+   -1 => out of RAM
+****************************************************************************/
+static int CutInChILayers( const char *szInChI,
+                           int bFixedH,
+                           int bRecMet,
+                           char **szOutInChI )
+{
+    int len;
+    const char *p, *q, *pRec, *pFixed, *pFixedRec, *pEnd;
+    char *s;
+
+    /* input: "InChI=1/" or "InChI=1S/" followed by layers only */
+    if (memcmp( szInChI, "InChI=1", 7 ))
+    {
+        return 0;
+    }
+    p = szInChI + 7;
+    if (*p == 'S')
+    {
+        p++;
+    }
+    if (*p != '/')
+    {
+        return 0;
+    }
+    for (pEnd = p; *pEnd && !isspace( UCINT *pEnd ); pEnd++)
+    {
+        ;
+    }
+    if (*pEnd)
+    {
+        return 0; /* AuxInfo, several InChIs, etc. */
+    }
+
+    /* layers are "/<letter>..."; formula layer starts with a digit or uppercase letter */
+    pRec = strstr( p, "/r" );
+    pFixed = strstr( p, "/f" );
+    if (pFixed && pRec && pFixed > pRec)
+    {
+        pFixed = NULL;
+    }
+    pFixedRec = pRec ? strstr( pRec, "/f" ) : NULL;
+    /* assemble the output */
+    if (!( s = (char *) inchi_malloc( ( pEnd - szInChI ) + 1 ) ))
+    {
+        return -1;
+    }
+    q = pRec ? pRec : pEnd;
+    if (!bFixedH && pFixed)
+    {
+        q = pFixed;
+    }
+    len = (int) ( q - szInChI );
+    memcpy( s, szInChI, len );
+    if (bRecMet && pRec)
+    {
+        q = ( !bFixedH && pFixedRec ) ? pFixedRec : pEnd;
+        memcpy( s + len, pRec, q - pRec );
+        len += (int) ( q - pRec );
+    }
+    s[len] = '\0';
+    *szOutInChI = s;
+
+    return 1;
+}
+
+
+/****************************************************************************
+ Split options string into FixedH, RecMet and the sorted rest
+ Returns 0 => Ok, -1 => out of RAM
+****************************************************************************/
+static int SplitFlavourOptions( const char *szOptions, INCHI_FLAVOUR *f )
+{
+    const char *tok[INCHI_MAX_NUM_ARG];
+    int   tok_len[INCHI_MAX_NUM_ARG];
+    int   num_tok = 0, i, len = 0, ret;
+    const char *p, *q;
+
+    memset( f, 0, sizeof( *f ) );
+    for (p = szOptions; p && *p; p = q)
+    {
+        while (*p && isspace( UCINT *p ))
+        {
+            p++;
+        }
+        for (q = p; *q && !isspace( UCINT *q ); q++)
+        {
+            ;
+        }
+        if (q == p)
+        {
+            break;
+        }
+        ret = InChI2InChILayerOption( p, (int) ( q - p ) );
+        f->bFixedH |= ( ret == 1 );
+        f->bRecMet |= ( ret == 2 );
+        if (( ret == 1 || ret == 2 ) || num_tok == INCHI_MAX_NUM_ARG)
+        {
+            continue;
+        }
+        /* insertion sort */
+        for (i = num_tok; i > 0 && CompareOptionTokens( tok[i - 1], tok_len[i - 1], p, (int) ( q - p ) ) > 0; i--)
+        {
+            tok[i] = tok[i - 1];
+            tok_len[i] = tok_len[i - 1];
+        }
+        tok[i] = p;
+        tok_len[i] = (int) ( q - p );
+        num_tok++;
+        len += (int) ( q - p ) + 1;
+    }
+
+    if (!( f->szBase = (char *) inchi_malloc( len + 1 ) ))
+    {
+        return -1;
+    }
+    for (i = 0, len = 0; i < num_tok; i++)
+    {
+        if (len)
+        {
+            f->szBase[len++] = ' ';
+        }
+        memcpy( f->szBase + len, tok[i], tok_len[i] );
+        len += tok_len[i];
+    }
+    f->szBase[len] = '\0';
+
+    return 0;
+}
+
+
+/****************************************************************************
+ Returns 1 if szOptions produce Standard InChI, 0 if not, -1 on error
+****************************************************************************/
+static int IsStdInChIOptions( const char *szOptions )
+{
+    INPUT_PARMS inp_parms;
+    INPUT_PARMS *ip = &inp_parms;
+    INCHI_IOSTREAM log_file;
+    char szSdfDataValue[MAX_SDF_VALUE + 1];
+    unsigned long ulDisplTime = 0;
+    const char *argv[INCHI_MAX_NUM_ARG + 1];
+    int argc, i, ret;
+    char *szCopy;
+
+    if (!( szCopy = (char *) inchi_malloc( strlen( szOptions ) + 1 ) ))
+    {
+        return -1;
+    }
+    strcpy( szCopy, szOptions );
+    argc = parse_options_string( szCopy, argv, INCHI_MAX_NUM_ARG );
+
+    memset( ip, 0, sizeof( *ip ) );
+    memset( szSdfDataValue, 0, sizeof( szSdfDataValue ) );
+    inchi_ios_init( &log_file, INCHI_IOS_TYPE_STRING, NULL );
+
+    ret = ReadCommandLineParms( argc, argv, ip, szSdfDataValue, &ulDisplTime, bRELEASE_VERSION, &log_file );
+    ret = ( ret < 0 ) ? -1 : ( 0 != ( ip->bINChIOutputOptions & INCHI_OUT_STDINCHI ) );
+
+    for (i = 0; i < MAX_NUM_PATHS; i++)
+    {
+        if (ip->path[i])
+        {
+            inchi_free( (char*) ip->path[i] ); /*  cast deliberately discards 'const' qualifier */
+        }
+    }
+    inchi_ios_close( &log_file );
+    inchi_free( szCopy );
+
+    return ret;
+}
+
+
+/****************************************************************************
+ Copy szAuxInfo into szOut (at least strlen(szAuxInfo)+1 chars) dropping
+ Fixed-H ("/F:" up to "/CRV:", "/rA:", "/R:" or the end) and/or
+ Reconnected ("/R:" up to the end) parts. Returns the length of the
+ result or -1 if szAuxInfo is not a plain AuxInfo string
+****************************************************************************/
+static int CutAuxInfoLayers( const char *szAuxInfo, int bFixedH, int bRecMet, char *szOut )
+{
+    const char *p, *q, *pEnd;
+    int len = 0;
+
+    if (memcmp( szAuxInfo, "AuxInfo=1/", 10 ))
+    {
+        return -1;
+    }
+    for (pEnd = szAuxInfo; *pEnd; pEnd++)
+    {
+        if (isspace( UCINT *pEnd ))
+        {
+            return -1;
+        }
+    }
+    if (!bRecMet && ( p = strstr( szAuxInfo, "/R:" ) ))
+    {
+        pEnd = p;
+    }
+
+    for (p = szAuxInfo; p < pEnd; p = q)
+    {
+        q = strstr( p, "/F:" );
+        if (bFixedH || !q || q >= pEnd)
+        {
+            q = pEnd;
+        }
+        memcpy( szOut + len, p, q - p );
+        len += (int) ( q - p );
+        if (q < pEnd)
+        {
+            /* skip Fixed-H part */
+            for (q += 3; q < pEnd; q++)
+            {
+                if (*q == '/' && ( !memcmp( q, "/CRV:", 5 ) || !memcmp( q, "/rA:", 4 ) || !memcmp( q, "/R:", 3 ) ))
+                {
+                    break;
+                }
+            }
+        }
+    }
+    szOut[len] = '\0';
+
+    return len;
+}
+
+
+/****************************************************************************
+ Returns 1 if a formula of szInChI (main, /f or /r) has a multiplied
+ component such as "2C2H4O2", otherwise 0. The order of identical
+ components, hence their numbering in AuxInfo /N:, depends on the
+ options of the pass which made them
+****************************************************************************/
+static int HasIdenticalComponents( const char *szInChI )
+{
+    const char *p, *q;
+    int bFormula = 1; /* the first layer is the formula */
+    int bStart;
+
+    for (p = strchr( szInChI, '/' ); p; p = strchr( q, '/' ), bFormula = 0)
+    {
+        q = p + 1;
+        if (( *q == 'f' || *q == 'r' ) && q[1] && q[1] != '/')
+        {
+            q++;
+            bFormula = 1;
+        }
+        if (!bFormula)
+        {
+            continue;
+        }
+        for (bStart = 1; *q && *q != '/'; q++)
+        {
+            if (bStart && isdigit( UCINT *q ))
+            {
+                return 1;
+            }
+            bStart = ( *q == '.' );
+        }
+    }
+
+    return 0;
+}
+
+
+/****************************************************************************
+ Copy all strings of inchi_Output; returns 0 => Ok, -1 => out of RAM
+****************************************************************************/
+static int CopyINCHIOutput( const inchi_Output *src, inchi_Output *dst )
+{
+    size_t len;
+
+    memset( dst, 0, sizeof( *dst ) );
+    if (src->szInChI)
+    {
+        len = strlen( src->szInChI ) + 1;
+        if (!( dst->szInChI = (char *) inchi_malloc( len + ( src->szAuxInfo ? strlen( src->szAuxInfo ) + 1 : 0 ) ) ))
+        {
+            return -1;
+        }
+        memcpy( dst->szInChI, src->szInChI, len );
+        if (src->szAuxInfo)
+        {
+            dst->szAuxInfo = dst->szInChI + len;
+            strcpy( dst->szAuxInfo, src->szAuxInfo );
+        }
+    }
+    if (src->szMessage && !( dst->szMessage = (char *) inchi_malloc( strlen( src->szMessage ) + 1 ) ) ||
+         src->szLog && !( dst->szLog = (char *) inchi_malloc( strlen( src->szLog ) + 1 ) ))
+    {
+        FreeINCHI( dst );
+        return -1;
+    }
+    if (src->szMessage)
+    {
+        strcpy( dst->szMessage, src->szMessage );
+    }
+    if (src->szLog)
+    {
+        strcpy( dst->szLog, src->szLog );
+    }
+
+    return 0;
+}
+
+
+/****************************************************************************
+ Make output of flavour f from output of the shared pass which contains
+ all layers requested by f. Returns
+    1 => done
+    0 => the shared output cannot be cut, f needs a pass of its own
+   -1 => out of RAM
+****************************************************************************/
+static int CutFlavourOutput( const inchi_Output *shared, const INCHI_FLAVOUR *f, int bStd, inchi_Output *out )
+{
+    char *szInChI = NULL, *s;
+    int ret, len, bAddStd;
+
+    memset( out, 0, sizeof( *out ) );
+    if (!shared->szInChI)
+    {
+        return 0;
+    }
+    ret = CutInChILayers( shared->szInChI, f->bFixedH, f->bRecMet, &szInChI );
+    if (ret <= 0)
+    {
+        return ret;
+    }
+    if (shared->szAuxInfo && HasIdenticalComponents( szInChI ))
+    {
+        /* AuxInfo of the shared pass may number identical components differently */
+        inchi_free( szInChI );
+        return 0;
+    }
+    bAddStd = ( bStd && !memcmp( szInChI, "InChI=1/", 8 ) );
+    len = (int) strlen( szInChI );
+    s = (char *) inchi_malloc( len + bAddStd + 1 + ( shared->szAuxInfo ? strlen( shared->szAuxInfo ) + 1 : 0 ) );
+    if (!s)
+    {
+        inchi_free( szInChI );
+        return -1;
+    }
+    if (bAddStd)
+    {
+        memcpy( s, szInChI, 7 );
+        s[7] = 'S';
+        strcpy( s + 8, szInChI + 7 );
+    }
+    else
+    {
+        strcpy( s, szInChI );
+    }
+    inchi_free( szInChI );
+    len += bAddStd + 1;
+    if (shared->szAuxInfo && 0 > CutAuxInfoLayers( shared->szAuxInfo, f->bFixedH, f->bRecMet, s + len ))
+    {
+        inchi_free( s );
+        return 0;
+    }
+    out->szInChI = s;
+    out->szAuxInfo = shared->szAuxInfo ? s + len : NULL;
+
+    /* messages and log are those of the shared pass */
+    if (shared->szMessage && !( out->szMessage = (char *) inchi_malloc( strlen( shared->szMessage ) + 1 ) ) ||
+         shared->szLog && !( out->szLog = (char *) inchi_malloc( strlen( shared->szLog ) + 1 ) ))
+    {
+        FreeINCHI( out );
+        return -1;
+    }
+    if (shared->szMessage)
+    {
+        strcpy( out->szMessage, shared->szMessage );
+    }
+    if (shared->szLog)
+    {
+        strcpy( out->szLog, shared->szLog );
+    }
+
+    return 1;
+}
+
+
+/****************************************************************************
+ Run func with options szBase plus FixedH/RecMet
+****************************************************************************/
+static int MakeFlavourPass( INCHI_FLAVOUR_FUNC func,
+                            const void *input,
+                            const char *szBase,
+                            int bFixedH,
+                            int bRecMet,
+                            inchi_Output *out )
+{
+    char *szOptions;
+    int ret;
+
+    memset( out, 0, sizeof( *out ) );
+    if (!( szOptions = (char *) inchi_malloc( strlen( szBase ) + 16 ) ))
+    {
+        return inchi_Ret_FATAL;
+    }
+    strcpy( szOptions, szBase );
+    if (bFixedH)
+    {
+        sprintf( szOptions + strlen( szOptions ), " %cFixedH", INCHI_OPTION_PREFX );
+    }
+    if (bRecMet)
+    {
+        sprintf( szOptions + strlen( szOptions ), " %cRecMet", INCHI_OPTION_PREFX );
+    }
+    ret = func( input, szOptions, out );
+    inchi_free( szOptions );
+
+    return ret;
+}
+
+
+/****************************************************************************
+ Common part of GetINCHIMultiFlavour and MakeINCHIFromMolfileTextMultiFlavour:
+ option sets differing only in FixedH/RecMet share one pass made with
+ the union of these options; the others are cut out of its output
+****************************************************************************/
+static int MakeINCHIFlavours( INCHI_FLAVOUR_FUNC func,
+                              const void *input,
+                              int num_flavours,
+                              char **szOptions,
+                              inchi_Output *outputs,
+                              int *retcodes,
+                              char *szINCHIKeys )
+{
+    INCHI_FLAVOUR *f;
+    inchi_Output shared;
+    int i, j, ret, ret_shared, bFixedH, bRecMet, bStd, num_done = 0;
+    char *szKey;
+
+    if (num_flavours < 0 || ( num_flavours && ( !input || !outputs ) ))
+    {
+        return -1;
+    }
+    if (!num_flavours)
+    {
+        return 0;
+    }
+    if (!( f = (INCHI_FLAVOUR *) inchi_calloc( num_flavours, sizeof( f[0] ) ) ))
+    {
+        return -1;
+    }
+
+    for (i = 0; i < num_flavours; i++)
+    {
+        memset( outputs + i, 0, sizeof( outputs[0] ) );
+        if (retcodes)
+        {
+            retcodes[i] = inchi_Ret_FATAL;
+        }
+        if (szINCHIKeys)
+        {
+            szINCHIKeys[(size_t) i * INCHI_BATCH_KEY_LEN] = '\0';
+        }
+    }
+    for (i = 0; i < num_flavours; i++)
+    {
+        if (SplitFlavourOptions( szOptions ? szOptions[i] : NULL, f + i ))
+        {
+            goto exit_function;
+        }
+        for (j = 0; j < i && strcmp( f[j].szBase, f[i].szBase ); j++)
+        {
+            ;
+        }
+        f[i].nLeader = j;
+    }
+
+    for (i = 0; i < num_flavours; i++)
+    {
+        if (f[i].nLeader != i)
+        {
+            continue;
+        }
+        /* one pass for all flavours of this group */
+        bFixedH = bRecMet = 0;
+        for (j = i; j < num_flavours; j++)
+        {
+            if (f[j].nLeader == i)
+            {
+                bFixedH |= f[j].bFixedH;
+                bRecMet |= f[j].bRecMet;
+            }
+        }
+        ret_shared = MakeFlavourPass( func, input, f[i].szBase, bFixedH, bRecMet, &shared );
+        bStd = -1; /* unknown */
+
+        for (j = i; j < num_flavours; j++)
+        {
+            if (f[j].nLeader != i)
+            {
+                continue;
+            }
+            ret = 0;
+            if (f[j].bFixedH == bFixedH && f[j].bRecMet == bRecMet)
+            {
+                ret = CopyINCHIOutput( &shared, outputs + j ) ? -1 : 1;
+            }
+            else if (ret_shared == inchi_Ret_OKAY || ret_shared == inchi_Ret_WARNING)
+            {
+                if (!f[j].bFixedH && !f[j].bRecMet && bStd < 0)
+                {
+                    bStd = IsStdInChIOptions( f[i].szBase );
+                }
+                if (f[j].bFixedH || f[j].bRecMet || bStd >= 0)
+                {
+                    ret = CutFlavourOutput( &shared, f + j, bStd > 0 && !f[j].bFixedH && !f[j].bRecMet, outputs + j );
+                }
+            }
+            if (ret > 0)
+            {
+                ret = ret_shared;
+            }
+            else if (ret == 0)
+            {
+                ret = MakeFlavourPass( func, input, f[j].szBase, f[j].bFixedH, f[j].bRecMet, outputs + j );
+            }
+            else
+            {
+                ret = inchi_Ret_FATAL;
+            }
+            if (retcodes)
+            {
+                retcodes[j] = ret;
+            }
+            if (ret != inchi_Ret_OKAY && ret != inchi_Ret_WARNING)
+            {
+                continue;
+            }
+            num_done++;
+            if (szINCHIKeys && outputs[j].szInChI)
+            {
+                szKey = szINCHIKeys + (size_t) j * INCHI_BATCH_KEY_LEN;
+                if (INCHIKEY_OK != GetINCHIKeyFromINCHI( outputs[j].szInChI, 0, 0, szKey, NULL, NULL ))
+                {
+                    szKey[0] = '\0';
+                }
+            }
+        }
+        FreeINCHI( &shared );
+    }
+
+exit_function:
+    for (i = 0; i < num_flavours; i++)
+    {
+        if (f[i].szBase)
+        {
+            inchi_free( f[i].szBase );
+        }
+    }
+    inchi_free( f );
+
+    return num_done;
+}
+
+
+/****************************************************************************/
+static int GetINCHIFlavour( const void *input, char *szOptions, inchi_Output *out )
+{
+    inchi_Input inp = *(const inchi_Input *) input;
+
+    inp.szOptions = szOptions;
+
+    return GetINCHI( &inp, out );
+}
+
+
+/****************************************************************************/
+static int MakeINCHIFromMolfileTextFlavour( const void *input, char *szOptions, inchi_Output *out )
+{
+    return MakeINCHIFromMolfileText( (const char *) input, szOptions, out );
+}
+
+
+/****************************************************************************
+
+    GetINCHIMultiFlavour
+
+****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+int INCHI_DECL GetINCHIMultiFlavour( inchi_Input *inp,
+                                     int num_flavours,
+                                     char **szOptions,
+                                     inchi_Output *outputs,
+                                     int *retcodes,
+                                     char *szINCHIKeys )
+{
+    return MakeINCHIFlavours( GetINCHIFlavour, inp, num_flavours, szOptions,
+                              outputs, retcodes, szINCHIKeys );
+}
+
+
+/****************************************************************************
+
+    MakeINCHIFromMolfileTextMultiFlavour
+
+****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+int INCHI_DECL MakeINCHIFromMolfileTextMultiFlavour( const char *moltext,
+                                                     int num_flavours,
+                                                     char **szOptions,
+                                                     inchi_Output *outputs,
+                                                     int *retcodes,
+                                                     char *szINCHIKeys )
+{
+    return MakeINCHIFlavours( MakeINCHIFromMolfileTextFlavour, moltext, num_flavours, szOptions,
+                              outputs, retcodes, szINCHIKeys );
+}
+
+
 /****************************************************************************
 
     GetStructFromStdINCHI
@@ -2534,7 +3255,7 @@ int INCHI_DECL GetStructFromINCHIEx( inchi_InputINCHI *inpInChI,
     memset( ip, 0, sizeof( *ip ) );
     memset( szSdfDataValue, 0, sizeof( szSdfDataValue ) );
 
-    memset( &ic, 0, sizeof( ic ) );
+    InchiClockInit( &ic );
     memset( &CG, 0, sizeof( CG ) );
 
     szMainOption[1] = INCHI_OPTION_PREFX;
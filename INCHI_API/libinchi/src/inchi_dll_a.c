@@ -449,7 +449,7 @@ int INCHI_DECL INCHIGEN_DoNormalization( INCHIGEN_HANDLE _HGen, INCHIGEN_DATA *p
     int k;
 
     memset( &CG, 0, sizeof( CG ) );
-    memset( &ic, 0, sizeof( ic ) );
+    InchiClockInit( &ic );
 
 #if ( RING2CHAIN == 1 || UNDERIVATIZE == 1 )
     int ret1 = 0, ret2 = 0;
@@ -707,7 +707,7 @@ int INCHI_DECL INCHIGEN_DoCanonicalization
 
     int k;
 
-    memset( &ic, 0, sizeof( ic ) );
+    InchiClockInit( &ic );
     memset( &CG, 0, sizeof( CG ) );
 
     /* Set debug output */
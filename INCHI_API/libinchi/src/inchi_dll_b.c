@@ -61,6 +61,8 @@
 
 #include "inchi_dll.h"
 #include "inchi_dll_b.h"
+#include "inchi_dll_cache.h"
+#include "inchi_dll_mt.h"
 
 
 static
@@ -119,6 +121,19 @@ EXPIMP_TEMPLATE INCHI_API
 int INCHI_DECL MakeINCHIFromMolfileText( const char *moltext,
                                          char *szOptions,
                                          inchi_Output *result )
+{
+    return MakeINCHIFromMolfileTextWithSdfFields( moltext, szOptions, NULL,
+                                                  result, NULL );
+}
+
+
+/*****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+int INCHI_DECL MakeINCHIFromMolfileTextWithSdfFields( const char *moltext,
+                                                      char *szOptions,
+                                                      const char *szSdfFields,
+                                                      inchi_Output *result,
+                                                      char **pszSdfFieldValues )
 {
     int retcode = 0, retcode2 = 0;
     long num_inp = 0, num_err = 0;
@@ -145,8 +160,28 @@ int INCHI_DECL MakeINCHIFromMolfileText( const char *moltext,
 
     CANON_GLOBALS CG;
     INCHI_CLOCK ic;
+    INCHI_CACHE_KEY cache_key;
+    SDF_FIELDS sdf_fields;
+    int bSdfFields = szSdfFields && szSdfFields[0] && pszSdfFieldValues;
+
     memset( &CG, 0, sizeof( CG ) );
-    memset( &ic, 0, sizeof( ic ) );
+    InchiClockInit( &ic );
+    memset( &sdf_fields, 0, sizeof( sdf_fields ) );
+    if (pszSdfFieldValues)
+    {
+        *pszSdfFieldValues = NULL;
+    }
+
+    /* Answer a repeated Molfile from the result cache */
+    /* (not if SDF data are requested: a cached result does not keep them) */
+    memset( &cache_key, 0, sizeof( cache_key ) );
+    if (result && !bSdfFields && inchi_cache_is_on( ) &&
+         inchi_cache_make_key_from_molfile( &cache_key, moltext, szOptions ) &&
+         inchi_cache_lookup( &cache_key, result, &retcode ))
+    {
+        inchi_cache_free_key( &cache_key );
+        return retcode;
+    }
 
     retcode = PrepareToMakeINCHI( sd, ip, orig_inp_data, prep_inp_data,
                                    pINChI, pINChI_Aux,
@@ -167,12 +202,30 @@ int INCHI_DECL MakeINCHIFromMolfileText( const char *moltext,
         goto ret;
     }
 
+    if (bSdfFields)
+    {
+        if (SDFileFields_Init( &sdf_fields, szSdfFields ))
+        {
+            retcode = mol2inchi_Ret_ERROR;
+            num_err++;
+            goto ret;
+        }
+        ip->pSdfFields = &sdf_fields;
+    }
+
     have_err_in_GetOneStructure = 0;
     retcode = GetOneStructure( &ic, sd, ip, szTitle,
                                inp_file, plog, pout, pprb,
                                orig_inp_data,
                                &num_inp, pStructPtrs );
 
+    if (bSdfFields)
+    {
+        /* data items have been read together with the structure */
+        *pszSdfFieldValues = SDFileFields_CopyValues( &sdf_fields );
+        ip->pSdfFields = NULL;
+    }
+
     if (retcode == _IS_FATAL || retcode == _IS_ERROR)
     {
         retcode = mol2inchi_Ret_ERROR;
@@ -265,10 +318,300 @@ ret:
         retcode = retcode2;
     }
 
+    SDFileFields_Free( &sdf_fields );
+
+    inchi_cache_store( &cache_key, result, retcode );
+    inchi_cache_free_key( &cache_key );
+
     return retcode;
 }
 
 
+/*****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+void INCHI_DECL FreeINCHISdfFieldValues( char *szSdfFieldValues )
+{
+    if (szSdfFieldValues)
+    {
+        inchi_free( szSdfFieldValues );
+    }
+}
+
+
+/****************************************************************************
+ Open plain or gzip-compressed file, see inchi_fopen()
+****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+FILE * INCHI_DECL OpenINCHIFile( const char *szFileName,
+                                 const char *szMode,
+                                 int bReadThread )
+{
+    if (!szFileName || !szMode)
+    {
+        return NULL;
+    }
+
+    return inchi_fopen( szFileName, szMode, bReadThread ? INCHI_FOPEN_READ_THREAD : 0 );
+}
+
+
+/*  Shared state of one MakeINCHIFromMolfileTextBatch() call */
+typedef struct tagMolfileBatch
+{
+    INCHI_MUTEX   lock;
+    int           next_record;   /* next record to be taken by a worker */
+    int           num_records;
+    const char  **moltexts;
+    char         *szOptions;
+    inchi_Output *results;
+    int          *retcodes;
+    char         *szINCHIKeys;
+    const char   *szSdfFields;   /* SDF data items requested or NULL */
+    char        **pszSdfFieldValues;
+    int           num_done;      /* records with InChI created */
+    volatile int *pbCancel;      /* cancellation flag of the caller */
+} MOLFILE_BATCH;
+
+
+/****************************************************************************
+  Worker: take records one by one until none is left
+****************************************************************************/
+static void MolfileBatchWorker( void *arg )
+{
+    MOLFILE_BATCH *b = (MOLFILE_BATCH *) arg;
+    int i, ret, num_done = 0;
+    char *szKey;
+
+    InchiClockSetCancelFlag( b->pbCancel );
+
+    for (;;)
+    {
+        inchi_mutex_lock( &b->lock );
+        i = b->next_record++;
+        inchi_mutex_unlock( &b->lock );
+        if (i >= b->num_records)
+        {
+            break;
+        }
+
+        memset( b->results + i, 0, sizeof( b->results[0] ) );
+        ret = b->moltexts[i] && !( b->pbCancel && *b->pbCancel )
+                  ? MakeINCHIFromMolfileTextWithSdfFields( b->moltexts[i], b->szOptions,
+                                                           b->szSdfFields, b->results + i,
+                                                           b->pszSdfFieldValues
+                                                              ? b->pszSdfFieldValues + i
+                                                              : NULL )
+                  : mol2inchi_Ret_ERROR;
+        if (b->retcodes)
+        {
+            b->retcodes[i] = ret;
+        }
+        if (ret != mol2inchi_Ret_OKAY && ret != mol2inchi_Ret_WARNING)
+        {
+            continue;
+        }
+        num_done++;
+        if (b->szINCHIKeys)
+        {
+            szKey = b->szINCHIKeys + (size_t) i * INCHI_BATCH_KEY_LEN;
+            szKey[0] = '\0';
+            if (b->results[i].szInChI &&
+                 INCHIKEY_OK != GetINCHIKeyFromINCHI( b->results[i].szInChI, 0, 0, szKey, NULL, NULL ))
+            {
+                szKey[0] = '\0';
+            }
+        }
+    }
+
+    inchi_mutex_lock( &b->lock );
+    b->num_done += num_done;
+    inchi_mutex_unlock( &b->lock );
+}
+
+
+/*****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+int INCHI_DECL MakeINCHIFromMolfileTextBatch( int num_records,
+                                              const char **moltexts,
+                                              char *szOptions,
+                                              inchi_Output *results,
+                                              int *retcodes,
+                                              char *szINCHIKeys,
+                                              int num_threads )
+{
+    return MakeINCHIFromMolfileTextBatchWithSdfFields( num_records, moltexts,
+                                                       szOptions, NULL,
+                                                       results, retcodes,
+                                                       szINCHIKeys, NULL,
+                                                       num_threads );
+}
+
+
+/*****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+int INCHI_DECL MakeINCHIFromMolfileTextBatchWithSdfFields( int num_records,
+                                                           const char **moltexts,
+                                                           char *szOptions,
+                                                           const char *szSdfFields,
+                                                           inchi_Output *results,
+                                                           int *retcodes,
+                                                           char *szINCHIKeys,
+                                                           char **pszSdfFieldValues,
+                                                           int num_threads )
+{
+    MOLFILE_BATCH batch;
+    int i;
+
+    if (num_records < 0 || ( num_records && ( !moltexts || !results ) ))
+    {
+        return -1;
+    }
+    if (szINCHIKeys)
+    {
+        for (i = 0; i < num_records; i++)
+        {
+            szINCHIKeys[(size_t) i * INCHI_BATCH_KEY_LEN] = '\0';
+        }
+    }
+    if (pszSdfFieldValues)
+    {
+        for (i = 0; i < num_records; i++)
+        {
+            pszSdfFieldValues[i] = NULL;
+        }
+    }
+    if (!num_records)
+    {
+        return 0;
+    }
+    if (num_threads <= 0)
+    {
+        num_threads = inchi_get_num_cpus( );
+    }
+    if (num_threads > num_records)
+    {
+        num_threads = num_records;
+    }
+
+    memset( &batch, 0, sizeof( batch ) );
+    inchi_mutex_init( &batch.lock );
+    batch.num_records = num_records;
+    batch.moltexts = moltexts;
+    batch.szOptions = szOptions;
+    batch.results = results;
+    batch.retcodes = retcodes;
+    batch.szINCHIKeys = szINCHIKeys;
+    batch.szSdfFields = szSdfFields;
+    batch.pszSdfFieldValues = pszSdfFieldValues;
+    batch.pbCancel = InchiClockGetCancelFlag( );
+
+    inchi_run_threads( num_threads, MolfileBatchWorker, &batch );
+
+    inchi_mutex_destroy( &batch.lock );
+
+    return batch.num_done;
+}
+
+
+/*  Shared state of one Get_inchi_Input_FromAuxInfoBatch() call */
+typedef struct tagAuxInfoBatch
+{
+    INCHI_MUTEX   lock;
+    int           next_record;   /* next record to be taken by a worker */
+    int           num_records;
+    char        **szAuxInfo;
+    int           bDoNotAddH;
+    int           bDiffUnkUndfStereo;
+    InchiInpData *pInchiInp;
+    int          *retcodes;
+    int           num_done;      /* records with structure extracted */
+} AUXINFO_BATCH;
+
+
+/****************************************************************************
+  Worker: take records one by one until none is left
+****************************************************************************/
+static void AuxInfoBatchWorker( void *arg )
+{
+    AUXINFO_BATCH *b = (AUXINFO_BATCH *) arg;
+    int i, ret, num_done = 0;
+
+    for (;;)
+    {
+        inchi_mutex_lock( &b->lock );
+        i = b->next_record++;
+        inchi_mutex_unlock( &b->lock );
+        if (i >= b->num_records)
+        {
+            break;
+        }
+
+        ret = b->szAuxInfo[i] && b->pInchiInp[i].pInp
+                  ? Get_inchi_Input_FromAuxInfo( b->szAuxInfo[i], b->bDoNotAddH,
+                                                 b->bDiffUnkUndfStereo, b->pInchiInp + i )
+                  : inchi_Ret_ERROR;
+        if (b->retcodes)
+        {
+            b->retcodes[i] = ret;
+        }
+        if (ret == inchi_Ret_OKAY || ret == inchi_Ret_WARNING)
+        {
+            num_done++;
+        }
+    }
+
+    inchi_mutex_lock( &b->lock );
+    b->num_done += num_done;
+    inchi_mutex_unlock( &b->lock );
+}
+
+
+/*****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+int INCHI_DECL Get_inchi_Input_FromAuxInfoBatch( int num_records,
+                                                 char **szInchiAuxInfo,
+                                                 int bDoNotAddH,
+                                                 int bDiffUnkUndfStereo,
+                                                 InchiInpData *pInchiInp,
+                                                 int *retcodes,
+                                                 int num_threads )
+{
+    AUXINFO_BATCH batch;
+
+    if (num_records < 0 || ( num_records && ( !szInchiAuxInfo || !pInchiInp ) ))
+    {
+        return -1;
+    }
+    if (!num_records)
+    {
+        return 0;
+    }
+    if (num_threads <= 0)
+    {
+        num_threads = inchi_get_num_cpus( );
+    }
+    if (num_threads > num_records)
+    {
+        num_threads = num_records;
+    }
+
+    memset( &batch, 0, sizeof( batch ) );
+    inchi_mutex_init( &batch.lock );
+    batch.num_records = num_records;
+    batch.szAuxInfo = szInchiAuxInfo;
+    batch.bDoNotAddH = bDoNotAddH;
+    batch.bDiffUnkUndfStereo = bDiffUnkUndfStereo;
+    batch.pInchiInp = pInchiInp;
+    batch.retcodes = retcodes;
+
+    inchi_run_threads( num_threads, AuxInfoBatchWorker, &batch );
+
+    inchi_mutex_destroy( &batch.lock );
+
+    return batch.num_done;
+}
+
+
 /****************************************************************************/
 int PrepareToMakeINCHI( STRUCT_DATA *sd,
                         INPUT_PARMS *ip,
@@ -567,149 +910,510 @@ int is_element_a_metal( char szEl[] )
 
 
 
-/****************************************************************************/
-int InchiToInchiAtom( INCHI_IOSTREAM *inp_file,
-                      inchi_Stereo0D **stereo0D,
-                      int *num_stereo0D,
-                      int bDoNotAddH,
-                      int vABParityUnknown,
-                      INPUT_TYPE nInputType,
-                      inchi_Atom **at,
-                      int max_num_at,
-                      int *num_dimensions,
-                      int *num_bonds,
-                      char *pSdfLabel,
-                      char *pSdfValue,
-                      long *Id,
-                      INCHI_MODE *pInpAtomFlags,
-                      int *err,
-                      char *pStrErr )
+/****************************************************************************
+  Set bonds valences, implicit H and 0D parities of the atoms read from
+  InChI AuxInfo reversibility layers; on entry atom[i].num_iso_H[0] holds
+  the bonds valence + number of H taken from /rA.
+  Returns num_atoms or 0 on program error.
+****************************************************************************/
+static int SetInchiAtomValencesAndStereo0D( inchi_Atom *atom,
+                                            int num_atoms,
+                                            inchi_Stereo0D **patom_stereo0D,
+                                            int len_stereo0D,
+                                            int b23D,
+                                            int bDoNotAddH,
+                                            inchi_Stereo0D **stereo0D,
+                                            int *num_stereo0D,
+                                            int *num_dimensions,
+                                            int *num_bonds,
+                                            int *err,
+                                            char *pStrErr )
 {
-    int      num_atoms = 0, bFindNext = 0, len, bHeaderRead, bItemIsOver, bErrorMsg, bRestoreInfo;
-    int      bFatal = 0, num_struct = 0;
-    int      i, k, k2, res, bond_type, bond_stereo1, bond_stereo2, bond_char, neigh, bond_parity, bond_parityNM;
-    int      bTooLongLine, res2, bTooLongLine2, pos, hlen, hk;
-    long     longID;
-    char     szLine[INCHI_LINE_LEN], szNextLine[INCHI_LINE_ADD], *p, *q, *s, parity;
-    int      b2D = 0, b3D = 0, b23D, nNumBonds = 0, bNonZeroXYZ, bNonMetal;
-    int      len_stereo0D = 0, max_len_stereo0D = 0;
-    inchi_Stereo0D  *atom_stereo0D = NULL;
-    inchi_Atom      *atom = NULL;
-    MOL_COORD       *pszCoord = NULL;
-    INCHI_MODE InpAtomFlags = 0; /* 0 or FLAG_INP_AT_NONCHIRAL or FLAG_INP_AT_CHIRAL */
-    static const char szIsoH[] = "hdt";
-    /* plain tags */
-    static const char sStructHdrPln[] = "Structure:";
-    static const char sStructHdrPlnNoLblVal[] = " is missing";
-    static char sStructHdrPlnAuxStart[64] = ""; /*"$1.1Beta/";*/
-    static int  lenStructHdrPlnAuxStart = 0;
-    static const char sStructHdrPlnRevAt[] = "/rA:";
-    static const char sStructHdrPlnRevBn[] = "/rB:";
-    static const char sStructHdrPlnRevXYZ[] = "/rC:";
-    const  char *sToken;
-    int  lToken;
+    int a1, a2, n1, n2, valence;
+    int chem_bonds_valence;
+    int    nX = 0, nY = 0, nZ = 0, nXYZ;
+    int i, k, len, neigh, bond_type, bNonMetal, b2D = 0, b3D = 0, nNumBonds = 0;
+    inchi_Stereo0D *atom_stereo0D = *patom_stereo0D;
 
-    if (!lenStructHdrPlnAuxStart)
-    {
-        lenStructHdrPlnAuxStart = sprintf( sStructHdrPlnAuxStart, "AuxInfo=" );
-    }
+    /* special valences */
 
-    if (at)
+    for (bNonMetal = 0; bNonMetal < 1; bNonMetal++)
     {
 
-        if (*at && max_num_at)
-        {
-            memset( *at, 0, max_num_at * sizeof( **at ) );
-        }
-
-        if (stereo0D && num_stereo0D)
+        for (a1 = 0; a1 < num_atoms; a1++)
         {
-            if (*stereo0D && *num_stereo0D)
-            {
-                max_len_stereo0D = *num_stereo0D;
-                memset( *stereo0D, 0, max_len_stereo0D * sizeof( **stereo0D ) );
-            }
-            else
-            {
-                max_len_stereo0D = 0;
-            }
-        }
-    }
-    else  /* if ( at )  */
-    {
-        bFindNext = 1;
-    }
 
-    bHeaderRead = bErrorMsg = bRestoreInfo = 0;
-    *num_dimensions = *num_bonds = 0;
+            int num_bond_type[MAX_INPUT_BOND_TYPE - MIN_INPUT_BOND_TYPE + 1];
 
-    /*************************************************************/
-    /*   extract reversibility info from plain text INChI format */
-    /*************************************************************/
+            memset( num_bond_type, 0, sizeof( num_bond_type ) );
 
-    if (nInputType == INPUT_INCHI_PLAIN)
-    {
+            valence = AT_BONDS_VAL( atom, a1 ); /*  save atom valence if available */
+            AT_BONDS_VAL( atom, a1 ) = 0;
 
-        bHeaderRead = hk = 0;
 
-        while (0 < ( res = inchi_ios_getsTab( szLine, sizeof( szLine ) - 1, inp_file, &bTooLongLine ) ))
-        {
+            nX = nY = nZ = 0;
 
-            /********************* find and interpret structure header ************/
-            if (!bTooLongLine &&
-                ( hlen = sizeof( sStructHdrPln ) - 1, !memcmp( szLine, sStructHdrPln, hlen ) ))
+            for (n1 = 0; n1 < AT_NUM_BONDS( atom[a1] ); n1++)
             {
-                p = szLine + hlen;
-                longID = 0;
-                num_atoms = 0;
-
-                /* structure number */
-                longID = strtol( p, &q, 10 );
-                if (q && q[0] == '.' && q[1] == ' ')
-                    p = q + 2;
-                p = p + strspn( p, " \n\r" );
-
-                if (pSdfLabel)
+                bond_type = atom[a1].bond_type[n1] - MIN_INPUT_BOND_TYPE;
+                if (bond_type < 0 || bond_type > MAX_INPUT_BOND_TYPE - MIN_INPUT_BOND_TYPE)
                 {
-                    pSdfLabel[0] = '\0';
+                    bond_type = 0;
+                    TREAT_ERR( *err, 0, "Unknown bond type in InChI aux assigned as a single bond" );
                 }
 
-                if (pSdfValue)
+                num_bond_type[bond_type] ++;
+                nNumBonds++;
+                if (b23D)
                 {
-                    pSdfValue[0] = '\0';
+                    neigh = atom[a1].neighbor[n1];
+                    nX |= ( fabs( atom[a1].x - atom[neigh].x ) > MIN_BOND_LENGTH );
+                    nY |= ( fabs( atom[a1].y - atom[neigh].y ) > MIN_BOND_LENGTH );
+                    nZ |= ( fabs( atom[a1].z - atom[neigh].z ) > MIN_BOND_LENGTH );
                 }
+            }
 
+            chem_bonds_valence = 0;
+            for (n1 = 0; MIN_INPUT_BOND_TYPE + n1 <= 3 && MIN_INPUT_BOND_TYPE + n1 <= MAX_INPUT_BOND_TYPE; n1++)
+            {
+                chem_bonds_valence += ( MIN_INPUT_BOND_TYPE + n1 ) * num_bond_type[n1];
+            }
 
-                if (*p)
-                {
-                    /* has label name */
-
-                    /*p ++;*/
-                    if (q = strchr( p, '=' ))
-                    {
+            if (MIN_INPUT_BOND_TYPE <= INCHI_BOND_TYPE_ALTERN && INCHI_BOND_TYPE_ALTERN <= MAX_INPUT_BOND_TYPE &&
+                ( n2 = num_bond_type[INCHI_BOND_TYPE_ALTERN - MIN_INPUT_BOND_TYPE] ))
+            {
 
-                        /* '=' separates label name from the value */
-                        len = inchi_min( q - p + 1, MAX_SDF_HEADER - 1 );
+                /* accept input aromatic bonds for now */
 
-                        if (pSdfLabel)
-                        {
-                            mystrncpy( pSdfLabel, p, len );
-                            lrtrim( pSdfLabel, &len );
-                        }
+                switch (n2)
+                {
+                    case 2:
+                        chem_bonds_valence += 3;  /* =A- */
+                        break;
 
-                        p = q + 1;
-                        q = p + (int) strlen( p );
+                    case 3:
+                        chem_bonds_valence += 4;  /* =A< */
+                        break;
 
-                        if (q - p > 0)
+                    default:
+                        /*  if 1 or >= 4 aromatic bonds then replace such bonds with single bonds */
+                        for (n1 = 0; n1 < AT_NUM_BONDS( atom[a1] ); n1++)
                         {
-                            len = inchi_min( q - p + 1, MAX_SDF_VALUE - 1 );
-                            if (pSdfValue)
+                            if (atom[a1].bond_type[n1] == INCHI_BOND_TYPE_ALTERN)
                             {
-                                mystrncpy( pSdfValue, p, len );
+                                ATOM_NUMBER *p1;
+                                a2 = atom[a1].neighbor[n1];
+                                p1 = IN_NEIGH_LIST( atom[a2].neighbor, (ATOM_NUMBER) a1, AT_NUM_BONDS( atom[a2] ) );
+                                if (p1)
+                                {
+                                    atom[a1].bond_type[n1] =
+                                        atom[a2].bond_type[p1 - atom[a2].neighbor] = INCHI_BOND_TYPE_SINGLE;
+                                }
+                                else
+                                {
+                                    *err = -2;  /*  Program error */
+                                    TREAT_ERR( *err, 0, "Program error interpreting InChI aux" );
+                                    return 0; /*  no structure */
+                                }
                             }
-                            p = q;
                         }
-                    }
+
+                        chem_bonds_valence += n2;
+                        *err |= 32; /*  Unrecognized aromatic bond(s) replaced with single */
+                        TREAT_ERR( *err, 0, "Atom has 1 or more than 3 aromatic bonds" );
+                        break;
+                }
+            }
+            /********************************
+             *
+             *  Set number of hydrogen atoms
+             */
+            {
+                int num_iso_H;
+                num_iso_H = atom[a1].num_iso_H[1] + atom[a1].num_iso_H[2] + atom[a1].num_iso_H[3];
+                if (valence == ISOLATED_ATOM)
+                {
+                    atom[a1].num_iso_H[0] = 0;
+                }
+                else
+                {
+                    if (valence && valence >= chem_bonds_valence)
+                    {
+                        atom[a1].num_iso_H[0] = valence - chem_bonds_valence;
+                    }
+                    else
+                    {
+                        if (valence || bDoNotAddH)
+                        {
+                            atom[a1].num_iso_H[0] = 0;
+                        }
+                        else
+                        {
+                            if (!bDoNotAddH)
+                            {
+                                atom[a1].num_iso_H[0] = -1; /* auto add H */
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    nNumBonds /= 2;
+
+    if (b23D && nNumBonds)
+    {
+        nXYZ = nX + nY + nZ;
+        b2D = ( nXYZ > 0 );
+        b3D = ( nXYZ == 3 );
+        *num_dimensions = b3D ? 3 : b2D ? 2 : 0;
+        *num_bonds = nNumBonds;
+    }
+
+    /*======= 0D parities =================================*/
+    if (len_stereo0D > 0 && atom_stereo0D && stereo0D)
+    {
+        *stereo0D = atom_stereo0D;
+        *num_stereo0D = len_stereo0D;
+    }
+    else
+    {
+        FreeInchi_Stereo0D( patom_stereo0D );
+        atom_stereo0D = NULL;
+        *num_stereo0D = len_stereo0D = 0;
+    }
+
+    for (i = 0; i < len_stereo0D; i++)
+    {
+        ATOM_NUMBER *p1, *p2;
+        int     sb_ord_from_a1 = -1, sb_ord_from_a2 = -1, bEnd1 = 0, bEnd2 = 0;
+
+        switch (atom_stereo0D[i].type)
+        {
+
+            case INCHI_StereoType_Tetrahedral:
+                a1 = atom_stereo0D[i].central_atom;
+                if (atom_stereo0D[i].parity && ( AT_NUM_BONDS( atom[a1] ) == 3 || AT_NUM_BONDS( atom[a1] ) == 4 ))
+                {
+                    int ii, kk = 0;
+                    if (AT_NUM_BONDS( atom[a1] ) == 3)
+                        atom_stereo0D[i].neighbor[kk++] = a1;
+                    for (ii = 0; ii < AT_NUM_BONDS( atom[a1] ); ii++)
+                        atom_stereo0D[i].neighbor[kk++] = atom[a1].neighbor[ii];
+                }
+
+                break;
+
+            case INCHI_StereoType_DoubleBond:
+#define MAX_CHAIN_LEN 20
+                a1 = atom_stereo0D[i].neighbor[1];
+                a2 = atom_stereo0D[i].neighbor[2];
+                p1 = IN_NEIGH_LIST( atom[a1].neighbor, (ATOM_NUMBER) a2, AT_NUM_BONDS( atom[a1] ) );
+                p2 = IN_NEIGH_LIST( atom[a2].neighbor, (ATOM_NUMBER) a1, AT_NUM_BONDS( atom[a2] ) );
+                if (!p1 || !p2)
+                {
+                    atom_stereo0D[i].type = INCHI_StereoType_None;
+                    atom_stereo0D[i].central_atom = NO_ATOM;
+                    atom_stereo0D[i].neighbor[0] =
+                        atom_stereo0D[i].neighbor[3] = -1;
+                    *err |= 64; /* Error in cumulene stereo */
+                    TREAT_ERR( *err, 0, "0D stereobond not recognized" );
+                    break;
+                }
+
+                /* streobond, allene, or cumulene */
+
+                sb_ord_from_a1 = p1 - atom[a1].neighbor;
+                sb_ord_from_a2 = p2 - atom[a2].neighbor;
+
+                if (AT_NUM_BONDS( atom[a1] ) == 2 &&
+                      atom[a1].bond_type[0] + atom[a1].bond_type[1] == 2 * INCHI_BOND_TYPE_DOUBLE &&
+                      0 == inchi_NUMH2( atom, a1 ) &&
+                      ( AT_NUM_BONDS( atom[a2] ) != 2 ||
+                          atom[a2].bond_type[0] + atom[a2].bond_type[1] != 2 * INCHI_BOND_TYPE_DOUBLE ))
+                {
+                    bEnd2 = 1; /* a2 is the end-atom, a1 is middle atom */
+                }
+
+                if (AT_NUM_BONDS( atom[a2] ) == 2 &&
+                      atom[a2].bond_type[0] + atom[a2].bond_type[1] == 2 * INCHI_BOND_TYPE_DOUBLE &&
+                      0 == inchi_NUMH2( atom, a2 ) &&
+                      ( AT_NUM_BONDS( atom[a1] ) != 2 ||
+                          atom[a1].bond_type[0] + atom[a1].bond_type[1] != 2 * INCHI_BOND_TYPE_DOUBLE ))
+                {
+                    bEnd1 = 1; /* a1 is the end-atom, a2 is middle atom */
+                }
+
+                if (bEnd2 + bEnd1 == 1)
+                {
+                    /* allene or cumulene */
+
+                    ATOM_NUMBER  chain[MAX_CHAIN_LEN + 1], prev, cur, next;
+
+                    if (bEnd2 && !bEnd1)
+                    {
+                        cur = a1;
+                        a1 = a2;
+                        a2 = cur;
+                        sb_ord_from_a1 = sb_ord_from_a2;
+                    }
+
+                    sb_ord_from_a2 = -1;
+                    cur = a1;
+                    next = a2;
+                    len = 0;
+                    chain[len++] = cur;
+                    chain[len++] = next;
+
+                    while (len < MAX_CHAIN_LEN)
+                    {
+                        /* arbitrary very high upper limit to prevent infinite loop */
+
+                        prev = cur;
+                        cur = next;
+                            /* follow double bond path && avoid going back */
+                        if (AT_NUM_BONDS( atom[cur] ) == 2 &&
+                             atom[cur].bond_type[0] + atom[cur].bond_type[1] == 2 * INCHI_BOND_TYPE_DOUBLE &&
+                             0 == inchi_NUMH2( atom, cur ))
+                        {
+                            next = atom[cur].neighbor[atom[cur].neighbor[0] == prev];
+                            chain[len++] = next;
+                        }
+                        else
+                        {
+                            break;
+                        }
+                    }
+                    if (len > 2 &&
+                        ( p2 = IN_NEIGH_LIST( atom[cur].neighbor, (ATOM_NUMBER) prev, AT_NUM_BONDS( atom[cur] ) ) ))
+                    {
+                        sb_ord_from_a2 = p2 - atom[cur].neighbor;
+                        a2 = cur;
+                        /* by design we need to pick up the first non-stereo-bond-neighbor as "sn"-atom */
+                        atom_stereo0D[i].neighbor[0] = atom[a1].neighbor[sb_ord_from_a1 == 0];
+                        atom_stereo0D[i].neighbor[1] = a1;
+                        atom_stereo0D[i].neighbor[2] = a2;
+                        atom_stereo0D[i].neighbor[3] = atom[a2].neighbor[sb_ord_from_a2 == 0];
+
+                        if (len % 2)
+                        {
+                            atom_stereo0D[i].central_atom = chain[len / 2];
+                            atom_stereo0D[i].type = INCHI_StereoType_Allene;
+                        }
+                        else
+                        {
+                            atom_stereo0D[i].central_atom = NO_ATOM;
+                        }
+                    }
+                    else
+                    {
+                        /* error */
+                        atom_stereo0D[i].type = INCHI_StereoType_None;
+                        atom_stereo0D[i].central_atom = NO_ATOM;
+                        atom_stereo0D[i].neighbor[0] =
+                            atom_stereo0D[i].neighbor[3] = -1;
+                        *err |= 64; /* Error in cumulene stereo */
+                        TREAT_ERR( *err, 0, "Cumulene stereo not recognized (0D)" );
+                    }
+#undef MAX_CHAIN_LEN
+                }
+                else
+                {
+                    /****** a normal possibly stereogenic bond -- not an allene or cumulene *******/
+                    /* by design we need to pick up the first non-stereo-bond-neighbor as "sn"-atom */
+                    sb_ord_from_a1 = p1 - atom[a1].neighbor;
+                    sb_ord_from_a2 = p2 - atom[a2].neighbor;
+                    atom_stereo0D[i].neighbor[0] = atom[a1].neighbor[p1 == atom[a1].neighbor];
+                    atom_stereo0D[i].neighbor[3] = atom[a2].neighbor[p2 == atom[a2].neighbor];
+                    atom_stereo0D[i].central_atom = NO_ATOM;
+                }
+
+                if (atom_stereo0D[i].type != INCHI_StereoType_None &&
+                     sb_ord_from_a1 >= 0 && sb_ord_from_a2 >= 0 &&
+                     ATOM_PARITY_WELL_DEF( SB_PARITY_2( atom_stereo0D[i].parity ) ))
+                {
+                    /* Detected well-defined disconnected stereo
+                     * locate first non-metal neighbors */
+
+                    int    a, n, j, /* k,*/ sb_ord, cur_neigh, min_neigh;
+
+                    for (k = 0; k < 2; k++)
+                    {
+                        a = k ? atom_stereo0D[i].neighbor[2] : atom_stereo0D[i].neighbor[1];
+                        sb_ord = k ? sb_ord_from_a2 : sb_ord_from_a1;
+                        min_neigh = num_atoms;
+                        for (n = j = 0; j < AT_NUM_BONDS( atom[a] ); j++)
+                        {
+                            cur_neigh = atom[a].neighbor[j];
+                            if (j != sb_ord && !IS_METAL_ATOM( atom, cur_neigh ))
+                            {
+                                min_neigh = inchi_min( cur_neigh, min_neigh );
+                            }
+                        }
+                        if (min_neigh < num_atoms)
+                        {
+                            atom_stereo0D[i].neighbor[k ? 3 : 0] = min_neigh;
+                        }
+                        else
+                        {
+                            TREAT_ERR( *err, 0, "Cannot find non-metal stereobond neighor (0D)" );
+                        }
+                    }
+                }
+
+                break;
+        }
+    }
+    /* end of 0D parities extraction */
+
+    return num_atoms;
+}
+
+
+/****************************************************************************/
+int InchiToInchiAtom( INCHI_IOSTREAM *inp_file,
+                      inchi_Stereo0D **stereo0D,
+                      int *num_stereo0D,
+                      int bDoNotAddH,
+                      int vABParityUnknown,
+                      INPUT_TYPE nInputType,
+                      inchi_Atom **at,
+                      int max_num_at,
+                      int *num_dimensions,
+                      int *num_bonds,
+                      char *pSdfLabel,
+                      char *pSdfValue,
+                      long *Id,
+                      INCHI_MODE *pInpAtomFlags,
+                      int *err,
+                      char *pStrErr )
+{
+    int      num_atoms = 0, bFindNext = 0, len, bHeaderRead, bItemIsOver, bErrorMsg, bRestoreInfo;
+    int      bFatal = 0, num_struct = 0;
+    int      i, k, k2, res, bond_type, bond_stereo1, bond_stereo2, bond_char, neigh, bond_parity, bond_parityNM;
+    int      bTooLongLine, res2, bTooLongLine2, pos, hlen, hk;
+    long     longID;
+    char     szLine[INCHI_LINE_LEN], szNextLine[INCHI_LINE_ADD], *p, *q, *s, parity;
+    int      b2D = 0, b3D = 0, b23D, nNumBonds = 0, bNonZeroXYZ, bNonMetal;
+    int      len_stereo0D = 0, max_len_stereo0D = 0;
+    inchi_Stereo0D  *atom_stereo0D = NULL;
+    inchi_Atom      *atom = NULL;
+    MOL_COORD       *pszCoord = NULL;
+    INCHI_MODE InpAtomFlags = 0; /* 0 or FLAG_INP_AT_NONCHIRAL or FLAG_INP_AT_CHIRAL */
+    static const char szIsoH[] = "hdt";
+    /* plain tags */
+    static const char sStructHdrPln[] = "Structure:";
+    static const char sStructHdrPlnNoLblVal[] = " is missing";
+    static char sStructHdrPlnAuxStart[64] = ""; /*"$1.1Beta/";*/
+    static int  lenStructHdrPlnAuxStart = 0;
+    static const char sStructHdrPlnRevAt[] = "/rA:";
+    static const char sStructHdrPlnRevBn[] = "/rB:";
+    static const char sStructHdrPlnRevXYZ[] = "/rC:";
+    const  char *sToken;
+    int  lToken;
+
+    if (!lenStructHdrPlnAuxStart)
+    {
+        lenStructHdrPlnAuxStart = sprintf( sStructHdrPlnAuxStart, "AuxInfo=" );
+    }
+
+    if (at)
+    {
+
+        if (*at && max_num_at)
+        {
+            memset( *at, 0, max_num_at * sizeof( **at ) );
+        }
+
+        if (stereo0D && num_stereo0D)
+        {
+            if (*stereo0D && *num_stereo0D)
+            {
+                max_len_stereo0D = *num_stereo0D;
+                memset( *stereo0D, 0, max_len_stereo0D * sizeof( **stereo0D ) );
+            }
+            else
+            {
+                max_len_stereo0D = 0;
+            }
+        }
+    }
+    else  /* if ( at )  */
+    {
+        bFindNext = 1;
+    }
+
+    bHeaderRead = bErrorMsg = bRestoreInfo = 0;
+    *num_dimensions = *num_bonds = 0;
+
+    /*************************************************************/
+    /*   extract reversibility info from plain text INChI format */
+    /*************************************************************/
+
+    if (nInputType == INPUT_INCHI_PLAIN)
+    {
+
+        bHeaderRead = hk = 0;
+
+        while (0 < ( res = inchi_ios_getsTab( szLine, sizeof( szLine ) - 1, inp_file, &bTooLongLine ) ))
+        {
+
+            /********************* find and interpret structure header ************/
+            if (!bTooLongLine &&
+                ( hlen = sizeof( sStructHdrPln ) - 1, !memcmp( szLine, sStructHdrPln, hlen ) ))
+            {
+                p = szLine + hlen;
+                longID = 0;
+                num_atoms = 0;
+
+                /* structure number */
+                longID = strtol( p, &q, 10 );
+                if (q && q[0] == '.' && q[1] == ' ')
+                    p = q + 2;
+                p = p + strspn( p, " \n\r" );
+
+                if (pSdfLabel)
+                {
+                    pSdfLabel[0] = '\0';
+                }
+
+                if (pSdfValue)
+                {
+                    pSdfValue[0] = '\0';
+                }
+
+
+                if (*p)
+                {
+                    /* has label name */
+
+                    /*p ++;*/
+                    if (q = strchr( p, '=' ))
+                    {
+
+                        /* '=' separates label name from the value */
+                        len = inchi_min( q - p + 1, MAX_SDF_HEADER - 1 );
+
+                        if (pSdfLabel)
+                        {
+                            mystrncpy( pSdfLabel, p, len );
+                            lrtrim( pSdfLabel, &len );
+                        }
+
+                        p = q + 1;
+                        q = p + (int) strlen( p );
+
+                        if (q - p > 0)
+                        {
+                            len = inchi_min( q - p + 1, MAX_SDF_VALUE - 1 );
+                            if (pSdfValue)
+                            {
+                                mystrncpy( pSdfValue, p, len );
+                            }
+                            p = q;
+                        }
+                    }
                     else if (q = strstr( p, sStructHdrPlnNoLblVal ))
                     {
                         len = inchi_min( q - p + 1, MAX_SDF_HEADER - 1 );
@@ -1321,413 +2025,84 @@ int InchiToInchiAtom( INCHI_IOSTREAM *inp_file,
                             else
                             {
                                 if (*p == ',')
-                                {
-                                    /* empty */
-                                    pszCoord[i][LEN_COORD*k + 4] = '0';
-                                    xyz = 0.0;
-                                    p++;
-                                }
-                                else
-                                {
-                                    xyz = strtod( p, &q );
-                                    bNonZeroXYZ = fabs( xyz ) > MIN_BOND_LENGTH;
-                                    if (q != NULL)
-                                    {
-                                        memcpy( pszCoord[i] + LEN_COORD*k, p, q - p );
-                                        if (*q == ',')
-                                            q++;
-                                        p = q;
-                                    }
-                                    else
-                                        pszCoord[i][LEN_COORD*k + 4] = '0';
-                                }
-                            }
-
-                            switch (k)
-                            {
-                                case 0:
-                                    atom[i].x = xyz;
-                                    b2D |= bNonZeroXYZ;
-                                    break;
-                                case 1:
-                                    atom[i].y = xyz;
-                                    b2D |= bNonZeroXYZ;
-                                    break;
-                                case 2:
-                                    b3D |= bNonZeroXYZ;
-                                    atom[i].z = xyz;
-                                    break;
-                            }
-                        }
-
-                        if (*p == ';')
-                        {
-                            p++; /* end of this triple of coordinates */
-                            i++;
-                        }
-                        else
-                        {
-                            num_atoms = INCHI_INP_ERROR_RET; /* error in input data: atoms, bonds & coord must be present together */
-                            *err = INCHI_INP_ERROR_ERR;
-                            TREAT_ERR( *err, 0, "Wrong atom coordinates data" );
-                            goto bypass_end_of_INChI_plain;
-                        }
-                    }
-
-                    if (!bItemIsOver || s && p != s || i != num_atoms)
-                    {
-                        num_atoms = INCHI_INP_ERROR_RET; /* error */
-                        *err = INCHI_INP_ERROR_ERR;
-                        TREAT_ERR( *err, 0, "Wrong number of coordinates" );
-                        goto bypass_end_of_INChI_plain;
-                    }
-                } /* end of coordinates */
-
-
-                /* set special valences and implicit H (xml) */
-
-                b23D = b2D | b3D;
-                b2D = b3D = 0;
-                if (at)
-                {
-                    if (!*at)
-                    {
-                        int a1, a2, n1, n2, valence;
-                        int chem_bonds_valence;
-                        int    nX = 0, nY = 0, nZ = 0, nXYZ;
-                        *at = atom;
-
-                        /* special valences */
-
-                        for (bNonMetal = 0; bNonMetal < 1; bNonMetal++)
-                        {
-
-                            for (a1 = 0; a1 < num_atoms; a1++)
-                            {
-
-                                int num_bond_type[MAX_INPUT_BOND_TYPE - MIN_INPUT_BOND_TYPE + 1];
-
-                                memset( num_bond_type, 0, sizeof( num_bond_type ) );
-
-                                valence = AT_BONDS_VAL( atom, a1 ); /*  save atom valence if available */
-                                AT_BONDS_VAL( atom, a1 ) = 0;
-
-
-                                nX = nY = nZ = 0;
-
-                                for (n1 = 0; n1 < AT_NUM_BONDS( atom[a1] ); n1++)
-                                {
-                                    bond_type = atom[a1].bond_type[n1] - MIN_INPUT_BOND_TYPE;
-                                    if (bond_type < 0 || bond_type > MAX_INPUT_BOND_TYPE - MIN_INPUT_BOND_TYPE)
-                                    {
-                                        bond_type = 0;
-                                        TREAT_ERR( *err, 0, "Unknown bond type in InChI aux assigned as a single bond" );
-                                    }
-
-                                    num_bond_type[bond_type] ++;
-                                    nNumBonds++;
-                                    if (b23D)
-                                    {
-                                        neigh = atom[a1].neighbor[n1];
-                                        nX |= ( fabs( atom[a1].x - atom[neigh].x ) > MIN_BOND_LENGTH );
-                                        nY |= ( fabs( atom[a1].y - atom[neigh].y ) > MIN_BOND_LENGTH );
-                                        nZ |= ( fabs( atom[a1].z - atom[neigh].z ) > MIN_BOND_LENGTH );
-                                    }
-                                }
-
-                                chem_bonds_valence = 0;
-                                for (n1 = 0; MIN_INPUT_BOND_TYPE + n1 <= 3 && MIN_INPUT_BOND_TYPE + n1 <= MAX_INPUT_BOND_TYPE; n1++)
-                                {
-                                    chem_bonds_valence += ( MIN_INPUT_BOND_TYPE + n1 ) * num_bond_type[n1];
-                                }
-
-                                if (MIN_INPUT_BOND_TYPE <= INCHI_BOND_TYPE_ALTERN && INCHI_BOND_TYPE_ALTERN <= MAX_INPUT_BOND_TYPE &&
-                                    ( n2 = num_bond_type[INCHI_BOND_TYPE_ALTERN - MIN_INPUT_BOND_TYPE] ))
-                                {
-
-                                    /* accept input aromatic bonds for now */
-
-                                    switch (n2)
-                                    {
-                                        case 2:
-                                            chem_bonds_valence += 3;  /* =A- */
-                                            break;
-
-                                        case 3:
-                                            chem_bonds_valence += 4;  /* =A< */
-                                            break;
-
-                                        default:
-                                            /*  if 1 or >= 4 aromatic bonds then replace such bonds with single bonds */
-                                            for (n1 = 0; n1 < AT_NUM_BONDS( atom[a1] ); n1++)
-                                            {
-                                                if (atom[a1].bond_type[n1] == INCHI_BOND_TYPE_ALTERN)
-                                                {
-                                                    ATOM_NUMBER *p1;
-                                                    a2 = atom[a1].neighbor[n1];
-                                                    p1 = IN_NEIGH_LIST( atom[a2].neighbor, (ATOM_NUMBER) a1, AT_NUM_BONDS( atom[a2] ) );
-                                                    if (p1)
-                                                    {
-                                                        atom[a1].bond_type[n1] =
-                                                            atom[a2].bond_type[p1 - atom[a2].neighbor] = INCHI_BOND_TYPE_SINGLE;
-                                                    }
-                                                    else
-                                                    {
-                                                        *err = -2;  /*  Program error */
-                                                        TREAT_ERR( *err, 0, "Program error interpreting InChI aux" );
-                                                        num_atoms = 0;
-                                                        goto bypass_end_of_INChI_plain; /*  no structure */
-                                                    }
-                                                }
-                                            }
-
-                                            chem_bonds_valence += n2;
-                                            *err |= 32; /*  Unrecognized aromatic bond(s) replaced with single */
-                                            TREAT_ERR( *err, 0, "Atom has 1 or more than 3 aromatic bonds" );
-                                            break;
-                                    }
-                                }
-                                /********************************
-                                 *
-                                 *  Set number of hydrogen atoms
-                                 */
-                                {
-                                    int num_iso_H;
-                                    num_iso_H = atom[a1].num_iso_H[1] + atom[a1].num_iso_H[2] + atom[a1].num_iso_H[3];
-                                    if (valence == ISOLATED_ATOM)
-                                    {
-                                        atom[a1].num_iso_H[0] = 0;
-                                    }
-                                    else
-                                    {
-                                        if (valence && valence >= chem_bonds_valence)
-                                        {
-                                            atom[a1].num_iso_H[0] = valence - chem_bonds_valence;
-                                        }
-                                        else
-                                        {
-                                            if (valence || bDoNotAddH)
-                                            {
-                                                atom[a1].num_iso_H[0] = 0;
-                                            }
-                                            else
-                                            {
-                                                if (!bDoNotAddH)
-                                                {
-                                                    atom[a1].num_iso_H[0] = -1; /* auto add H */
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        nNumBonds /= 2;
-
-                        if (b23D && nNumBonds)
-                        {
-                            nXYZ = nX + nY + nZ;
-                            b2D = ( nXYZ > 0 );
-                            b3D = ( nXYZ == 3 );
-                            *num_dimensions = b3D ? 3 : b2D ? 2 : 0;
-                            *num_bonds = nNumBonds;
-                        }
-
-                        /*======= 0D parities =================================*/
-                        if (len_stereo0D > 0 && atom_stereo0D && stereo0D)
-                        {
-                            *stereo0D = atom_stereo0D;
-                            *num_stereo0D = len_stereo0D;
-                        }
-                        else
-                        {
-                            FreeInchi_Stereo0D( &atom_stereo0D );
-                            *num_stereo0D = len_stereo0D = 0;
-                        }
-
-                        for (i = 0; i < len_stereo0D; i++)
-                        {
-                            ATOM_NUMBER *p1, *p2;
-                            int     sb_ord_from_a1 = -1, sb_ord_from_a2 = -1, bEnd1 = 0, bEnd2 = 0;
-
-                            switch (atom_stereo0D[i].type)
-                            {
-
-                                case INCHI_StereoType_Tetrahedral:
-                                    a1 = atom_stereo0D[i].central_atom;
-                                    if (atom_stereo0D[i].parity && ( AT_NUM_BONDS( atom[a1] ) == 3 || AT_NUM_BONDS( atom[a1] ) == 4 ))
-                                    {
-                                        int ii, kk = 0;
-                                        if (AT_NUM_BONDS( atom[a1] ) == 3)
-                                            atom_stereo0D[i].neighbor[kk++] = a1;
-                                        for (ii = 0; ii < AT_NUM_BONDS( atom[a1] ); ii++)
-                                            atom_stereo0D[i].neighbor[kk++] = atom[a1].neighbor[ii];
-                                    }
-
-                                    break;
-
-                                case INCHI_StereoType_DoubleBond:
-#define MAX_CHAIN_LEN 20
-                                    a1 = atom_stereo0D[i].neighbor[1];
-                                    a2 = atom_stereo0D[i].neighbor[2];
-                                    p1 = IN_NEIGH_LIST( atom[a1].neighbor, (ATOM_NUMBER) a2, AT_NUM_BONDS( atom[a1] ) );
-                                    p2 = IN_NEIGH_LIST( atom[a2].neighbor, (ATOM_NUMBER) a1, AT_NUM_BONDS( atom[a2] ) );
-                                    if (!p1 || !p2)
-                                    {
-                                        atom_stereo0D[i].type = INCHI_StereoType_None;
-                                        atom_stereo0D[i].central_atom = NO_ATOM;
-                                        atom_stereo0D[i].neighbor[0] =
-                                            atom_stereo0D[i].neighbor[3] = -1;
-                                        *err |= 64; /* Error in cumulene stereo */
-                                        TREAT_ERR( *err, 0, "0D stereobond not recognized" );
-                                        break;
-                                    }
-
-                                    /* streobond, allene, or cumulene */
-
-                                    sb_ord_from_a1 = p1 - atom[a1].neighbor;
-                                    sb_ord_from_a2 = p2 - atom[a2].neighbor;
-
-                                    if (AT_NUM_BONDS( atom[a1] ) == 2 &&
-                                          atom[a1].bond_type[0] + atom[a1].bond_type[1] == 2 * INCHI_BOND_TYPE_DOUBLE &&
-                                          0 == inchi_NUMH2( atom, a1 ) &&
-                                          ( AT_NUM_BONDS( atom[a2] ) != 2 ||
-                                              atom[a2].bond_type[0] + atom[a2].bond_type[1] != 2 * INCHI_BOND_TYPE_DOUBLE ))
-                                    {
-                                        bEnd2 = 1; /* a2 is the end-atom, a1 is middle atom */
-                                    }
-
-                                    if (AT_NUM_BONDS( atom[a2] ) == 2 &&
-                                          atom[a2].bond_type[0] + atom[a2].bond_type[1] == 2 * INCHI_BOND_TYPE_DOUBLE &&
-                                          0 == inchi_NUMH2( atom, a2 ) &&
-                                          ( AT_NUM_BONDS( atom[a1] ) != 2 ||
-                                              atom[a1].bond_type[0] + atom[a1].bond_type[1] != 2 * INCHI_BOND_TYPE_DOUBLE ))
-                                    {
-                                        bEnd1 = 1; /* a1 is the end-atom, a2 is middle atom */
-                                    }
-
-                                    if (bEnd2 + bEnd1 == 1)
-                                    {
-                                        /* allene or cumulene */
-
-                                        ATOM_NUMBER  chain[MAX_CHAIN_LEN + 1], prev, cur, next;
-
-                                        if (bEnd2 && !bEnd1)
-                                        {
-                                            cur = a1;
-                                            a1 = a2;
-                                            a2 = cur;
-                                            sb_ord_from_a1 = sb_ord_from_a2;
-                                        }
-
-                                        sb_ord_from_a2 = -1;
-                                        cur = a1;
-                                        next = a2;
-                                        len = 0;
-                                        chain[len++] = cur;
-                                        chain[len++] = next;
-
-                                        while (len < MAX_CHAIN_LEN)
-                                        {
-                                            /* arbitrary very high upper limit to prevent infinite loop */
-
-                                            prev = cur;
-                                            cur = next;
-                                                /* follow double bond path && avoid going back */
-                                            if (AT_NUM_BONDS( atom[cur] ) == 2 &&
-                                                 atom[cur].bond_type[0] + atom[cur].bond_type[1] == 2 * INCHI_BOND_TYPE_DOUBLE &&
-                                                 0 == inchi_NUMH2( atom, cur ))
-                                            {
-                                                next = atom[cur].neighbor[atom[cur].neighbor[0] == prev];
-                                                chain[len++] = next;
-                                            }
-                                            else
-                                            {
-                                                break;
-                                            }
-                                        }
-                                        if (len > 2 &&
-                                            ( p2 = IN_NEIGH_LIST( atom[cur].neighbor, (ATOM_NUMBER) prev, AT_NUM_BONDS( atom[cur] ) ) ))
-                                        {
-                                            sb_ord_from_a2 = p2 - atom[cur].neighbor;
-                                            a2 = cur;
-                                            /* by design we need to pick up the first non-stereo-bond-neighbor as "sn"-atom */
-                                            atom_stereo0D[i].neighbor[0] = atom[a1].neighbor[sb_ord_from_a1 == 0];
-                                            atom_stereo0D[i].neighbor[1] = a1;
-                                            atom_stereo0D[i].neighbor[2] = a2;
-                                            atom_stereo0D[i].neighbor[3] = atom[a2].neighbor[sb_ord_from_a2 == 0];
-
-                                            if (len % 2)
-                                            {
-                                                atom_stereo0D[i].central_atom = chain[len / 2];
-                                                atom_stereo0D[i].type = INCHI_StereoType_Allene;
-                                            }
-                                            else
-                                            {
-                                                atom_stereo0D[i].central_atom = NO_ATOM;
-                                            }
-                                        }
-                                        else
-                                        {
-                                            /* error */
-                                            atom_stereo0D[i].type = INCHI_StereoType_None;
-                                            atom_stereo0D[i].central_atom = NO_ATOM;
-                                            atom_stereo0D[i].neighbor[0] =
-                                                atom_stereo0D[i].neighbor[3] = -1;
-                                            *err |= 64; /* Error in cumulene stereo */
-                                            TREAT_ERR( *err, 0, "Cumulene stereo not recognized (0D)" );
-                                        }
-#undef MAX_CHAIN_LEN
-                                    }
-                                    else
-                                    {
-                                        /****** a normal possibly stereogenic bond -- not an allene or cumulene *******/
-                                        /* by design we need to pick up the first non-stereo-bond-neighbor as "sn"-atom */
-                                        sb_ord_from_a1 = p1 - atom[a1].neighbor;
-                                        sb_ord_from_a2 = p2 - atom[a2].neighbor;
-                                        atom_stereo0D[i].neighbor[0] = atom[a1].neighbor[p1 == atom[a1].neighbor];
-                                        atom_stereo0D[i].neighbor[3] = atom[a2].neighbor[p2 == atom[a2].neighbor];
-                                        atom_stereo0D[i].central_atom = NO_ATOM;
-                                    }
-
-                                    if (atom_stereo0D[i].type != INCHI_StereoType_None &&
-                                         sb_ord_from_a1 >= 0 && sb_ord_from_a2 >= 0 &&
-                                         ATOM_PARITY_WELL_DEF( SB_PARITY_2( atom_stereo0D[i].parity ) ))
-                                    {
-                                        /* Detected well-defined disconnected stereo
-                                         * locate first non-metal neighbors */
-
-                                        int    a, n, j, /* k,*/ sb_ord, cur_neigh, min_neigh;
-
-                                        for (k = 0; k < 2; k++)
-                                        {
-                                            a = k ? atom_stereo0D[i].neighbor[2] : atom_stereo0D[i].neighbor[1];
-                                            sb_ord = k ? sb_ord_from_a2 : sb_ord_from_a1;
-                                            min_neigh = num_atoms;
-                                            for (n = j = 0; j < AT_NUM_BONDS( atom[a] ); j++)
-                                            {
-                                                cur_neigh = atom[a].neighbor[j];
-                                                if (j != sb_ord && !IS_METAL_ATOM( atom, cur_neigh ))
-                                                {
-                                                    min_neigh = inchi_min( cur_neigh, min_neigh );
-                                                }
-                                            }
-                                            if (min_neigh < num_atoms)
-                                            {
-                                                atom_stereo0D[i].neighbor[k ? 3 : 0] = min_neigh;
-                                            }
-                                            else
-                                            {
-                                                TREAT_ERR( *err, 0, "Cannot find non-metal stereobond neighor (0D)" );
-                                            }
-                                        }
+                                {
+                                    /* empty */
+                                    pszCoord[i][LEN_COORD*k + 4] = '0';
+                                    xyz = 0.0;
+                                    p++;
+                                }
+                                else
+                                {
+                                    xyz = strtod( p, &q );
+                                    bNonZeroXYZ = fabs( xyz ) > MIN_BOND_LENGTH;
+                                    if (q != NULL)
+                                    {
+                                        memcpy( pszCoord[i] + LEN_COORD*k, p, q - p );
+                                        if (*q == ',')
+                                            q++;
+                                        p = q;
                                     }
+                                    else
+                                        pszCoord[i][LEN_COORD*k + 4] = '0';
+                                }
+                            }
 
+                            switch (k)
+                            {
+                                case 0:
+                                    atom[i].x = xyz;
+                                    b2D |= bNonZeroXYZ;
+                                    break;
+                                case 1:
+                                    atom[i].y = xyz;
+                                    b2D |= bNonZeroXYZ;
+                                    break;
+                                case 2:
+                                    b3D |= bNonZeroXYZ;
+                                    atom[i].z = xyz;
                                     break;
                             }
                         }
-                        /* end of 0D parities extraction */
+
+                        if (*p == ';')
+                        {
+                            p++; /* end of this triple of coordinates */
+                            i++;
+                        }
+                        else
+                        {
+                            num_atoms = INCHI_INP_ERROR_RET; /* error in input data: atoms, bonds & coord must be present together */
+                            *err = INCHI_INP_ERROR_ERR;
+                            TREAT_ERR( *err, 0, "Wrong atom coordinates data" );
+                            goto bypass_end_of_INChI_plain;
+                        }
+                    }
+
+                    if (!bItemIsOver || s && p != s || i != num_atoms)
+                    {
+                        num_atoms = INCHI_INP_ERROR_RET; /* error */
+                        *err = INCHI_INP_ERROR_ERR;
+                        TREAT_ERR( *err, 0, "Wrong number of coordinates" );
+                        goto bypass_end_of_INChI_plain;
+                    }
+                } /* end of coordinates */
+
+
+                /* set special valences and implicit H (xml) */
+
+                b23D = b2D | b3D;
+                b2D = b3D = 0;
+                if (at)
+                {
+                    if (!*at)
+                    {
+                        *at = atom;
+                        num_atoms = SetInchiAtomValencesAndStereo0D( atom, num_atoms,
+                                                                     &atom_stereo0D, len_stereo0D,
+                                                                     b23D, bDoNotAddH,
+                                                                     stereo0D, num_stereo0D,
+                                                                     num_dimensions, num_bonds,
+                                                                     err, pStrErr );
 /*exit_cycle:;*/
                     }
 
@@ -3044,3 +3419,593 @@ int InchiToInchiAtom( INCHI_IOSTREAM *inp_file,
     return num_atoms;
 }
 
+
+/****************************************************************************
+  Next non-empty line of zero-terminated szText starting at *pnPos;
+  lines are separated by LF or tab and trimmed as inchi_ios_getsTab()
+  does. Returns the line start, *pEnd receives its end.
+****************************************************************************/
+static const char *AuxInfoNextLine( const char *szText,
+                                    int nLen,
+                                    int *pnPos,
+                                    const char **pEnd )
+{
+    const char *p, *q;
+
+    while (*pnPos < nLen)
+    {
+        p = szText + *pnPos;
+        q = p + strcspn( p, "\t\n" );
+        *pnPos = (int) ( q - szText ) + ( *q != '\0' );
+        while (p < q && __isascii( UCINT *p ) && isspace( UCINT *p ))
+        {
+            p++;
+        }
+        while (p < q && __isascii( UCINT q[-1] ) && isspace( UCINT q[-1] ))
+        {
+            q--;
+        }
+        if (p < q)
+        {
+            *pEnd = q;
+            return p;
+        }
+    }
+
+    return NULL;
+}
+
+
+/****************************************************************************
+  Find sToken in [p, end); returns the position just after it or NULL
+****************************************************************************/
+static const char *AuxInfoFindToken( const char *p,
+                                     const char *end,
+                                     const char *sToken,
+                                     int lToken )
+{
+    while (end - p >= lToken &&
+            ( p = (const char *) memchr( p, sToken[0], end - p - lToken + 1 ) ))
+    {
+        if (!memcmp( p, sToken, lToken ))
+        {
+            return p + lToken;
+        }
+        p++;
+    }
+
+    return NULL;
+}
+
+
+/****************************************************************************
+  strtod() for AuxInfo coordinates written as [-]ddd.dddd: the decimal
+  mantissa below 2^53 and at most 22 fractional digits make m/10^k
+  correctly rounded, that is, equal to strtod() result; anything else
+  (exponent, hex, inf, too many digits) goes to strtod() itself.
+****************************************************************************/
+static double AuxInfoStrtod( const char *p, char **q )
+{
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+                                    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char *s = p + ( *p == '-' || *p == '+' );
+    double m = 0.0;
+    int nDigits = 0, nFrac = -1;
+
+    for (; ; s++)
+    {
+        if (isdigit( UCINT *s ))
+        {
+            m = 10.0 * m + ( *s - '0' );
+            nDigits++;
+            nFrac += ( nFrac >= 0 );
+        }
+        else if (*s == '.' && nFrac < 0)
+        {
+            nFrac = 0;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (!nDigits || nDigits > 15 || nFrac > 22 ||
+         *s == 'e' || *s == 'E' || *s == 'x' || *s == 'X')
+    {
+        return strtod( p, q );
+    }
+    *q = (char *) s;
+    if (nFrac > 0)
+    {
+        m /= pow10[nFrac];
+    }
+
+    return *p == '-' ? -m : m;
+}
+
+
+/****************************************************************************
+  Read the next AuxInfo line of the zero-terminated string szText into
+  inchi_Atom/inchi_Stereo0D.
+
+  Same result as InchiToInchiAtom( ..., INPUT_INCHI_PLAIN, ... ) applied
+  to a string stream, but the /rA, /rB, /rC layers are parsed in place:
+  no line buffer, no character-by-character stream reads and no rescans
+  of the line. Lines other than AuxInfo (InChI, "Structure:" headers) are
+  skipped; *pnPos is advanced past the AuxInfo line read.
+  *at and *stereo0D should be NULL on entry.
+****************************************************************************/
+int AuxInfoToInchiAtom( const char *szText,
+                        int nLen,
+                        int *pnPos,
+                        inchi_Stereo0D **stereo0D,
+                        int *num_stereo0D,
+                        int bDoNotAddH,
+                        inchi_Atom **at,
+                        int *num_dimensions,
+                        int *num_bonds,
+                        INCHI_MODE *pInpAtomFlags,
+                        int *err,
+                        char *pStrErr )
+{
+    static const char sAuxStart[] = "AuxInfo=";
+    static const char sRevAt[] = "/rA:";
+    static const char sRevBn[] = "/rB:";
+    static const char sRevXYZ[] = "/rC:";
+    static const char szIsoH[] = "hdt";
+    int  num_atoms = 0, i, k, k2, bond_type, bond_stereo1, bond_stereo2, bond_char;
+    int  neigh, bond_parity, bond_parityNM, b2D = 0, b3D = 0, bNonZeroXYZ;
+    int  len_stereo0D = 0, max_len_stereo0D = 0;
+    const char *p, *s, *end;
+    char *q, parity;
+    double xyz;
+    inchi_Stereo0D  *atom_stereo0D = NULL;
+    inchi_Atom      *atom = NULL;
+    INCHI_MODE InpAtomFlags = 0; /* 0 or FLAG_INP_AT_NONCHIRAL or FLAG_INP_AT_CHIRAL */
+
+    *num_dimensions = *num_bonds = 0;
+
+    do
+    {
+        if (!( p = AuxInfoNextLine( szText, nLen, pnPos, &end ) ))
+        {
+            *err = INCHI_INP_EOF_ERR;
+            return INCHI_INP_EOF_RET; /* no more data */
+        }
+    }
+    while (end - p < (int) sizeof( sAuxStart ) - 1 ||
+            memcmp( p, sAuxStart, sizeof( sAuxStart ) - 1 ));
+
+    /* check for empty "AuxInfo=ver//" */
+    s = (const char *) memchr( p + sizeof( sAuxStart ) - 1, '/',
+                               end - p - ( sizeof( sAuxStart ) - 1 ) );
+    if (s && s + 2 == end && s[1] == '/')
+    {
+        return 0;
+    }
+
+    /***************** atoms: /rA:<num_atoms>[c|n]<atoms> **********************/
+    if (!( p = AuxInfoFindToken( p, end, sRevAt, sizeof( sRevAt ) - 1 ) ))
+    {
+        TREAT_ERR( *err, 0, "Missing atom data" );
+        goto exit_error;
+    }
+    s = (const char *) memchr( p, '/', end - p ); /* end of the layer */
+
+    num_atoms = p < end ? (int) strtol( p, &q, 10 ) : 0;
+    if (!num_atoms || q >= end)
+    {
+        return 0; /* no atom data */
+    }
+    p = q;
+
+    /* Molfile chirality flag */
+    switch (*p)
+    {
+        case 'c':
+            InpAtomFlags |= FLAG_INP_AT_CHIRAL;
+            p++;
+            break;
+        case 'n':
+            InpAtomFlags |= FLAG_INP_AT_NONCHIRAL;
+            p++;
+            break;
+    }
+
+    max_len_stereo0D = num_atoms + 1;
+    if (!( atom = CreateInchiAtom( num_atoms + 1 ) ) ||
+         !( atom_stereo0D = CreateInchi_Stereo0D( max_len_stereo0D ) ))
+    {
+        goto exit_fatal;
+    }
+
+    /* the line is zero- or space-terminated: no item can run past its end */
+    for (i = 0; i < num_atoms && isalpha( UCINT *p ) && isupper( UCINT *p ); i++)
+    {
+        /* element */
+        atom[i].elname[0] = *p++;
+        if (isalpha( UCINT *p ) && islower( UCINT *p ))
+        {
+            atom[i].elname[1] = *p++;
+        }
+
+        /* bonds' valence + number of non-isotopic H */
+        if (isdigit( UCINT *p ))
+        {
+            AT_BONDS_VAL( atom, i ) = (char) strtol( p, &q, 10 );
+            if (!AT_BONDS_VAL( atom, i ))
+                AT_BONDS_VAL( atom, i ) = ISOLATED_ATOM; /* same convention as in MOLfile, found zero bonds valence */
+            p = q;
+        }
+
+        /* charge */
+        atom[i].charge = ( *p == '+' ) ? 1 : ( *p == '-' ) ? -1 : 0;
+        if (atom[i].charge)
+        {
+            p++;
+            if (isdigit( UCINT *p ))
+            {
+                atom[i].charge *= (S_CHAR) ( strtol( p, &q, 10 ) & CHAR_MASK );
+                p = q;
+            }
+        }
+
+        /* radical */
+        if (*p == '.')
+        {
+            p++;
+            if (isdigit( UCINT *p ))
+            {
+                atom[i].radical = (S_CHAR) strtol( p, &q, 10 );
+                p = q;
+            }
+        }
+
+        /* isotopic mass */
+        if (*p == 'i')
+        {
+            p++;
+            if (isdigit( UCINT *p ))
+            {
+                atom[i].isotopic_mass = (AT_NUM) strtol( p, &q, 10 );
+                p = q;
+            }
+        }
+
+        /* parity */
+        switch (*p)
+        {
+            case 'o':
+                parity = INCHI_PARITY_ODD;
+                p++;
+                break;
+            case 'e':
+                parity = INCHI_PARITY_EVEN;
+                p++;
+                break;
+            case 'u':
+                parity = INCHI_PARITY_UNKNOWN;
+                p++;
+                break;
+            case '?':
+                parity = INCHI_PARITY_UNDEFINED;
+                p++;
+                break;
+            default:
+                parity = 0;
+                break;
+        }
+        if (parity)
+        {
+            atom_stereo0D[len_stereo0D].central_atom = i;
+            atom_stereo0D[len_stereo0D].parity = parity;
+            atom_stereo0D[len_stereo0D].type = INCHI_StereoType_Tetrahedral;
+            len_stereo0D++;
+        }
+
+        /* isotopic h, d, t */
+        for (k = 0; k < NUM_H_ISOTOPES; k++)
+        {
+            if (*p == szIsoH[k])
+            {
+                NUM_ISO_Hk( atom, i, k ) = 1;
+                p++;
+                if (isdigit( UCINT *p ))
+                {
+                    NUM_ISO_Hk( atom, i, k ) = (char) strtol( p, &q, 10 );
+                    p = q;
+                }
+            }
+        }
+    }
+
+    if (i != num_atoms || s && p != s)
+    {
+        TREAT_ERR( *err, 0, "Wrong number of atoms" );
+        goto exit_error;
+    }
+
+    /***************** bonds: /rB: **********************/
+    if (!( p = AuxInfoFindToken( p, end, sRevBn, sizeof( sRevBn ) - 1 ) ))
+    {
+        TREAT_ERR( *err, 0, "Missing bonds data" );
+        goto exit_error;
+    }
+    s = (const char *) memchr( p, '/', end - p );
+
+    for (i = 1; i < num_atoms && !( s && p >= s ); )
+    {
+        if (*p == ';')
+        {
+            p++;
+            i++;
+            continue;
+        }
+        if (!isalpha( UCINT *p ))
+        {
+            TREAT_ERR( *err, 0, "Wrong bonds data" );
+            goto exit_error;
+        }
+        bond_char = *p++;
+
+        /* bond parity */
+        switch (*p)
+        {
+            case '-':
+                bond_parity = INCHI_PARITY_ODD;
+                p++;
+                break;
+            case '+':
+                bond_parity = INCHI_PARITY_EVEN;
+                p++;
+                break;
+            case 'u':
+                bond_parity = INCHI_PARITY_UNKNOWN;
+                p++;
+                break;
+            case '?':
+                bond_parity = INCHI_PARITY_UNDEFINED;
+                p++;
+                break;
+            default:
+                bond_parity = 0;
+                break;
+        }
+        bond_parityNM = 0;
+        if (bond_parity)
+        {
+            switch (*p)
+            {
+                case '-':
+                    bond_parityNM = INCHI_PARITY_ODD;
+                    p++;
+                    break;
+                case '+':
+                    bond_parityNM = INCHI_PARITY_EVEN;
+                    p++;
+                    break;
+                case 'u':
+                    bond_parityNM = INCHI_PARITY_UNKNOWN;
+                    p++;
+                    break;
+                case '?':
+                    bond_parityNM = INCHI_PARITY_UNDEFINED;
+                    p++;
+                    break;
+            }
+        }
+
+        /* neighbor of the current atom */
+        if (!isdigit( UCINT *p ))
+        {
+            TREAT_ERR( *err, 0, "Wrong bonds data" );
+            goto exit_error;
+        }
+        neigh = (int) strtol( p, &q, 10 ) - 1;
+        if (neigh < 0 || neigh >= num_atoms)
+        {
+            TREAT_ERR( *err, 0, "Bond to nonexistent atom" );
+            goto exit_error;
+        }
+        if (AT_NUM_BONDS( atom[i] ) >= MAXVAL || AT_NUM_BONDS( atom[neigh] ) >= MAXVAL)
+        {
+            TREAT_ERR( *err, 0, "Too many bonds" );
+            goto exit_error;
+        }
+        p = q;
+
+        /* bond type & 2D stereo */
+        bond_stereo1 = bond_stereo2 = 0;
+        switch (bond_char)
+        {
+            case 'v':
+                bond_type = INCHI_BOND_TYPE_SINGLE;
+                bond_stereo1 = INCHI_BOND_STEREO_SINGLE_1EITHER;
+                bond_stereo2 = INCHI_BOND_STEREO_SINGLE_2EITHER;
+                break;
+            case 'V':
+                bond_type = INCHI_BOND_TYPE_SINGLE;
+                bond_stereo1 = INCHI_BOND_STEREO_SINGLE_2EITHER;
+                bond_stereo2 = INCHI_BOND_STEREO_SINGLE_1EITHER;
+                break;
+            case 'w':
+                bond_type = INCHI_BOND_TYPE_DOUBLE;
+                bond_stereo1 =
+                    bond_stereo2 = INCHI_BOND_STEREO_DOUBLE_EITHER;
+                break;
+            case 's':
+                bond_type = INCHI_BOND_TYPE_SINGLE;
+                break;
+            case 'd':
+                bond_type = INCHI_BOND_TYPE_DOUBLE;
+                break;
+            case 't':
+                bond_type = INCHI_BOND_TYPE_TRIPLE;
+                break;
+            case 'a':
+                bond_type = INCHI_BOND_TYPE_ALTERN;
+                break;
+            case 'p':
+                bond_type = INCHI_BOND_TYPE_SINGLE;
+                bond_stereo1 = INCHI_BOND_STEREO_SINGLE_1UP;
+                bond_stereo2 = INCHI_BOND_STEREO_SINGLE_2UP;
+                break;
+            case 'P':
+                bond_type = INCHI_BOND_TYPE_SINGLE;
+                bond_stereo1 = INCHI_BOND_STEREO_SINGLE_2UP;
+                bond_stereo2 = INCHI_BOND_STEREO_SINGLE_1UP;
+                break;
+            case 'n':
+                bond_type = INCHI_BOND_TYPE_SINGLE;
+                bond_stereo1 = INCHI_BOND_STEREO_SINGLE_1DOWN;
+                bond_stereo2 = INCHI_BOND_STEREO_SINGLE_2DOWN;
+                break;
+            case 'N':
+                bond_type = INCHI_BOND_TYPE_SINGLE;
+                bond_stereo1 = INCHI_BOND_STEREO_SINGLE_2DOWN;
+                bond_stereo2 = INCHI_BOND_STEREO_SINGLE_1DOWN;
+                break;
+            default:
+                TREAT_ERR( *err, 0, "Wrong bond type" );
+                goto exit_error;
+        }
+
+        k = AT_NUM_BONDS( atom[i] )++;
+        atom[i].bond_type[k] = bond_type;
+        atom[i].bond_stereo[k] = bond_stereo1;
+        atom[i].neighbor[k] = (ATOM_NUMBER) neigh;
+
+        k2 = AT_NUM_BONDS( atom[neigh] )++;
+        atom[neigh].bond_type[k2] = bond_type;
+        atom[neigh].bond_stereo[k2] = bond_stereo2;
+        atom[neigh].neighbor[k2] = (ATOM_NUMBER) i;
+
+        bond_parity |= ( bond_parityNM << SB_PARITY_SHFT );
+        if (bond_parity)
+        {
+            if (max_len_stereo0D <= len_stereo0D)
+            {
+                inchi_Stereo0D *new_atom_stereo0D = CreateInchi_Stereo0D( max_len_stereo0D + num_atoms );
+                if (!new_atom_stereo0D)
+                {
+                    goto exit_fatal;
+                }
+                memcpy( new_atom_stereo0D, atom_stereo0D, len_stereo0D * sizeof( *atom_stereo0D ) );
+                FreeInchi_Stereo0D( &atom_stereo0D );
+                atom_stereo0D = new_atom_stereo0D;
+                max_len_stereo0D += num_atoms;
+            }
+            /* i is allene middle point or an end of a stereo bond, neigh < i */
+            atom_stereo0D[len_stereo0D].neighbor[1] = neigh;
+            atom_stereo0D[len_stereo0D].neighbor[2] = i;
+            atom_stereo0D[len_stereo0D].parity = bond_parity;
+            atom_stereo0D[len_stereo0D].type = INCHI_StereoType_DoubleBond; /* incl allenes & cumulenes */
+            len_stereo0D++;
+        }
+    }
+
+    if (i != num_atoms || s && p != s)
+    {
+        TREAT_ERR( *err, 0, "Wrong number of bonds" );
+        goto exit_error;
+    }
+
+    /***************** coordinates: /rC: **********************/
+    if (!( p = AuxInfoFindToken( p, end, sRevXYZ, sizeof( sRevXYZ ) - 1 ) ))
+    {
+        TREAT_ERR( *err, 0, "Missing atom coordinates data" );
+        goto exit_error;
+    }
+    s = (const char *) memchr( p, '/', end - p );
+
+    for (i = 0; i < num_atoms && !( s && p >= s ); i++)
+    {
+        if (*p == ';')
+        {
+            p++; /* all 3 coordinates are zeroes */
+            continue;
+        }
+        for (k = 0; k < 3; k++)
+        {
+            bNonZeroXYZ = 0;
+            xyz = 0.0;
+            if (*p == ',')
+            {
+                p++; /* empty */
+            }
+            else if (*p != ';' && p < end)
+            {
+                xyz = AuxInfoStrtod( p, &q );
+                bNonZeroXYZ = fabs( xyz ) > MIN_BOND_LENGTH;
+                p = q + ( *q == ',' );
+            }
+            switch (k)
+            {
+                case 0:
+                    atom[i].x = xyz;
+                    b2D |= bNonZeroXYZ;
+                    break;
+                case 1:
+                    atom[i].y = xyz;
+                    b2D |= bNonZeroXYZ;
+                    break;
+                case 2:
+                    atom[i].z = xyz;
+                    b3D |= bNonZeroXYZ;
+                    break;
+            }
+        }
+        if (*p != ';')
+        {
+            TREAT_ERR( *err, 0, "Wrong atom coordinates data" );
+            goto exit_error;
+        }
+        p++; /* end of this triple of coordinates */
+    }
+
+    if (s && p != s || i != num_atoms)
+    {
+        TREAT_ERR( *err, 0, "Wrong number of coordinates" );
+        goto exit_error;
+    }
+
+    *at = atom;
+    num_atoms = SetInchiAtomValencesAndStereo0D( atom, num_atoms,
+                                                 &atom_stereo0D, len_stereo0D,
+                                                 b2D | b3D, bDoNotAddH,
+                                                 stereo0D, num_stereo0D,
+                                                 num_dimensions, num_bonds,
+                                                 err, pStrErr );
+    if (!num_atoms)
+    {
+        FreeInchi_Stereo0D( &atom_stereo0D ); /* not passed to *stereo0D */
+    }
+    if (pInpAtomFlags)
+    {
+        /* save chirality flag */
+        *pInpAtomFlags |= InpAtomFlags;
+    }
+
+    return num_atoms;
+
+exit_fatal:
+    TREAT_ERR( *err, 0, "Out of RAM" );
+    *err = INCHI_INP_FATAL_ERR;
+    num_atoms = INCHI_INP_FATAL_RET;
+    goto exit_function;
+
+exit_error:
+    *err = INCHI_INP_ERROR_ERR;
+    num_atoms = INCHI_INP_ERROR_RET;
+
+exit_function:
+    FreeInchi_Stereo0D( &atom_stereo0D );
+    if (atom)
+    {
+        inchi_free( atom );
+    }
+
+    return num_atoms;
+}
+
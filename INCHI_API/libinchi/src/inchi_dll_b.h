@@ -71,6 +71,18 @@ int InchiToInchiAtom( INCHI_IOSTREAM *inp_molfile,
                       INCHI_MODE *pInpAtomFlags,
                       int *err,
                       char *pStrErr );
+int AuxInfoToInchiAtom( const char *szText,
+                        int nLen,
+                        int *pnPos,
+                        inchi_Stereo0D **stereo0D,
+                        int *num_stereo0D,
+                        int bDoNotAddH,
+                        inchi_Atom **at,
+                        int *num_dimensions,
+                        int *num_bonds,
+                        INCHI_MODE *pInpAtomFlags,
+                        int *err,
+                        char *pStrErr );
 
 
 #endif /* __INCHI_DLL_B_H__ */
@@ -0,0 +1,514 @@
+/*
+ * International Chemical Identifier (InChI)
+ * Version 1
+ * Software version 1.06
+ * December 15, 2020
+ *
+ * The InChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * Originally developed at NIST.
+ * Modifications and additions by IUPAC and the InChI Trust.
+ * Some portions of code were developed/changed by external contributors
+ * (either contractor or volunteer) which are listed in the file
+ * 'External-contributors' included in this distribution.
+ *
+ * IUPAC/InChI-Trust Licence No.1.0 for the
+ * International Chemical Identifier (InChI)
+ * Copyright (C) IUPAC and InChI Trust
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0,
+ * or any later version.
+ *
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES
+ * whatsoever, whether expressed or implied.
+ * See the IUPAC/InChI-Trust InChI Licence No.1.0 for more details.
+ *
+ * You should have received a copy of the IUPAC/InChI Trust InChI
+ * Licence No. 1.0 with this library; if not, please e-mail:
+ *
+ * info@inchi-trust.org
+ *
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../../INCHI_BASE/src/mode.h"
+#include "../../../INCHI_BASE/src/incomdef.h"
+#include "../../../INCHI_BASE/src/inchi_api.h"
+
+#include "inchi_dll_mt.h"
+#include "inchi_dll_cache.h"
+
+
+typedef struct tagINCHI_CACHE_ENTRY
+{
+    unsigned char  *key;            /* NULL => empty slot */
+    size_t          key_len;
+    unsigned long   hash;
+    unsigned long   last_used;      /* LRU stamp within the bucket */
+    int             retcode;
+    char           *szInChI;        /* InChI '\0' AuxInfo '\0' as in inchi_Output */
+    size_t          inchi_size;     /* allocated size of szInChI */
+    long            aux_offset;     /* offset of AuxInfo in szInChI or -1 */
+    char           *szMessage;
+    char           *szLog;
+} INCHI_CACHE_ENTRY;
+
+
+static INCHI_MUTEX          cache_lock = INCHI_MUTEX_INITIALIZER;
+static INCHI_CACHE_ENTRY   *cache_entries = NULL;
+static volatile int         cache_num_buckets = 0;
+static unsigned long        cache_clock = 0;
+static unsigned long        cache_hits = 0;
+static unsigned long        cache_misses = 0;
+
+
+/****************************************************************************/
+static char *cache_strdup( const char *s )
+{
+    char *p;
+    if (!s)
+    {
+        return NULL;
+    }
+    p = (char *) inchi_malloc( strlen( s ) + 1 );
+    if (p)
+    {
+        strcpy( p, s );
+    }
+    return p;
+}
+
+
+/****************************************************************************/
+static void cache_free_entry( INCHI_CACHE_ENTRY *e )
+{
+    if (e->key)
+    {
+        inchi_free( e->key );
+    }
+    if (e->szInChI)
+    {
+        inchi_free( e->szInChI );
+    }
+    if (e->szMessage)
+    {
+        inchi_free( e->szMessage );
+    }
+    if (e->szLog)
+    {
+        inchi_free( e->szLog );
+    }
+    memset( e, 0, sizeof( *e ) );
+}
+
+
+/****************************************************************************
+ Append bytes to the key and update its FNV-1a hash
+****************************************************************************/
+static int cache_key_add( INCHI_CACHE_KEY *key, const void *data, size_t len )
+{
+    const unsigned char *p = (const unsigned char *) data;
+    size_t i;
+
+    if (key->len + len > key->allocated)
+    {
+        size_t new_size = 2 * ( key->len + len ) + 64;
+        unsigned char *new_bytes = (unsigned char *) inchi_malloc( new_size );
+        if (!new_bytes)
+        {
+            return 0;
+        }
+        if (key->bytes)
+        {
+            memcpy( new_bytes, key->bytes, key->len );
+            inchi_free( key->bytes );
+        }
+        key->bytes = new_bytes;
+        key->allocated = new_size;
+    }
+    for (i = 0; i < len; i++)
+    {
+        key->bytes[key->len++] = p[i];
+        key->hash = ( key->hash ^ p[i] ) * 16777619UL;
+        key->hash &= 0xFFFFFFFFUL;
+    }
+
+    return 1;
+}
+
+
+/****************************************************************************/
+static void cache_key_init( INCHI_CACHE_KEY *key, int kind )
+{
+    unsigned char k = (unsigned char) kind;
+
+    memset( key, 0, sizeof( *key ) );
+    key->hash = 2166136261UL;
+    cache_key_add( key, &k, 1 );
+}
+
+
+/****************************************************************************/
+static int cache_key_add_str( INCHI_CACHE_KEY *key, const char *s )
+{
+    return cache_key_add( key, s ? s : "", s ? strlen( s ) + 1 : 1 );
+}
+
+
+/****************************************************************************/
+static int cache_key_add_elname( INCHI_CACHE_KEY *key, const char *elname )
+{
+    unsigned char len = 0;
+    while (len < ATOM_EL_LEN && elname[len])
+    {
+        len++;
+    }
+    return cache_key_add( key, &len, 1 ) && cache_key_add( key, elname, len );
+}
+
+
+/****************************************************************************/
+int inchi_cache_is_on( void )
+{
+    return cache_num_buckets > 0;
+}
+
+
+/****************************************************************************
+ Serialize the structure field by field (struct padding and unused
+ adjacency list slots are not part of the key).
+ Returns 0 if the input is not cacheable.
+****************************************************************************/
+int inchi_cache_make_key_from_input( INCHI_CACHE_KEY *key,
+                                     inchi_InputEx *inp,
+                                     int enforce_std_format )
+{
+    int i, ok;
+
+    cache_key_init( key, enforce_std_format ? 'S' : 'I' );
+
+    /* polymer and V3000 extensions are not cached */
+    if (!inp || inp->polymer || inp->v3000 || inp->num_atoms <= 0 || !inp->atom)
+    {
+        inchi_cache_free_key( key );
+        return 0;
+    }
+
+    ok = cache_key_add_str( key, inp->szOptions );
+    ok = ok && cache_key_add( key, &inp->num_atoms, sizeof( inp->num_atoms ) );
+    for (i = 0; ok && i < inp->num_atoms; i++)
+    {
+        inchi_Atom *a = inp->atom + i;
+        int nb = inchi_max( 0, inchi_min( a->num_bonds, MAXVAL ) );
+        ok = cache_key_add( key, &a->x, sizeof( a->x ) ) &&
+             cache_key_add( key, &a->y, sizeof( a->y ) ) &&
+             cache_key_add( key, &a->z, sizeof( a->z ) ) &&
+             cache_key_add( key, &a->num_bonds, sizeof( a->num_bonds ) ) &&
+             cache_key_add( key, a->neighbor, nb * sizeof( a->neighbor[0] ) ) &&
+             cache_key_add( key, a->bond_type, nb * sizeof( a->bond_type[0] ) ) &&
+             cache_key_add( key, a->bond_stereo, nb * sizeof( a->bond_stereo[0] ) ) &&
+             cache_key_add_elname( key, a->elname ) &&
+             cache_key_add( key, a->num_iso_H, sizeof( a->num_iso_H ) ) &&
+             cache_key_add( key, &a->isotopic_mass, sizeof( a->isotopic_mass ) ) &&
+             cache_key_add( key, &a->radical, sizeof( a->radical ) ) &&
+             cache_key_add( key, &a->charge, sizeof( a->charge ) );
+    }
+    ok = ok && cache_key_add( key, &inp->num_stereo0D, sizeof( inp->num_stereo0D ) );
+    for (i = 0; ok && inp->stereo0D && i < inp->num_stereo0D; i++)
+    {
+        inchi_Stereo0D *s = inp->stereo0D + i;
+        ok = cache_key_add( key, s->neighbor, sizeof( s->neighbor ) ) &&
+             cache_key_add( key, &s->central_atom, sizeof( s->central_atom ) ) &&
+             cache_key_add( key, &s->type, sizeof( s->type ) ) &&
+             cache_key_add( key, &s->parity, sizeof( s->parity ) );
+    }
+    if (!ok)
+    {
+        inchi_cache_free_key( key );
+    }
+
+    return ok;
+}
+
+
+/****************************************************************************/
+int inchi_cache_make_key_from_molfile( INCHI_CACHE_KEY *key,
+                                       const char *moltext,
+                                       const char *options )
+{
+    cache_key_init( key, 'M' );
+    if (!moltext ||
+         !cache_key_add_str( key, options ) || !cache_key_add_str( key, moltext ))
+    {
+        inchi_cache_free_key( key );
+        return 0;
+    }
+
+    return 1;
+}
+
+
+/****************************************************************************/
+void inchi_cache_free_key( INCHI_CACHE_KEY *key )
+{
+    if (key->bytes)
+    {
+        inchi_free( key->bytes );
+    }
+    memset( key, 0, sizeof( *key ) );
+}
+
+
+/****************************************************************************
+ Returns 1 and fills out (to be freed with FreeINCHI) on hit
+****************************************************************************/
+int inchi_cache_lookup( INCHI_CACHE_KEY *key, inchi_Output *out, int *retcode )
+{
+    INCHI_CACHE_ENTRY *bucket, *e = NULL;
+    int i, found = 0;
+
+    inchi_mutex_lock( &cache_lock );
+
+    if (cache_num_buckets > 0 && key->len)
+    {
+        bucket = cache_entries + ( key->hash % cache_num_buckets ) * INCHI_CACHE_WAYS;
+        for (i = 0; i < INCHI_CACHE_WAYS; i++)
+        {
+            if (bucket[i].key && bucket[i].hash == key->hash &&
+                 bucket[i].key_len == key->len &&
+                 !memcmp( bucket[i].key, key->bytes, key->len ))
+            {
+                e = bucket + i;
+                break;
+            }
+        }
+        if (e)
+        {
+            memset( out, 0, sizeof( *out ) );
+            found = 1;
+            if (e->szInChI)
+            {
+                out->szInChI = (char *) inchi_malloc( e->inchi_size );
+                if (out->szInChI)
+                {
+                    memcpy( out->szInChI, e->szInChI, e->inchi_size );
+                    if (e->aux_offset >= 0)
+                    {
+                        out->szAuxInfo = out->szInChI + e->aux_offset;
+                    }
+                }
+                else
+                {
+                    found = 0;
+                }
+            }
+            out->szMessage = cache_strdup( e->szMessage );
+            out->szLog = cache_strdup( e->szLog );
+            if (( e->szMessage && !out->szMessage ) || ( e->szLog && !out->szLog ))
+            {
+                found = 0;
+            }
+            if (found)
+            {
+                e->last_used = ++cache_clock;
+                *retcode = e->retcode;
+                cache_hits++;
+            }
+            else
+            {
+                FreeINCHI( out );
+            }
+        }
+        if (!found)
+        {
+            cache_misses++;
+        }
+    }
+
+    inchi_mutex_unlock( &cache_lock );
+
+    return found;
+}
+
+
+/****************************************************************************
+ Keep a copy of a successful result; evicts the least recently used
+ entry of the bucket
+****************************************************************************/
+void inchi_cache_store( INCHI_CACHE_KEY *key, inchi_Output *out, int retcode )
+{
+    INCHI_CACHE_ENTRY *bucket, *e, tmp;
+    size_t len_inchi = 0, len_aux = 0;
+    int i;
+
+    if (!key->len || !out ||
+        ( retcode != inchi_Ret_OKAY && retcode != inchi_Ret_WARNING ))
+    {
+        return;
+    }
+
+    /* copy everything outside of the lock */
+    memset( &tmp, 0, sizeof( tmp ) );
+    tmp.aux_offset = -1;
+    tmp.hash = key->hash;
+    tmp.retcode = retcode;
+    tmp.key_len = key->len;
+    tmp.key = (unsigned char *) inchi_malloc( key->len );
+    if (!tmp.key)
+    {
+        return;
+    }
+    memcpy( tmp.key, key->bytes, key->len );
+    if (out->szInChI)
+    {
+        len_inchi = strlen( out->szInChI ) + 1;
+        if (out->szAuxInfo)
+        {
+            len_aux = strlen( out->szAuxInfo ) + 1;
+        }
+        tmp.inchi_size = len_inchi + len_aux;
+        tmp.szInChI = (char *) inchi_malloc( tmp.inchi_size );
+        if (!tmp.szInChI)
+        {
+            cache_free_entry( &tmp );
+            return;
+        }
+        memcpy( tmp.szInChI, out->szInChI, len_inchi );
+        if (out->szAuxInfo)
+        {
+            memcpy( tmp.szInChI + len_inchi, out->szAuxInfo, len_aux );
+            tmp.aux_offset = (long) len_inchi;
+        }
+    }
+    tmp.szMessage = cache_strdup( out->szMessage );
+    tmp.szLog = cache_strdup( out->szLog );
+    if (( out->szMessage && !tmp.szMessage ) || ( out->szLog && !tmp.szLog ))
+    {
+        cache_free_entry( &tmp );
+        return;
+    }
+
+    inchi_mutex_lock( &cache_lock );
+
+    if (cache_num_buckets > 0)
+    {
+        bucket = cache_entries + ( key->hash % cache_num_buckets ) * INCHI_CACHE_WAYS;
+        e = bucket;
+        for (i = 0; i < INCHI_CACHE_WAYS; i++)
+        {
+            if (bucket[i].key && bucket[i].hash == tmp.hash &&
+                 bucket[i].key_len == tmp.key_len &&
+                 !memcmp( bucket[i].key, tmp.key, tmp.key_len ))
+            {
+                e = NULL; /* stored concurrently by another thread */
+                break;
+            }
+        }
+        /* the key is not in the bucket: take the first empty slot, else the LRU one */
+        for (i = 0; e && i < INCHI_CACHE_WAYS; i++)
+        {
+            if (!bucket[i].key)
+            {
+                e = bucket + i;
+                break;
+            }
+            if (bucket[i].last_used < e->last_used)
+            {
+                e = bucket + i;
+            }
+        }
+        if (e)
+        {
+            cache_free_entry( e );
+            *e = tmp;
+            e->last_used = ++cache_clock;
+            memset( &tmp, 0, sizeof( tmp ) );
+        }
+    }
+
+    inchi_mutex_unlock( &cache_lock );
+
+    cache_free_entry( &tmp );
+}
+
+
+/****************************************************************************
+
+    SetINCHIResultCacheSize
+
+****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+int INCHI_DECL SetINCHIResultCacheSize( int max_entries )
+{
+    INCHI_CACHE_ENTRY *new_entries = NULL;
+    int i, num_buckets = 0;
+
+    if (max_entries > 0)
+    {
+        num_buckets = ( max_entries + INCHI_CACHE_WAYS - 1 ) / INCHI_CACHE_WAYS;
+        new_entries = (INCHI_CACHE_ENTRY *) inchi_calloc( (size_t) num_buckets * INCHI_CACHE_WAYS,
+                                                          sizeof( new_entries[0] ) );
+        if (!new_entries)
+        {
+            return -1;
+        }
+    }
+
+    inchi_mutex_lock( &cache_lock );
+
+    for (i = 0; i < cache_num_buckets * INCHI_CACHE_WAYS; i++)
+    {
+        cache_free_entry( cache_entries + i );
+    }
+    if (cache_entries)
+    {
+        inchi_free( cache_entries );
+    }
+    cache_entries = new_entries;
+    cache_num_buckets = num_buckets;
+    cache_clock = cache_hits = cache_misses = 0;
+
+    inchi_mutex_unlock( &cache_lock );
+
+    return num_buckets * INCHI_CACHE_WAYS;
+}
+
+
+/****************************************************************************
+
+    GetINCHIResultCacheStats
+
+****************************************************************************/
+EXPIMP_TEMPLATE INCHI_API
+void INCHI_DECL GetINCHIResultCacheStats( unsigned long *hits,
+                                          unsigned long *misses,
+                                          int *num_entries )
+{
+    int i, n = 0;
+
+    inchi_mutex_lock( &cache_lock );
+
+    for (i = 0; i < cache_num_buckets * INCHI_CACHE_WAYS; i++)
+    {
+        n += ( NULL != cache_entries[i].key );
+    }
+    if (hits)
+    {
+        *hits = cache_hits;
+    }
+    if (misses)
+    {
+        *misses = cache_misses;
+    }
+    if (num_entries)
+    {
+        *num_entries = n;
+    }
+
+    inchi_mutex_unlock( &cache_lock );
+}
@@ -0,0 +1,86 @@
+/*
+ * International Chemical Identifier (InChI)
+ * Version 1
+ * Software version 1.06
+ * December 15, 2020
+ *
+ * The InChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * Originally developed at NIST.
+ * Modifications and additions by IUPAC and the InChI Trust.
+ * Some portions of code were developed/changed by external contributors
+ * (either contractor or volunteer) which are listed in the file
+ * 'External-contributors' included in this distribution.
+ *
+ * IUPAC/InChI-Trust Licence No.1.0 for the
+ * International Chemical Identifier (InChI)
+ * Copyright (C) IUPAC and InChI Trust
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0,
+ * or any later version.
+ *
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES
+ * whatsoever, whether expressed or implied.
+ * See the IUPAC/InChI-Trust InChI Licence No.1.0 for more details.
+ *
+ * You should have received a copy of the IUPAC/InChI Trust InChI
+ * Licence No. 1.0 with this library; if not, please e-mail:
+ *
+ * info@inchi-trust.org
+ *
+ */
+
+
+
+#ifndef __INCHI_DLL_CACHE_H__
+#define __INCHI_DLL_CACHE_H__
+
+
+/*
+    Optional bounded result cache shared by all threads of the process.
+
+    Records which are seen again (solvents, counter-ions, reagents, ...)
+    are answered from a copy of the earlier output. The cache is keyed on
+    a compact serialization of the input structure plus the options string;
+    the full key is compared on lookup, so that hash collisions never
+    produce a wrong answer. Only successful (OKAY/WARNING) results are kept.
+*/
+
+#define INCHI_CACHE_WAYS  4         /* entries per hash bucket */
+
+
+typedef struct tagINCHI_CACHE_KEY
+{
+    unsigned char  *bytes;
+    size_t          len;
+    size_t          allocated;
+    unsigned long   hash;
+} INCHI_CACHE_KEY;
+
+
+#ifndef COMPILE_ALL_CPP
+#ifdef __cplusplus
+extern "C" {
+#endif
+#endif
+
+int  inchi_cache_is_on( void );
+int  inchi_cache_make_key_from_input( INCHI_CACHE_KEY *key,
+                                      inchi_InputEx *inp,
+                                      int enforce_std_format );
+int  inchi_cache_make_key_from_molfile( INCHI_CACHE_KEY *key,
+                                        const char *moltext,
+                                        const char *options );
+void inchi_cache_free_key( INCHI_CACHE_KEY *key );
+int  inchi_cache_lookup( INCHI_CACHE_KEY *key, inchi_Output *out, int *retcode );
+void inchi_cache_store( INCHI_CACHE_KEY *key, inchi_Output *out, int retcode );
+
+#ifndef COMPILE_ALL_CPP
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+
+#endif /* __INCHI_DLL_CACHE_H__ */
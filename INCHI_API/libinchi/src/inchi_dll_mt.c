@@ -0,0 +1,279 @@
+/*
+ * International Chemical Identifier (InChI)
+ * Version 1
+ * Software version 1.06
+ * December 15, 2020
+ *
+ * The InChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * Originally developed at NIST.
+ * Modifications and additions by IUPAC and the InChI Trust.
+ * Some portions of code were developed/changed by external contributors
+ * (either contractor or volunteer) which are listed in the file
+ * 'External-contributors' included in this distribution.
+ *
+ * IUPAC/InChI-Trust Licence No.1.0 for the
+ * International Chemical Identifier (InChI)
+ * Copyright (C) IUPAC and InChI Trust
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0,
+ * or any later version.
+ *
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES
+ * whatsoever, whether expressed or implied.
+ * See the IUPAC/InChI-Trust InChI Licence No.1.0 for more details.
+ *
+ * You should have received a copy of the IUPAC/InChI Trust InChI
+ * Licence No. 1.0 with this library; if not, please e-mail:
+ *
+ * info@inchi-trust.org
+ *
+ */
+
+
+
+#include <stdlib.h>
+#if !defined( _WIN32 )
+#include <unistd.h>
+#endif
+
+#include "inchi_dll_mt.h"
+
+
+/****************************************************************************/
+void inchi_mutex_lock( INCHI_MUTEX *m )
+{
+#if defined( _WIN32 )
+    AcquireSRWLockExclusive( m );
+#else
+    pthread_mutex_lock( m );
+#endif
+}
+
+
+/****************************************************************************/
+void inchi_mutex_unlock( INCHI_MUTEX *m )
+{
+#if defined( _WIN32 )
+    ReleaseSRWLockExclusive( m );
+#else
+    pthread_mutex_unlock( m );
+#endif
+}
+
+
+/****************************************************************************/
+void inchi_mutex_init( INCHI_MUTEX *m )
+{
+#if defined( _WIN32 )
+    InitializeSRWLock( m );
+#else
+    pthread_mutex_init( m, NULL );
+#endif
+}
+
+
+/****************************************************************************/
+void inchi_mutex_destroy( INCHI_MUTEX *m )
+{
+#if defined( _WIN32 )
+    ; /* SRW locks need no cleanup */
+#else
+    pthread_mutex_destroy( m );
+#endif
+}
+
+
+/****************************************************************************/
+void inchi_cond_init( INCHI_COND *c )
+{
+#if defined( _WIN32 )
+    InitializeConditionVariable( c );
+#else
+    pthread_cond_init( c, NULL );
+#endif
+}
+
+
+/****************************************************************************/
+void inchi_cond_destroy( INCHI_COND *c )
+{
+#if defined( _WIN32 )
+    ; /* condition variables need no cleanup */
+#else
+    pthread_cond_destroy( c );
+#endif
+}
+
+
+/****************************************************************************
+  Atomically release m and wait for c; m is held again on return.
+  Spurious wakeups are possible, so callers re-check their condition.
+****************************************************************************/
+void inchi_cond_wait( INCHI_COND *c, INCHI_MUTEX *m )
+{
+#if defined( _WIN32 )
+    SleepConditionVariableSRW( c, m, INFINITE, 0 );
+#else
+    pthread_cond_wait( c, m );
+#endif
+}
+
+
+/****************************************************************************/
+void inchi_cond_signal( INCHI_COND *c )
+{
+#if defined( _WIN32 )
+    WakeConditionVariable( c );
+#else
+    pthread_cond_signal( c );
+#endif
+}
+
+
+/****************************************************************************/
+void inchi_cond_broadcast( INCHI_COND *c )
+{
+#if defined( _WIN32 )
+    WakeAllConditionVariable( c );
+#else
+    pthread_cond_broadcast( c );
+#endif
+}
+
+
+/****************************************************************************
+  Number of online processors; 1 if unknown
+****************************************************************************/
+int inchi_get_num_cpus( void )
+{
+    int n;
+#if defined( _WIN32 )
+    SYSTEM_INFO si;
+    GetSystemInfo( &si );
+    n = (int) si.dwNumberOfProcessors;
+#elif defined( _SC_NPROCESSORS_ONLN )
+    n = (int) sysconf( _SC_NPROCESSORS_ONLN );
+#else
+    n = 1;
+#endif
+
+    return n > 0 ? n : 1;
+}
+
+
+/*
+    Stack size of worker threads, 0 = platform default. Stereo mapping
+    recursion takes stack in proportion to the number of stereocenters,
+    which may be very large with INCHI_WIDE_AT_NUMB.
+*/
+#ifdef INCHI_WIDE_AT_NUMB
+#define INCHI_THREAD_STACK_SIZE ( (size_t) 256 * 1024 * 1024 )
+#else
+#define INCHI_THREAD_STACK_SIZE 0
+#endif
+
+
+typedef struct tagInchiThreadStart
+{
+    INCHI_THREAD_FUNC func;
+    void *arg;
+} INCHI_THREAD_START;
+
+
+#if defined( _WIN32 )
+/****************************************************************************/
+static DWORD WINAPI inchi_thread_entry( LPVOID p )
+{
+    INCHI_THREAD_START *ts = (INCHI_THREAD_START *) p;
+    ts->func( ts->arg );
+    return 0;
+}
+#else
+/****************************************************************************/
+static void *inchi_thread_entry( void *p )
+{
+    INCHI_THREAD_START *ts = (INCHI_THREAD_START *) p;
+    ts->func( ts->arg );
+    return NULL;
+}
+#endif
+
+
+/****************************************************************************
+  Call func( arg ) concurrently in num_threads threads, the calling thread
+  being one of them, and wait until all of them return.
+  func is expected to pull its work items from arg under a lock.
+  Returns the number of threads actually used (at least 1).
+****************************************************************************/
+int inchi_run_threads( int num_threads, INCHI_THREAD_FUNC func, void *arg )
+{
+    int i, num_started = 0;
+    INCHI_THREAD_START ts;
+#if defined( _WIN32 )
+    HANDLE *threads = NULL;
+#else
+    pthread_t *threads = NULL;
+    pthread_attr_t attr, *pattr = NULL;
+#endif
+
+    ts.func = func;
+    ts.arg = arg;
+
+    if (num_threads > 1)
+    {
+        threads = calloc( num_threads - 1, sizeof( threads[0] ) );
+    }
+#if !defined( _WIN32 )
+    if (threads && INCHI_THREAD_STACK_SIZE && !pthread_attr_init( &attr ))
+    {
+        pattr = &attr;
+        pthread_attr_setstacksize( pattr, INCHI_THREAD_STACK_SIZE );
+    }
+#endif
+    if (threads)
+    {
+        for (i = 0; i < num_threads - 1; i++)
+        {
+#if defined( _WIN32 )
+            threads[num_started] = CreateThread( NULL, INCHI_THREAD_STACK_SIZE, inchi_thread_entry, &ts,
+                                                 STACK_SIZE_PARAM_IS_A_RESERVATION, NULL );
+            if (!threads[num_started])
+            {
+                break;
+            }
+#else
+            if (pthread_create( threads + num_started, pattr, inchi_thread_entry, &ts ))
+            {
+                break;
+            }
+#endif
+            num_started++;
+        }
+    }
+#if !defined( _WIN32 )
+    if (pattr)
+    {
+        pthread_attr_destroy( pattr );
+    }
+#endif
+
+    func( arg );
+
+    for (i = 0; i < num_started; i++)
+    {
+#if defined( _WIN32 )
+        WaitForSingleObject( threads[i], INFINITE );
+        CloseHandle( threads[i] );
+#else
+        pthread_join( threads[i], NULL );
+#endif
+    }
+    if (threads)
+    {
+        free( threads );
+    }
+
+    return num_started + 1;
+}
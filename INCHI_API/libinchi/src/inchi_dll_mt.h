@@ -0,0 +1,85 @@
+/*
+ * International Chemical Identifier (InChI)
+ * Version 1
+ * Software version 1.06
+ * December 15, 2020
+ *
+ * The InChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * Originally developed at NIST.
+ * Modifications and additions by IUPAC and the InChI Trust.
+ * Some portions of code were developed/changed by external contributors
+ * (either contractor or volunteer) which are listed in the file
+ * 'External-contributors' included in this distribution.
+ *
+ * IUPAC/InChI-Trust Licence No.1.0 for the
+ * International Chemical Identifier (InChI)
+ * Copyright (C) IUPAC and InChI Trust
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0,
+ * or any later version.
+ *
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES
+ * whatsoever, whether expressed or implied.
+ * See the IUPAC/InChI-Trust InChI Licence No.1.0 for more details.
+ *
+ * You should have received a copy of the IUPAC/InChI Trust InChI
+ * Licence No. 1.0 with this library; if not, please e-mail:
+ *
+ * info@inchi-trust.org
+ *
+ */
+
+
+
+#ifndef __INCHI_DLL_MT_H__
+#define __INCHI_DLL_MT_H__
+
+/*
+    Minimal portable locking and threading primitives for the
+    library-wide shared state (result cache etc.) and for batch calls.
+    POSIX threads or Win32 slim locks/threads.
+*/
+
+#if defined( _WIN32 )
+#include <windows.h>
+typedef SRWLOCK            INCHI_MUTEX;
+typedef CONDITION_VARIABLE INCHI_COND;
+#define INCHI_MUTEX_INITIALIZER SRWLOCK_INIT
+#else
+#include <pthread.h>
+typedef pthread_mutex_t    INCHI_MUTEX;
+typedef pthread_cond_t     INCHI_COND;
+#define INCHI_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#endif
+
+typedef void (*INCHI_THREAD_FUNC)( void *arg );
+
+
+#ifndef COMPILE_ALL_CPP
+#ifdef __cplusplus
+extern "C" {
+#endif
+#endif
+
+void inchi_mutex_lock( INCHI_MUTEX *m );
+void inchi_mutex_unlock( INCHI_MUTEX *m );
+void inchi_mutex_init( INCHI_MUTEX *m );
+void inchi_mutex_destroy( INCHI_MUTEX *m );
+void inchi_cond_init( INCHI_COND *c );
+void inchi_cond_destroy( INCHI_COND *c );
+void inchi_cond_wait( INCHI_COND *c, INCHI_MUTEX *m );
+void inchi_cond_signal( INCHI_COND *c );
+void inchi_cond_broadcast( INCHI_COND *c );
+int inchi_get_num_cpus( void );
+int inchi_run_threads( int num_threads, INCHI_THREAD_FUNC func, void *arg );
+
+#ifndef COMPILE_ALL_CPP
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+
+#endif /* __INCHI_DLL_MT_H__ */
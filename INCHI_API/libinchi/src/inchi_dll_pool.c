@@ -0,0 +1,417 @@
+/*
+ * International Chemical Identifier (InChI)
+ * Version 1
+ * Software version 1.06
+ * December 15, 2020
+ *
+ * The InChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * Originally developed at NIST.
+ * Modifications and additions by IUPAC and the InChI Trust.
+ * Some portions of code were developed/changed by external contributors
+ * (either contractor or volunteer) which are listed in the file
+ * 'External-contributors' included in this distribution.
+ *
+ * IUPAC/InChI-Trust Licence No.1.0 for the
+ * International Chemical Identifier (InChI)
+ * Copyright (C) IUPAC and InChI Trust
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0,
+ * or any later version.
+ *
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES
+ * whatsoever, whether expressed or implied.
+ * See the IUPAC/InChI-Trust InChI Licence No.1.0 for more details.
+ *
+ * You should have received a copy of the IUPAC/InChI Trust InChI
+ * Licence No. 1.0 with this library; if not, please e-mail:
+ *
+ * info@inchi-trust.org
+ *
+ */
+
+
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../../INCHI_BASE/src/mode.h"
+#include "../../../INCHI_BASE/src/incomdef.h"
+#include "../../../INCHI_BASE/src/inchi_api.h"
+
+#include "inchi_dll_mt.h"
+
+
+/*
+    Pool of InChI generators passed between stage queues.
+    A job "sits" at the stage it was last submitted with (nPos) from
+    Acquire or Submit until the next Submit or Release; this is what
+    INCHIGEN_POOL_Next uses to tell whether more jobs may still arrive
+    at a stage after the pool has been closed.
+*/
+
+
+typedef struct tagINCHIGEN_POOL_JOB
+{
+    INCHIGEN_JOB                    job;        /* must be first */
+    struct tagINCHIGEN_POOL        *pool;
+    struct tagINCHIGEN_POOL_JOB    *next;       /* in free list or stage queue */
+    int                             nPos;       /* stage last submitted with */
+    int                             bAcquired;
+    int                             bQueued;
+} INCHIGEN_POOL_JOB;
+
+
+typedef struct tagINCHIGEN_POOL
+{
+    INCHI_MUTEX         lock;
+    INCHI_COND          cond_free;                      /* a job was released */
+    INCHI_COND          cond_stage[INCHIGEN_NUM_STAGES];/* a job was queued */
+    INCHIGEN_POOL_JOB  *jobs;
+    int                 num_jobs;
+    INCHIGEN_POOL_JOB  *free_list;
+    INCHIGEN_POOL_JOB  *head[INCHIGEN_NUM_STAGES];
+    INCHIGEN_POOL_JOB  *tail[INCHIGEN_NUM_STAGES];
+    int                 num_at_pos[INCHIGEN_NUM_STAGES];/* acquired jobs by nPos */
+    int                 bClosed;
+} INCHIGEN_POOL;
+
+
+/****************************************************************************/
+static void pool_wake_all_stages( INCHIGEN_POOL *pool )
+{
+    int i;
+    for (i = 0; i < INCHIGEN_NUM_STAGES; i++)
+    {
+        inchi_cond_broadcast( pool->cond_stage + i );
+    }
+}
+
+
+/****************************************************************************
+  Number of acquired jobs which may still be submitted at nStage
+****************************************************************************/
+static int pool_num_upstream( INCHIGEN_POOL *pool, int nStage )
+{
+    int i, n = 0;
+    for (i = 0; i < nStage; i++)
+    {
+        n += pool->num_at_pos[i];
+    }
+    return n;
+}
+
+
+/****************************************************************************/
+static void pool_reset_job( INCHIGEN_POOL_JOB *pj )
+{
+    INCHIGEN_Reset( pj->job.HGen, &pj->job.GenData, &pj->job.Output );
+    pj->job.pInp = NULL;
+    pj->job.nStage = INCHIGEN_STAGE_NONE;
+    pj->job.nRetCode = inchi_Ret_OKAY;
+    pj->job.pUserData = NULL;
+}
+
+
+/****************************************************************************/
+INCHIGEN_POOL_HANDLE INCHI_DECL INCHIGEN_POOL_Create( int num_jobs )
+{
+    int i;
+    INCHIGEN_POOL *pool;
+
+    if (num_jobs <= 0)
+    {
+        num_jobs = 2 * inchi_get_num_cpus( );
+    }
+
+    pool = (INCHIGEN_POOL *) inchi_calloc( 1, sizeof( INCHIGEN_POOL ) );
+    if (!pool)
+    {
+        return (INCHIGEN_POOL_HANDLE) NULL;
+    }
+    pool->jobs = (INCHIGEN_POOL_JOB *) inchi_calloc( num_jobs, sizeof( INCHIGEN_POOL_JOB ) );
+    if (!pool->jobs)
+    {
+        inchi_free( pool );
+        return (INCHIGEN_POOL_HANDLE) NULL;
+    }
+
+    for (i = 0; i < num_jobs; i++)
+    {
+        pool->jobs[i].job.HGen = INCHIGEN_Create( );
+        if (!pool->jobs[i].job.HGen)
+        {
+            while (i--)
+            {
+                INCHIGEN_Destroy( pool->jobs[i].job.HGen );
+            }
+            inchi_free( pool->jobs );
+            inchi_free( pool );
+            return (INCHIGEN_POOL_HANDLE) NULL;
+        }
+        pool->jobs[i].pool = pool;
+        pool->jobs[i].next = pool->free_list;
+        pool->free_list = pool->jobs + i;
+    }
+    pool->num_jobs = num_jobs;
+
+    inchi_mutex_init( &pool->lock );
+    inchi_cond_init( &pool->cond_free );
+    for (i = 0; i < INCHIGEN_NUM_STAGES; i++)
+    {
+        inchi_cond_init( pool->cond_stage + i );
+    }
+
+    return (INCHIGEN_POOL_HANDLE) pool;
+}
+
+
+/****************************************************************************/
+INCHIGEN_JOB * INCHI_DECL INCHIGEN_POOL_Acquire( INCHIGEN_POOL_HANDLE _pool,
+                                                 int bWait )
+{
+    INCHIGEN_POOL *pool = (INCHIGEN_POOL *) _pool;
+    INCHIGEN_POOL_JOB *pj = NULL;
+
+    if (!pool)
+    {
+        return NULL;
+    }
+
+    inchi_mutex_lock( &pool->lock );
+    while (!pool->bClosed)
+    {
+        if (pool->free_list)
+        {
+            pj = pool->free_list;
+            pool->free_list = pj->next;
+            pj->next = NULL;
+            pj->bAcquired = 1;
+            pj->nPos = INCHIGEN_STAGE_NONE;
+            pool->num_at_pos[INCHIGEN_STAGE_NONE]++;
+            break;
+        }
+        if (!bWait)
+        {
+            break;
+        }
+        inchi_cond_wait( &pool->cond_free, &pool->lock );
+    }
+    inchi_mutex_unlock( &pool->lock );
+
+    return pj ? &pj->job : NULL;
+}
+
+
+/****************************************************************************/
+int INCHI_DECL INCHIGEN_POOL_Submit( INCHIGEN_POOL_HANDLE _pool,
+                                     INCHIGEN_JOB *job )
+{
+    INCHIGEN_POOL *pool = (INCHIGEN_POOL *) _pool;
+    INCHIGEN_POOL_JOB *pj = (INCHIGEN_POOL_JOB *) job;
+    int nStage, ret = -1;
+
+    if (!pool || !pj || pj->pool != pool)
+    {
+        return -1;
+    }
+    nStage = job->nStage;
+    if (nStage < INCHIGEN_STAGE_NONE || nStage > INCHIGEN_STAGE_DONE)
+    {
+        return -1;
+    }
+
+    inchi_mutex_lock( &pool->lock );
+    if (pj->bAcquired && !pj->bQueued)
+    {
+        pool->num_at_pos[pj->nPos]--;
+        pool->num_at_pos[nStage]++;
+        pj->nPos = nStage;
+        pj->bQueued = 1;
+        pj->next = NULL;
+        if (pool->tail[nStage])
+        {
+            pool->tail[nStage]->next = pj;
+        }
+        else
+        {
+            pool->head[nStage] = pj;
+        }
+        pool->tail[nStage] = pj;
+        inchi_cond_signal( pool->cond_stage + nStage );
+        if (pool->bClosed)
+        {
+            /* a failed job skipping stages may have been their last hope */
+            pool_wake_all_stages( pool );
+        }
+        ret = 0;
+    }
+    inchi_mutex_unlock( &pool->lock );
+
+    return ret;
+}
+
+
+/****************************************************************************/
+INCHIGEN_JOB * INCHI_DECL INCHIGEN_POOL_Next( INCHIGEN_POOL_HANDLE _pool,
+                                              int nStage,
+                                              int bWait )
+{
+    INCHIGEN_POOL *pool = (INCHIGEN_POOL *) _pool;
+    INCHIGEN_POOL_JOB *pj = NULL;
+
+    if (!pool || nStage < INCHIGEN_STAGE_NONE || nStage > INCHIGEN_STAGE_DONE)
+    {
+        return NULL;
+    }
+
+    inchi_mutex_lock( &pool->lock );
+    for (;;)
+    {
+        if (pool->head[nStage])
+        {
+            pj = pool->head[nStage];
+            pool->head[nStage] = pj->next;
+            if (!pool->head[nStage])
+            {
+                pool->tail[nStage] = NULL;
+            }
+            pj->next = NULL;
+            pj->bQueued = 0;
+            break;
+        }
+        if (!bWait || ( pool->bClosed && !pool_num_upstream( pool, nStage ) ))
+        {
+            break;
+        }
+        inchi_cond_wait( pool->cond_stage + nStage, &pool->lock );
+    }
+    inchi_mutex_unlock( &pool->lock );
+
+    return pj ? &pj->job : NULL;
+}
+
+
+/****************************************************************************/
+int INCHI_DECL INCHIGEN_POOL_DoNextStage( INCHIGEN_JOB *job )
+{
+    int ret;
+
+    if (!job)
+    {
+        return inchi_Ret_ERROR;
+    }
+
+    switch (job->nStage)
+    {
+        case INCHIGEN_STAGE_NONE:
+            ret = job->pInp ? INCHIGEN_Setup( job->HGen, &job->GenData, job->pInp )
+                            : inchi_Ret_EOF;
+            break;
+        case INCHIGEN_STAGE_SETUP:
+            ret = INCHIGEN_DoNormalization( job->HGen, &job->GenData );
+            break;
+        case INCHIGEN_STAGE_NORM:
+            ret = INCHIGEN_DoCanonicalization( job->HGen, &job->GenData );
+            break;
+        case INCHIGEN_STAGE_CANON:
+            ret = INCHIGEN_DoSerialization( job->HGen, &job->GenData, &job->Output );
+            break;
+        default:
+            return job->nRetCode;
+    }
+
+    if (ret == inchi_Ret_OKAY || ret == inchi_Ret_WARNING)
+    {
+        /* keep warnings issued by the earlier stages */
+        if (job->nStage != INCHIGEN_STAGE_NONE && job->nRetCode == inchi_Ret_WARNING)
+        {
+            ret = inchi_Ret_WARNING;
+        }
+        job->nStage++;
+    }
+    else
+    {
+        job->nStage = INCHIGEN_STAGE_DONE;
+    }
+    job->nRetCode = ret;
+
+    return ret;
+}
+
+
+/****************************************************************************/
+void INCHI_DECL INCHIGEN_POOL_Release( INCHIGEN_POOL_HANDLE _pool,
+                                       INCHIGEN_JOB *job )
+{
+    INCHIGEN_POOL *pool = (INCHIGEN_POOL *) _pool;
+    INCHIGEN_POOL_JOB *pj = (INCHIGEN_POOL_JOB *) job;
+
+    if (!pool || !pj || pj->pool != pool || !pj->bAcquired || pj->bQueued)
+    {
+        return;
+    }
+
+    /* free the structure data outside the lock */
+    pool_reset_job( pj );
+
+    inchi_mutex_lock( &pool->lock );
+    pool->num_at_pos[pj->nPos]--;
+    pj->bAcquired = 0;
+    pj->next = pool->free_list;
+    pool->free_list = pj;
+    inchi_cond_signal( &pool->cond_free );
+    if (pool->bClosed)
+    {
+        pool_wake_all_stages( pool );
+    }
+    inchi_mutex_unlock( &pool->lock );
+}
+
+
+/****************************************************************************/
+void INCHI_DECL INCHIGEN_POOL_Close( INCHIGEN_POOL_HANDLE _pool )
+{
+    INCHIGEN_POOL *pool = (INCHIGEN_POOL *) _pool;
+
+    if (!pool)
+    {
+        return;
+    }
+
+    inchi_mutex_lock( &pool->lock );
+    pool->bClosed = 1;
+    inchi_cond_broadcast( &pool->cond_free );
+    pool_wake_all_stages( pool );
+    inchi_mutex_unlock( &pool->lock );
+}
+
+
+/****************************************************************************/
+void INCHI_DECL INCHIGEN_POOL_Destroy( INCHIGEN_POOL_HANDLE _pool )
+{
+    INCHIGEN_POOL *pool = (INCHIGEN_POOL *) _pool;
+    int i;
+
+    if (!pool)
+    {
+        return;
+    }
+
+    for (i = 0; i < pool->num_jobs; i++)
+    {
+        pool_reset_job( pool->jobs + i );
+        INCHIGEN_Destroy( pool->jobs[i].job.HGen );
+    }
+    inchi_free( pool->jobs );
+
+    inchi_cond_destroy( &pool->cond_free );
+    for (i = 0; i < INCHIGEN_NUM_STAGES; i++)
+    {
+        inchi_cond_destroy( pool->cond_stage + i );
+    }
+    inchi_mutex_destroy( &pool->lock );
+    inchi_free( pool );
+}
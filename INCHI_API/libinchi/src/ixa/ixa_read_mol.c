@@ -121,6 +121,7 @@ void INCHI_DECL IXA_MOL_ReadMolfile(IXA_STATUS_HANDLE hStatus,
                             NULL,   /* *Id */
                             NULL,   /* pSdfLabel */
                             NULL,   /* pSdfValue */
+                            NULL,   /* sdf_fields */
                             &err, error_string,
                             0 /*bNoWarnings */ );
 
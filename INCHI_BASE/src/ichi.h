@@ -285,6 +285,13 @@ typedef struct tagINChI_Aux { /* [N] = allocated length */
     INCHI_MODE  bTautFlagsDone;         /* t_group_info->bTautFlagsDone */
     INCHI_MODE  bNormalizationFlags;    /* t_group_info->tni.bNormalizationFlags */
     int         nCanonFlags;
+    double      dGroupSize;             /* |Aut(G)| found by canonicalization */
+    long        lNumGenerators;         /* number of found Aut(G) generators */
+    long        lNumCanonTotCT;         /* number of terminal nodes compared in canon. search */
+    long        lNumStereoMapSteps;     /* number of steps in stereo mapping search */
+    long        lNormTime;              /* msec in normalization of the component */
+    long        lCanonTime;             /* msec in base canonical ranking */
+    long        lStereoTime;            /* msec in stereo and isotopic canonicalization (Canon_INChI) */
 } INChI_Aux;
 
 typedef INChI_Aux *PINChI_Aux2[TAUT_NUM];
@@ -67,6 +67,9 @@ t-group, not the atom */
 #define IS_FORBIDDEN(EDGE_FORBIDDEN, PBNS)     (EDGE_FORBIDDEN & PBNS->edge_forbidden_mask)
 #endif
 
+/* check the time limit once per (BNS_TIME_CHECK_MASK+1) RunBalancedNetworkSearch() calls */
+#define BNS_TIME_CHECK_MASK 0xF
+
 
 typedef enum tagAtTypeTotals
 {
@@ -698,7 +701,8 @@ int RunBalancedNetworkSearch( BN_STRUCT *pBNS, BN_DATA *pBD, int bChangeFlow )
         return delta;
     }
 
-    if (bInchiTimeIsOver( pBNS->ic, pBNS->ulTimeOutTime ))
+    if (!( ++pBNS->nNumRunBNS & BNS_TIME_CHECK_MASK ) &&
+         bInchiTimeIsOver( pBNS->ic, pBNS->ulTimeOutTime ))
     {
         return BNS_TIMEOUT;
     }
@@ -269,6 +269,7 @@ typedef struct BalancedNetworkStructure {
     /* v. 1.05 */
     struct tagINCHI_CLOCK *ic;
     struct tagInchiTime *ulTimeOutTime;
+    int            nNumRunBNS;  /* v. 1.06+ calls of RunBalancedNetworkSearch(), for timeout checks */
 } BN_STRUCT;
 
 /********************* BN_DATA *******************************************/
@@ -355,6 +356,8 @@ typedef struct tagNodeSet {
     bitWord **bitword;
     int num_set; /* number of sets */
     int len_set; /* number of bitWords in each set */
+    int num_alloc; /* number of sets having storage, see NodeSetReserve() */
+    int num_first; /* number of sets in the first storage block */
 } NodeSet;
 
 
@@ -396,6 +399,8 @@ extern "C" {
     struct tagCANON_GLOBALS;
 
     int  NodeSetCreate( struct tagCANON_GLOBALS *pCG, NodeSet *pSet, int n, int L );
+    int  NodeSetCreateLazy( struct tagCANON_GLOBALS *pCG, NodeSet *pSet, int n, int L, int L0 );
+    int  NodeSetReserve( NodeSet *pSet, int k );
     void NodeSetFree( struct tagCANON_GLOBALS *pCG, NodeSet *pSet );
 
     int  IsNodeSetEmpty( NodeSet *cur_nodes, int k );
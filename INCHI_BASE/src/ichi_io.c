@@ -32,11 +32,16 @@
  */
 
 
+#if ( defined( INCHI_USE_ZLIB ) && defined( __linux__ ) && !defined( _GNU_SOURCE ) )
+#define _GNU_SOURCE     /* fopencookie() */
+#endif
+
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
 #include <stdarg.h>
 #include <time.h>
+#include <limits.h>
 
 #include "mode.h"
 #include "ichi_io.h"
@@ -56,6 +61,16 @@ extern void( *FWPUSH ) ( const char *s );
 
 #endif
 
+#ifdef INCHI_USE_ZLIB
+#include <zlib.h>
+#if defined( __GLIBC__ )
+#define INCHI_ZSTREAM_COOKIE 1
+#include <pthread.h>
+#else
+#define INCHI_ZSTREAM_COOKIE 0
+#endif
+#endif
+
 
 /* Internal functions */
 
@@ -783,6 +798,392 @@ int inchi_ios_eprint( INCHI_IOSTREAM * ios, const char* lpszFormat, ... )
 /*    PLAIN FILE OPERATIONS */
 
 
+/*
+    Compressed files
+
+    inchi_fopen() opens gzip-compressed input (recognized by its magic
+    bytes, whatever the file name) and output files named *.gz through
+    zlib and returns an ordinary FILE*, so that the readers and writers,
+    including ftell()/fseek() used for problem file copies, work on it
+    unchanged. With glibc the FILE* is an fopencookie() stream, which may
+    be fed by a separate decompression thread (INCHI_FOPEN_READ_THREAD);
+    elsewhere compressed input is inflated into a tmpfile() and compressed
+    output is not available. Requires INCHI_USE_ZLIB (and -lz).
+*/
+#ifdef INCHI_USE_ZLIB
+
+#if ( INCHI_ZSTREAM_COOKIE == 1 )
+
+#define INCHI_ZBUF_EMPTY  (-2)
+
+typedef struct tagInchiZStream
+{
+    gzFile          gz;
+    int             bWrite;
+    off64_t         pos;        /* uncompressed offset of the next byte passed to/from stdio */
+    /* read-ahead thread */
+    int             bSync;      /* lock and cond have been initialized */
+    int             bThread;    /* the thread is running */
+    pthread_t       thread;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    char           *buf[2];
+    int             len[2];     /* INCHI_ZBUF_EMPTY or gzread() result: bytes, 0=>EOF, -1=>error */
+    int             nFill;      /* buffer the thread fills next */
+    int             nRead;      /* buffer being consumed */
+    int             nOffs;      /* bytes of buf[nRead] already consumed */
+    int             bStop;
+} INCHI_ZSTREAM;
+
+
+/****************************************************************************
+ Read-ahead thread: inflate into the two buffers in turn
+****************************************************************************/
+static void *inchi_zstream_thread( void *arg )
+{
+    INCHI_ZSTREAM *z = (INCHI_ZSTREAM *) arg;
+    int i = z->nFill, n;
+
+    for (;;)
+    {
+        pthread_mutex_lock( &z->lock );
+        while (z->len[i] != INCHI_ZBUF_EMPTY && !z->bStop)
+        {
+            pthread_cond_wait( &z->cond, &z->lock );
+        }
+        if (z->bStop)
+        {
+            pthread_mutex_unlock( &z->lock );
+            break;
+        }
+        pthread_mutex_unlock( &z->lock );
+
+        n = gzread( z->gz, z->buf[i], INCHI_FILE_BUFSIZE );
+
+        pthread_mutex_lock( &z->lock );
+        z->len[i] = ( n < 0 ) ? -1 : n;
+        pthread_cond_broadcast( &z->cond );
+        pthread_mutex_unlock( &z->lock );
+        if (n <= 0)
+        {
+            break;
+        }
+        i = 1 - i;
+    }
+
+    return NULL;
+}
+
+
+/****************************************************************************/
+static void inchi_zstream_start( INCHI_ZSTREAM *z )
+{
+    z->len[0] = z->len[1] = INCHI_ZBUF_EMPTY;
+    z->nFill = z->nRead = z->nOffs = 0;
+    z->bStop = 0;
+    z->bThread = !pthread_create( &z->thread, NULL, inchi_zstream_thread, z );
+}
+
+
+/****************************************************************************/
+static void inchi_zstream_stop( INCHI_ZSTREAM *z )
+{
+    if (z->bThread)
+    {
+        pthread_mutex_lock( &z->lock );
+        z->bStop = 1;
+        pthread_cond_broadcast( &z->cond );
+        pthread_mutex_unlock( &z->lock );
+        pthread_join( z->thread, NULL );
+        z->bThread = 0;
+    }
+}
+
+
+/****************************************************************************/
+static ssize_t inchi_zstream_read( void *cookie, char *buf, size_t size )
+{
+    INCHI_ZSTREAM *z = (INCHI_ZSTREAM *) cookie;
+    int n;
+
+    if (size > INCHI_FILE_BUFSIZE)
+    {
+        size = INCHI_FILE_BUFSIZE;
+    }
+    if (!z->bThread)
+    {
+        n = gzread( z->gz, buf, (unsigned) size );
+        if (n > 0)
+        {
+            z->pos += n;
+        }
+        return n;
+    }
+
+    pthread_mutex_lock( &z->lock );
+    while (z->len[z->nRead] == INCHI_ZBUF_EMPTY)
+    {
+        pthread_cond_wait( &z->cond, &z->lock );
+    }
+    n = z->len[z->nRead];
+    pthread_mutex_unlock( &z->lock );
+    if (n <= 0)
+    {
+        return n; /* EOF or error; stays so */
+    }
+
+    /* the thread does not touch a full buffer */
+    if ((size_t) ( n - z->nOffs ) < size)
+    {
+        size = (size_t) ( n - z->nOffs );
+    }
+    memcpy( buf, z->buf[z->nRead] + z->nOffs, size );
+    z->nOffs += (int) size;
+    z->pos += (off64_t) size;
+    if (z->nOffs == n)
+    {
+        pthread_mutex_lock( &z->lock );
+        z->len[z->nRead] = INCHI_ZBUF_EMPTY;
+        pthread_cond_broadcast( &z->cond );
+        pthread_mutex_unlock( &z->lock );
+        z->nRead = 1 - z->nRead;
+        z->nOffs = 0;
+    }
+
+    return (ssize_t) size;
+}
+
+
+/****************************************************************************/
+static ssize_t inchi_zstream_write( void *cookie, const char *buf, size_t size )
+{
+    INCHI_ZSTREAM *z = (INCHI_ZSTREAM *) cookie;
+    int n;
+
+    if (size > INCHI_FILE_BUFSIZE)
+    {
+        size = INCHI_FILE_BUFSIZE;
+    }
+    n = gzwrite( z->gz, buf, (unsigned) size );
+    if (n > 0)
+    {
+        z->pos += n;
+    }
+
+    return n; /* 0 => error */
+}
+
+
+/****************************************************************************
+ Seek in uncompressed data; backward seek re-reads the input from its start
+****************************************************************************/
+static int inchi_zstream_seek( void *cookie, off64_t *offset, int whence )
+{
+    INCHI_ZSTREAM *z = (INCHI_ZSTREAM *) cookie;
+    off64_t target;
+    z_off_t ret;
+    int bThread = z->bThread;
+
+    switch (whence)
+    {
+        case SEEK_SET:
+            target = *offset;
+            break;
+        case SEEK_CUR:
+            target = z->pos + *offset;
+            break;
+        default:
+            return -1;
+    }
+    if (target == z->pos)
+    {
+        *offset = target; /* ftell() */
+        return 0;
+    }
+    if (target < 0 || z->bWrite)
+    {
+        return -1;
+    }
+
+    inchi_zstream_stop( z );
+    ret = gzseek( z->gz, (z_off_t) target, SEEK_SET );
+    if (ret < 0)
+    {
+        return -1;
+    }
+    z->pos = ret;
+    if (bThread)
+    {
+        inchi_zstream_start( z );
+    }
+    *offset = z->pos;
+
+    return 0;
+}
+
+
+/****************************************************************************/
+static int inchi_zstream_close( void *cookie )
+{
+    INCHI_ZSTREAM *z = (INCHI_ZSTREAM *) cookie;
+    int ret;
+
+    inchi_zstream_stop( z );
+    if (z->bSync)
+    {
+        pthread_cond_destroy( &z->cond );
+        pthread_mutex_destroy( &z->lock );
+    }
+    ret = ( gzclose( z->gz ) == Z_OK ) ? 0 : EOF;
+    if (z->buf[0])
+    {
+        inchi_free( z->buf[0] );
+    }
+    inchi_free( z );
+
+    return ret;
+}
+
+
+/****************************************************************************/
+static FILE *inchi_zopen( const char *path, int bWrite, int bAppend, int flags )
+{
+    INCHI_ZSTREAM *z;
+    cookie_io_functions_t io;
+    FILE *f;
+
+    z = (INCHI_ZSTREAM *) inchi_calloc( 1, sizeof( *z ) );
+    if (!z)
+    {
+        return NULL;
+    }
+    z->gz = gzopen( path, bWrite ? ( bAppend ? "ab" : "wb" ) : "rb" );
+    if (!z->gz)
+    {
+        inchi_free( z );
+        return NULL;
+    }
+    gzbuffer( z->gz, INCHI_FILE_BUFSIZE );
+    z->bWrite = bWrite;
+
+    if (!bWrite && ( flags & INCHI_FOPEN_READ_THREAD ) &&
+        NULL != ( z->buf[0] = (char *) inchi_malloc( 2 * INCHI_FILE_BUFSIZE ) ))
+    {
+        z->buf[1] = z->buf[0] + INCHI_FILE_BUFSIZE;
+        pthread_mutex_init( &z->lock, NULL );
+        pthread_cond_init( &z->cond, NULL );
+        z->bSync = 1;
+        inchi_zstream_start( z ); /* on failure, inflate on this thread */
+    }
+
+    memset( &io, 0, sizeof( io ) );
+    io.read = bWrite ? NULL : inchi_zstream_read;
+    io.write = bWrite ? inchi_zstream_write : NULL;
+    io.seek = inchi_zstream_seek;
+    io.close = inchi_zstream_close;
+    f = fopencookie( z, bWrite ? "w" : "r", io );
+    if (!f)
+    {
+        inchi_zstream_close( z );
+        return NULL;
+    }
+    setvbuf( f, NULL, _IOFBF, INCHI_FILE_BUFSIZE );
+
+    return f;
+}
+
+#else /* INCHI_ZSTREAM_COOKIE */
+
+/****************************************************************************/
+static FILE *inchi_zopen( const char *path, int bWrite, int bAppend, int flags )
+{
+    gzFile gz;
+    FILE *f;
+    char *buf;
+    int n = 0;
+
+    if (bWrite)
+    {
+        return NULL; /* not supported */
+    }
+    if (!( gz = gzopen( path, "rb" ) ))
+    {
+        return NULL;
+    }
+    f = tmpfile( );
+    buf = (char *) inchi_malloc( INCHI_FILE_BUFSIZE );
+    if (f && buf)
+    {
+        setvbuf( f, NULL, _IOFBF, INCHI_FILE_BUFSIZE );
+        while (0 < ( n = gzread( gz, buf, INCHI_FILE_BUFSIZE ) ) &&
+               (size_t) n == fwrite( buf, 1, n, f ))
+        {
+            ;
+        }
+    }
+    gzclose( gz );
+    if (buf)
+    {
+        inchi_free( buf );
+    }
+    if (f && ( n != 0 || !buf ))
+    {
+        fclose( f );
+        f = NULL;
+    }
+    if (f)
+    {
+        rewind( f );
+    }
+
+    return f;
+}
+
+#endif /* INCHI_ZSTREAM_COOKIE */
+
+#endif /* INCHI_USE_ZLIB */
+
+
+/****************************************************************************
+ Open file for reading or writing; gzip-compressed if INCHI_USE_ZLIB and
+ either the input is gzip data or the output file name ends with ".gz"
+****************************************************************************/
+FILE *inchi_fopen( const char *path, const char *mode, int flags )
+{
+    FILE *f;
+    int bWrite = ( NULL != strpbrk( mode, "wa" ) );
+
+#ifdef INCHI_USE_ZLIB
+    if (bWrite)
+    {
+        size_t len = strlen( path );
+        if (len > 3 && !inchi_stricmp( path + len - 3, ".gz" ))
+        {
+            return inchi_zopen( path, 1, NULL != strchr( mode, 'a' ), flags );
+        }
+    }
+    else if (NULL != ( f = fopen( path, "rb" ) ))
+    {
+        int c1 = getc( f );
+        int c2 = getc( f );
+        fclose( f );
+        if (c1 == 0x1f && c2 == 0x8b)
+        {
+            return inchi_zopen( path, 0, 0, flags );
+        }
+    }
+#endif
+
+    f = fopen( path, mode );
+    if (f && !bWrite)
+    {
+        setvbuf( f, NULL, _IOFBF, INCHI_FILE_BUFSIZE );
+    }
+
+    return f;
+}
+
+
 /****************************************************************************
  Print to file, echoing to stderr
 ****************************************************************************/
@@ -1611,25 +2012,70 @@ int inchi_strbuf_getline( INCHI_IOS_STRING *buf,
 /****************************************************************************
     Adds the next line to growing str buf (does not reset buf before adding).
     Returns n of read chars, -1 at end of file or at error.
+
+    The line is copied into the buffer in one piece (fgets() for a file
+    stream, as in inchi_fgetsLf()); the buffer grows geometrically.
 ****************************************************************************/
 int inchi_strbuf_addline( INCHI_IOS_STRING *buf,
                           INCHI_IOSTREAM *inp_stream,
                           int crlf2lf,
                           int preserve_lf )
 {
-    int c;
+    int n;
 
-    while (1)
+    if (inp_stream->type == INCHI_IOS_TYPE_STRING)
     {
-        c = inchi_ios_str_getc( inp_stream );
-        if (c == EOF)
+        const char *s, *lf;
+
+        n = inp_stream->s.nUsedLength - inp_stream->s.nPtr;
+        if (n <= 0)
         {
             return -1;
         }
-        inchi_strbuf_printf( buf, "%c", c );
-        if (c == '\n')
+        s = inp_stream->s.pStr + inp_stream->s.nPtr;
+        lf = (const char *) memchr( s, '\n', n );
+        if (lf)
         {
-            break;
+            n = (int) ( lf - s ) + 1;
+        }
+        if (buf->nUsedLength + n >= buf->nAllocatedLength &&
+             0 > inchi_strbuf_update( buf, inchi_max( n + 1, buf->nAllocatedLength ) ))
+        {
+            return -1;
+        }
+        memcpy( buf->pStr + buf->nUsedLength, s, n );
+        buf->nUsedLength += n;
+        buf->pStr[buf->nUsedLength] = '\0';
+        inp_stream->s.nPtr += n;
+        if (!lf)
+        {
+            return -1;
+        }
+    }
+    else
+    {
+        if (inp_stream->type != INCHI_IOS_TYPE_FILE || !inp_stream->f)
+        {
+            return -1;
+        }
+        while (1)
+        {
+            if (buf->nAllocatedLength - buf->nUsedLength < 128 &&
+                 0 > inchi_strbuf_update( buf, inchi_max( 128, buf->nAllocatedLength ) ))
+            {
+                return -1;
+            }
+            if (!fgets( buf->pStr + buf->nUsedLength,
+                        buf->nAllocatedLength - buf->nUsedLength, inp_stream->f ))
+            {
+                return -1;
+            }
+            n = (int) strlen( buf->pStr + buf->nUsedLength );
+            buf->nUsedLength += n;
+            if (n && buf->pStr[buf->nUsedLength - 1] == '\n')
+            {
+                break;
+            }
         }
     }
     if (crlf2lf)
@@ -74,6 +74,11 @@ extern "C" {
         PLAIN FILE OPERATIONS
     */
 
+    /* Open plain or gzip-compressed file (see ichi_io.c) */
+#define INCHI_FILE_BUFSIZE      262144
+#define INCHI_FOPEN_READ_THREAD 1       /* decompress input on a separate thread */
+    FILE *inchi_fopen( const char *path, const char *mode, int flags );
+
     /* Print to file, echoing to stderr */
     int inchi_fprintf( FILE* f, const char* lpszFormat, ... );
     int inchi_print_nodisplay( FILE* f, const char* lpszFormat, ... );
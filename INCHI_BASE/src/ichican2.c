@@ -51,17 +51,26 @@
 #define MAX_NODES    32766
 #define MAX_SET_SIZE 32766 /*16384*/
 #define NORMALLY_ALLOWED_MAX_SET_SIZE 2048
+#define OMEGA_PHI_FIRST_SETS 16  /* Omega and Phi storage grows from this many sets */
 #define MAX_LAYERS   100
 
 #define SEPARATE_CANON_CALLS 0
 
+#ifdef INCHI_WIDE_AT_NUMB
+#define INCHI_CANON_INFINITY       0x7FFFFFFF
+/* limit on the number of bits in each of Omega and Phi node sets */
+#define MAX_SET_BITS  (1L << 30)
+#else
 #define INCHI_CANON_INFINITY       0x7FFF
+#endif
 
 #define INCHI_CANON_MIN
 
 #define EMPTY_CT       0
-#define EMPTY_H_NUMBER (INCHI_CANON_INFINITY-1)
-#define BASE_H_NUMBER  ((INCHI_CANON_INFINITY-1)/2)
+/* NumH are NUM_H (signed short) regardless of AT_NUMB width */
+#define INCHI_CANON_NUM_H_INFINITY 0x7FFF
+#define EMPTY_H_NUMBER (INCHI_CANON_NUM_H_INFINITY-1)
+#define BASE_H_NUMBER  ((INCHI_CANON_NUM_H_INFINITY-1)/2)
 #define EMPTY_ISO_SORT_KEY LONG_MAX
 
 
@@ -111,14 +120,6 @@ typedef struct tagCell
     int       prev;   /* position of the previously returned cell element */
 } Cell;
 
-#ifdef NEVER /* moved to ichi_bns.h */
-typedef struct tagNodeSet {
-    bitWord **bitword;
-    int num_set; /* number of sets */
-    int len_set; /* number of bitWords in each set */
-} NodeSet;
-#endif
-
 typedef struct tagTransposition
 {
     AT_NUMB *nAtNumb;
@@ -711,10 +712,32 @@ int NodeSetCreate( struct tagCANON_GLOBALS *pCG,
                    NodeSet *pSet,
                    int n,
                    int L )
+{
+    return NodeSetCreateLazy( pCG, pSet, n, L, L );
+}
+
+
+/****************************************************************************
+ Create L sets of n nodes with storage for only the first L0 of them;
+ NodeSetReserve() adds storage for more sets when they are needed
+****************************************************************************/
+int NodeSetCreateLazy( struct tagCANON_GLOBALS *pCG,
+                       NodeSet *pSet,
+                       int n,
+                       int L,
+                       int L0 )
 {
     int i, len;
 
     len = ( n + pCG->m_num_bit - 1 ) / pCG->m_num_bit;
+    if (L0 > L)
+    {
+        L0 = L;
+    }
+    if (L0 < 1)
+    {
+        L0 = 1;
+    }
 
     pSet->bitword = (bitWord**) inchi_calloc( L, sizeof( pSet->bitword[0] ) );
 
@@ -722,7 +745,7 @@ int NodeSetCreate( struct tagCANON_GLOBALS *pCG,
     {
         return 0;
     }
-    pSet->bitword[0] = (bitWord*) inchi_calloc( len*L, sizeof( pSet->bitword[0][0] ) );
+    pSet->bitword[0] = (bitWord*) inchi_calloc( len*L0, sizeof( pSet->bitword[0][0] ) );
     if (!pSet->bitword[0])
     {
         /* Cleanup */
@@ -730,13 +753,47 @@ int NodeSetCreate( struct tagCANON_GLOBALS *pCG,
         pSet->bitword = NULL;
         return 0; /* failed */
     }
-    for (i = 1; i < L; i++)
+    for (i = 1; i < L0; i++)
     {
         pSet->bitword[i] = pSet->bitword[i - 1] + len;
     }
 
     pSet->len_set = len;
     pSet->num_set = L;
+    pSet->num_alloc = L0;
+    pSet->num_first = L0;
+
+    return 1;
+}
+
+
+/****************************************************************************
+ Make sure the first k sets have storage. Each new block doubles
+ the number of allocated sets, so blocks start at num_first*2^j
+****************************************************************************/
+int NodeSetReserve( NodeSet *pSet, int k )
+{
+    int i, num_new;
+    bitWord *p;
+
+    if (k > pSet->num_set)
+    {
+        return 0;
+    }
+    while (pSet->num_alloc < k)
+    {
+        num_new = inchi_min( pSet->num_alloc, pSet->num_set - pSet->num_alloc );
+        p = (bitWord*) inchi_calloc( (size_t) pSet->len_set * num_new, sizeof( p[0] ) );
+        if (!p)
+        {
+            return 0;
+        }
+        for (i = 0; i < num_new; i++)
+        {
+            pSet->bitword[pSet->num_alloc + i] = p + (size_t) i * pSet->len_set;
+        }
+        pSet->num_alloc += num_new;
+    }
 
     return 1;
 }
@@ -745,11 +802,16 @@ int NodeSetCreate( struct tagCANON_GLOBALS *pCG,
 /****************************************************************************/
 void NodeSetFree( struct tagCANON_GLOBALS *pCG, NodeSet *pSet )
 {
+    int i;
+
     if (pSet && pSet->bitword)
     {
-        if (pSet->bitword[0])
+        for (i = 0; i < pSet->num_alloc; i = i ? 2 * i : pSet->num_first)
         {
-            inchi_free( pSet->bitword[0] );
+            if (pSet->bitword[i])
+            {
+                inchi_free( pSet->bitword[i] );
+            }
         }
         inchi_free( pSet->bitword );
         pSet->bitword = NULL;
@@ -3768,6 +3830,17 @@ int CanonGraph( INCHI_CLOCK *ic,
     {
         L_curr_max_set_size = NORMALLY_ALLOWED_MAX_SET_SIZE;
     }
+#ifdef INCHI_WIDE_AT_NUMB
+    /* Omega and Phi take 2*n_tg*L bits; fewer stored sets only weaken pruning */
+    if (n_tg > 0 && L_curr_max_set_size > MAX_SET_BITS / n_tg)
+    {
+        L_curr_max_set_size = (int) ( MAX_SET_BITS / n_tg );
+        if (L_curr_max_set_size < 1)
+        {
+            L_curr_max_set_size = 1;
+        }
+    }
+#endif
 
 
     /* Note: Layered comparison should be consistent, especially in layer numbers.
@@ -3823,8 +3896,8 @@ int CanonGraph( INCHI_CLOCK *ic,
     ok &= ( ( pzb_rho = (ConTable *) inchi_calloc( 1, sizeof( *pzb_rho ) ) ) &&
             CTableCreate( pzb_rho, n, pCD ) );
 
-    ok &= NodeSetCreate( pCG, &Omega, n_tg, L_curr_max_set_size );
-    ok &= NodeSetCreate( pCG, &Phi, n_tg, L_curr_max_set_size );
+    ok &= NodeSetCreateLazy( pCG, &Omega, n_tg, L_curr_max_set_size, OMEGA_PHI_FIRST_SETS );
+    ok &= NodeSetCreateLazy( pCG, &Phi, n_tg, L_curr_max_set_size, OMEGA_PHI_FIRST_SETS );
     ok &= NodeSetCreate( pCG, &cur_nodes, n_tg, 1 );
 
     ok &= PartitionCreate( &zeta, n_tg );
@@ -4168,6 +4241,11 @@ L6:
     }
 
     l = inchi_min( l + 1, L_curr_max_set_size );
+    if (!NodeSetReserve( &Omega, l ) || !NodeSetReserve( &Phi, l ))
+    {
+        ret = CT_OUT_OF_RAM;
+        goto exit_error;
+    }
     PartitionGetMcrAndFixSet( pCG, &pi[t_Lemma - 1], &Omega, &Phi, n_tg, l );
     goto L12;
 
@@ -4332,6 +4410,11 @@ L9:
 L10: /* discrete pi[k-1] && G^gamma == G */
     pCC->lNumEqualCT += bZetaEqRho || !( bZetaIsomorph || qzb_rho );
     l = inchi_min( l + 1, L_curr_max_set_size );
+    if (!NodeSetReserve( &Omega, l ) || !NodeSetReserve( &Phi, l ))
+    {
+        ret = CT_OUT_OF_RAM;
+        goto exit_error;
+    }
     /* Omega[l] := mcr(gamma);
        Phi[l]   := fix(gamma);
     */
@@ -4572,6 +4655,9 @@ exit_function:
     pCC->lNumGenerators = nNumFoundGenerators;
     pCC->lNumStoredIsomorphisms = l;
     /* Note: check nNumFoundGenerators */
+    pCD->dGroupSize = size;
+    pCD->lNumGenerators = nNumFoundGenerators;
+    pCD->lNumTotCT = pCC->lNumTotCT;
 
     if (pp_zb_rho_out && !*pp_zb_rho_out)
     {
@@ -5367,6 +5453,13 @@ int GetBaseCanonRanking( INCHI_CLOCK *ic,
                                          &lCount,
                                          0 /* 0 means use qsort */ );
 
+    /* the initial partition of a large structure takes a while: check timeout/cancel */
+    if (bInchiTimeIsOver( ic, ulTimeOutTime ))
+    {
+        ret = CT_TIMEOUT_ERR;
+        goto exit_error;
+    }
+
     /* allocate partition stack */
     nMaxLenRankStack = 2 * ( num_at_tg - nNumCurrRanks ) + 8;  /* was 2*(...) + 6 */
     pBCN->pRankStack = (AT_RANK **) inchi_calloc( nMaxLenRankStack, sizeof( pBCN->pRankStack[0] ) );
@@ -6651,6 +6744,9 @@ int GetBaseCanonRanking( INCHI_CLOCK *ic,
         pBCN->ftcn[TAUT_YES].nNumHFixH = NULL;
         pBCN->ftcn[TAUT_YES].nLenNumHFixH = 0;
         pBCN->ftcn[TAUT_YES].nCanonFlags |= pCD[iBase].nCanonFlags;
+        pBCN->ftcn[TAUT_YES].dGroupSize = pCD[iBase].dGroupSize;
+        pBCN->ftcn[TAUT_YES].lNumGenerators = pCD[iBase].lNumGenerators;
+        pBCN->ftcn[TAUT_YES].lNumTotCT = pCD[iBase].lNumTotCT;
 
         CleanNumH( pBCN->ftcn[TAUT_YES].nNumHOrig, pBCN->ftcn[TAUT_YES].nLenNumH );
         CleanNumH( pBCN->ftcn[TAUT_YES].nNumH, pBCN->ftcn[TAUT_YES].nLenNumH );
@@ -6735,6 +6831,9 @@ int GetBaseCanonRanking( INCHI_CLOCK *ic,
         Ct_FixH->NumHfixed = NULL;
         pBCN->ftcn[iOther].nLenNumHFixH = num_atoms;
         pBCN->ftcn[iOther].nCanonFlags |= pCD[iOther].nCanonFlags;
+        pBCN->ftcn[iOther].dGroupSize = pCD[iOther].dGroupSize;
+        pBCN->ftcn[iOther].lNumGenerators = pCD[iOther].lNumGenerators;
+        pBCN->ftcn[iOther].lNumTotCT = pCD[iOther].lNumTotCT;
 
         /* original H */
         CleanNumH( pBCN->ftcn[iOther].nNumHOrig, pBCN->ftcn[iOther].nLenNumH );
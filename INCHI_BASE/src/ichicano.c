@@ -32,6 +32,11 @@
  */
 
 
+/* clock_gettime() for the thread CPU time or monotonic clock, see ichitime.h */
+#if ( defined(__linux__) || defined(__FreeBSD__) ) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -85,6 +90,46 @@ int Canon_INChI3( INCHI_CLOCK *ic,
                   int bTautFtcn );
 
 
+/* cancellation flag registered for the InChI calculations of this thread */
+static INCHI_THREAD_LOCAL volatile int *pbInchiCancelThisThread;
+
+
+/****************************************************************************
+ Register (or remove, if NULL) the flag which stops InChI calculations
+ started afterwards in this thread as soon as it becomes non-zero
+****************************************************************************/
+void InchiClockSetCancelFlag( volatile int *pbCancel )
+{
+    pbInchiCancelThisThread = pbCancel;
+}
+
+
+/****************************************************************************/
+volatile int *InchiClockGetCancelFlag( void )
+{
+    return pbInchiCancelThisThread;
+}
+
+
+/****************************************************************************
+ Prepare the clock context of an InChI calculation in this thread
+****************************************************************************/
+void InchiClockInit( INCHI_CLOCK *ic )
+{
+    memset( ic, 0, sizeof( *ic ) );
+    ic->m_pbCancel = pbInchiCancelThisThread;
+}
+
+
+/****************************************************************************
+ Returns 1 if the calculation has been cancelled by another thread
+****************************************************************************/
+static int InchiClockCancelled( INCHI_CLOCK *ic )
+{
+    return ic && ic->m_pbCancel && *ic->m_pbCancel;
+}
+
+
 #ifdef COMPILE_ANSI_ONLY
 
 static clock_t InchiClock( void );
@@ -100,6 +145,23 @@ static clock_t InchiClock( void )
     }
     return 0;
 }
+#elif ( INCHI_TIMEOUT_CLOCK == 1 && defined(CLOCK_THREAD_CPUTIME_ID) ) || \
+      ( INCHI_TIMEOUT_CLOCK == 2 && defined(CLOCK_MONOTONIC) )
+static clock_t InchiClock( void )
+{
+    struct timespec ts;
+#if ( INCHI_TIMEOUT_CLOCK == 1 )
+    if (!clock_gettime( CLOCK_THREAD_CPUTIME_ID, &ts ))
+#else
+    if (!clock_gettime( CLOCK_MONOTONIC, &ts ))
+#endif
+    {
+        /* in clock() units; wraps around like clock() does */
+        return (clock_t) ( (unsigned long) ts.tv_sec * CLOCKS_PER_SEC +
+                           (unsigned long) ts.tv_nsec / ( 1000000000UL / CLOCKS_PER_SEC ) );
+    }
+    return 0;
+}
 #else
 static clock_t InchiClock( void )
 {
@@ -249,6 +311,10 @@ void InchiTimeAddMsec( INCHI_CLOCK *ic, inchiTime *TickEnd, unsigned long nNumMs
 /******************* check whether time has expired *********************/
 int bInchiTimeIsOver( INCHI_CLOCK *ic, inchiTime *TickStart )
 {
+    if (InchiClockCancelled( ic ))
+    {
+        return 1;
+    }
     if (FullMaxClock > 0)
     {
         clock_t clockCurrTime;
@@ -386,6 +452,10 @@ void InchiTimeAddMsec( INCHI_CLOCK *ic, inchiTime *TickEnd, unsigned long nNumMs
 int bInchiTimeIsOver( INCHI_CLOCK *ic, inchiTime *TickEnd )
 {
     struct _timeb timeb;
+    if (InchiClockCancelled( ic ))
+    {
+        return 1;
+    }
     if (!TickEnd)
     {
         return 0;
@@ -1548,6 +1618,10 @@ VII. Optimize isotopic stereo descriptors (optimized)
 
     /* Save non-isotopic and isotopic canonicalization results */
     pCS->nCanonFlags = ftcn->nCanonFlags;
+    pCS->dGroupSize = ftcn->dGroupSize;
+    pCS->lNumGenerators = ftcn->lNumGenerators;
+    pCS->lNumCanonTotCT = ftcn->lNumTotCT;
+    pCS->lNumStereoMapSteps = 0; /* accumulated over all stereo passes below */
     /* 1. non-isotopic */
 
     /* linear CT, H */
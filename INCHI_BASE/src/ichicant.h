@@ -144,6 +144,9 @@ typedef struct tagFixHOrTautCanonNumbering {
     int             num_at_tg;  /* = num_atoms for non-taut */
     int             num_atoms;
     int             nCanonFlags;
+    double          dGroupSize;     /* |Aut(G)| found by CanonGraph() */
+    long            lNumGenerators;
+    long            lNumTotCT;
     NEIGH_LIST     *NeighList;  /* length = num_at_tg */
     /****************************/
     /*     base structure       */
@@ -211,6 +214,10 @@ typedef struct tagCanonStat {
     int                  bStereoIsBetter;
 
     int nCanonFlags;
+    double               dGroupSize;      /* |Aut(G)| found by CanonGraph() */
+    long                 lNumGenerators;
+    long                 lNumCanonTotCT;  /* terminal nodes compared by CanonGraph() */
+    long                 lNumStereoMapSteps; /* map_stereo_bonds4/atoms4 calls, all passes */
 
     /* data : */
 
@@ -359,6 +366,10 @@ typedef struct tagCanonData {
     int      nLenLinearCT;
     int      nLenCTAtOnly;
     int      nCanonFlags;
+    /* search statistics of the last CanonGraph() call */
+    double   dGroupSize;      /* |Aut(G)| */
+    long     lNumGenerators;  /* number of found Aut(G) generators */
+    long     lNumTotCT;       /* number of compared terminal nodes */
     /* hydrogen atoms fixed in tautomeric representation:
        compare before diff sign inversion: (+) <=> Ct1->() > Ct2->() */
     NUM_H          *NumH;
@@ -114,6 +114,7 @@ typedef struct tagInputParms {
     char            szSdfDataHeader[MAX_SDF_HEADER + 1];
     char           *pSdfLabel;
     char           *pSdfValue;
+    struct tagSdfFields *pSdfFields;    /* SDF data items to collect, or NULL */
     unsigned long   lSdfId;
     long            lMolfileNumber;
 
@@ -179,6 +180,13 @@ typedef struct tagInputParms {
     int             bMergeHash;             /* v. 1.06+ Combine InChIKey with extra hash(es) if present             */
     int             bNoWarnings;            /* v. 1.06+ suppress warning messages                                   */
     int             bHideInChI;             /* v. 1.06+ Do not print InChI itself                                   */
+    int             bCanonStat;             /* v. 1.06+ log automorphism group size found by canonicalization       */
+    int             bMemStat;               /* v. 1.06+ log peak heap bytes used for each structure                 */
+    long            msec_CaptureSlow;       /* v. 1.06+ capture records processed at least this long, msec; 0=>off  */
+    char            szCaptureDir[256];      /* v. 1.06+ directory for captured records; empty=>current              */
+    char            szCaptureOptions[512];  /* v. 1.06+ options to replay captured records with                     */
+    int             bGzThread;              /* v. 1.06+ decompress gzip input file on a separate thread             */
+    int             bSdfIndex;              /* v. 1.06+ seek to START:n record using SD file index <input>.idx     */
 
 
     /* */
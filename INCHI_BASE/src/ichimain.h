@@ -306,6 +306,15 @@ int TreatErrorsInCreateOneComponentINChI( STRUCT_DATA *sd,
                                           INCHI_IOSTREAM *log_file,
                                           INCHI_IOSTREAM *out_file,
                                           INCHI_IOSTREAM *prb_file );
+void CaptureSlowRecord( STRUCT_DATA *sd,
+                        INPUT_PARMS *ip,
+                        PINChI_Aux2 *pINChI_Aux[INCHI_NUM],
+                        INCHI_IOSTREAM *inp_file,
+                        INCHI_IOSTREAM *log_file,
+                        ORIG_ATOM_DATA *orig_inp_data,
+                        long num_inp,
+                        int nRet,
+                        long lPeakMem );
 int TreatCreateINChIWarning( STRUCT_DATA *sd,
                              INPUT_PARMS *ip,
                              ORIG_ATOM_DATA *orig_inp_data,
@@ -366,6 +375,10 @@ int GetOneStructure( struct tagINCHI_CLOCK *ic,
                      ORIG_ATOM_DATA *orig_inp_data,
                      long *num_inp,
                      STRUCT_FPTRS *struct_fptrs );
+long SDFileIndexSeek( struct tagINCHI_CLOCK *ic,
+                      const INPUT_PARMS *ip,
+                      INCHI_IOSTREAM *inp_file,
+                      INCHI_IOSTREAM *log_file );
 int ProcessOneStructure( struct tagINCHI_CLOCK *ic,
                          struct tagCANON_GLOBALS *pCG,
                          STRUCT_DATA *sd,
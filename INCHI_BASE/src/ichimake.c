@@ -35,6 +35,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 
 #include "mode.h"
 #include "ichimake.h"
@@ -101,6 +102,8 @@ int CheckCanonNumberingCorrectness( int num_atoms,
                                     int bTautomeric,
                                     char *pStrErrStruct );
 static int CompareDfsDescendants4CT( const void *a1, const void *a2, void* );
+static int CompINChI2Tail( const INCHI_SORT *p1, const INCHI_SORT *p2,
+                           int bTaut, int bCompareIsotopic );
 int GetSp3RelRacAbs( const INChI *pINChI, INChI_Stereo *Stereo );
 #if ( READ_INCHI_STRING == 1 ) /*  { */
 int CompareReversedStereoINChI2( INChI_Stereo *s1, INChI_Stereo *s2, ICR *picr );
@@ -1712,24 +1715,11 @@ int CompINChI2( const INCHI_SORT *p1,
     int   n1;               /* TAUT_YES if tautomeric i1 exists, otherwise TAUT_NON */
     int   n2;               /* TAUT_YES if tautomeric i2 exists, otherwise TAUT_NON */
 
-    const INChI *i1n = NULL; /* non-tautomeric if both tautomeric AND non-tautomeric exist */
-    const INChI *i2n = NULL; /* non-tautomeric if both tautomeric AND non-tautomeric exist */
-
-    /*const INChI *i1t = NULL;*/ /* temp for i1 if both tautomeric AND non-tautomeric exist */
-    /*const INChI *i2t = NULL;*/ /* temp for i2 if both tautomeric AND non-tautomeric exist */
-
-    /* INChI_Stereo *Stereo1, *Stereo2; */
-
     n1 = ( p1->pINChI[TAUT_YES] && p1->pINChI[TAUT_YES]->nNumberOfAtoms ) ? TAUT_YES : TAUT_NON;
     n2 = ( p2->pINChI[TAUT_YES] && p2->pINChI[TAUT_YES]->nNumberOfAtoms ) ? TAUT_YES : TAUT_NON;
 
     i1 = p1->pINChI[n1];
-    i1n = ( n1 == TAUT_YES && p1->pINChI[TAUT_NON] &&
-           p1->pINChI[TAUT_NON]->nNumberOfAtoms ) ? p1->pINChI[TAUT_NON] : (const INChI *) NULL;
-
     i2 = p2->pINChI[n2];
-    i2n = ( n2 == TAUT_YES && p2->pINChI[TAUT_NON] &&
-          p2->pINChI[TAUT_NON]->nNumberOfAtoms ) ? p2->pINChI[TAUT_NON] : (const INChI *) NULL;
 
     /* non-deleted-non-empty < deleted < empty */
     if (i1 && !i2)
@@ -1819,6 +1809,43 @@ int CompINChI2( const INCHI_SORT *p1,
     }
     */
 
+    return CompINChI2Tail( p1, p2, bTaut, bCompareIsotopic );
+}
+
+
+/****************************************************************************
+  CompINChI2Tail( ... )
+
+    The part of CompINChI2() which follows the comparison of formulas,
+    connection tables, hydrogens and mobile groups: fixed-H layer,
+    stereo, isotopic layers and charges.
+    Returns 0 if either component is empty.
+****************************************************************************/
+static int CompINChI2Tail( const INCHI_SORT *p1,
+                           const INCHI_SORT *p2,
+                           int bTaut,
+                           int bCompareIsotopic )
+{
+    int ret, num, i;
+    const INChI *i1, *i2, *i1n, *i2n;
+    int   n1, n2;
+
+    n1 = ( p1->pINChI[TAUT_YES] && p1->pINChI[TAUT_YES]->nNumberOfAtoms ) ? TAUT_YES : TAUT_NON;
+    n2 = ( p2->pINChI[TAUT_YES] && p2->pINChI[TAUT_YES]->nNumberOfAtoms ) ? TAUT_YES : TAUT_NON;
+
+    i1 = p1->pINChI[n1];
+    i1n = ( n1 == TAUT_YES && p1->pINChI[TAUT_NON] &&
+           p1->pINChI[TAUT_NON]->nNumberOfAtoms ) ? p1->pINChI[TAUT_NON] : (const INChI *) NULL;
+
+    i2 = p2->pINChI[n2];
+    i2n = ( n2 == TAUT_YES && p2->pINChI[TAUT_NON] &&
+          p2->pINChI[TAUT_NON]->nNumberOfAtoms ) ? p2->pINChI[TAUT_NON] : (const INChI *) NULL;
+
+    if (!i1 || !i2)
+    {
+        return 0;
+    }
+
     /*********************************************************
      *                                                       *
      *  at this point both components are either tautomeric  *
@@ -2072,6 +2099,248 @@ int CompINChITaut2( const void *p1, const void *p2 )
 }
 
 
+/****************************************************************************
+    Component sort keys.
+
+    The leading part of CompINChI2() -- empty/deleted, Hill formula
+    without H, atoms, connection table, number of H, H on atoms and
+    mobile groups -- does not depend on bTaut and is encoded once per
+    component as an array of ints: keys compare element by element,
+    lesser first, with the same result as CompINChI2(). Components with
+    equal keys are further compared by CompINChI2Tail().
+****************************************************************************/
+typedef struct tagINChISortKey
+{
+    INCHI_SORT *pINChISort;
+    int        *key;
+    int         len;
+    int         bComplete; /* 0 => key holds only empty/deleted rank */
+} INCHI_SORT_KEY;
+
+
+/****************************************************************************
+    Upper bound of the key length
+****************************************************************************/
+static int GetINChISortKeyMaxLen( const INCHI_SORT *p )
+{
+    const INChI *i1;
+
+    i1 = p->pINChI[( p->pINChI[TAUT_YES] && p->pINChI[TAUT_YES]->nNumberOfAtoms ) ? TAUT_YES : TAUT_NON];
+    if (!i1)
+    {
+        return 1;
+    }
+
+    return 7 + 2 * ( i1->szHillFormula ? (int) strlen( i1->szHillFormula ) : 0 ) +
+           2 * inchi_max( i1->nNumberOfAtoms, 0 ) + inchi_max( i1->lenConnTable, 0 ) +
+           inchi_max( i1->lenTautomer, 0 );
+}
+
+
+/****************************************************************************
+    Fill out component sort key, see CompINChI2()
+****************************************************************************/
+static void MakeINChISortKey( INCHI_SORT_KEY *k )
+{
+    const INChI *i1;
+    const char  *f;
+    char  szEl[4];
+    int   *key = k->key;
+    int   len = 0, num_H = 0, count, ret, i, num;
+
+    i1 = k->pINChISort->pINChI[( k->pINChISort->pINChI[TAUT_YES] &&
+                                k->pINChISort->pINChI[TAUT_YES]->nNumberOfAtoms ) ? TAUT_YES : TAUT_NON];
+    k->bComplete = 0;
+    k->len = 1;
+
+    /* non-deleted-non-empty < deleted < empty */
+    if (!i1)
+    {
+        key[0] = 2;
+        k->bComplete = 1;
+        return;
+    }
+    key[len++] = i1->bDeleted ? 1 : 0;
+
+    /* Hill formula without H, see CompareHillFormulasNoH() */
+    if (!( f = i1->szHillFormula ))
+    {
+        return;
+    }
+    do
+    {
+        ret = GetElementAndCount( &f, szEl, &count );
+        if (ret < 0)
+        {
+            return; /* not a formula; leave it to CompINChI2() */
+        }
+        if (ret > 0 && szEl[0] == 'H' && !szEl[1])
+        {
+            num_H += count;
+            continue;
+        }
+        key[len++] = ( UCINT szEl[0] << 16 ) |
+                     ( szEl[1] ? ( UCINT szEl[1] << 8 ) | UCINT szEl[2] : 0 );
+        key[len++] = -count; /* inverse atom count order */
+    }
+    while (ret > 0);
+
+    /* more atoms first, greater periodic number first */
+    num = i1->nNumberOfAtoms;
+    key[len++] = -num;
+    for (i = 0; i < num; i++)
+    {
+        key[len++] = -(int) i1->nAtom[i];
+    }
+
+    /* longer and greater connection table first */
+    num = i1->lenConnTable;
+    key[len++] = -num;
+    for (i = 0; i < num; i++)
+    {
+        key[len++] = -(int) i1->nConnTable[i];
+    }
+
+    /* total number of H: H3 < H2 */
+    key[len++] = -num_H;
+
+    /* N < NH3 < NH2 < NH */
+    num = i1->nNumberOfAtoms;
+    for (i = 0; i < num; i++)
+    {
+        key[len++] = i1->nNum_H[i] ? -(int) i1->nNum_H[i] : INT_MIN;
+    }
+
+    /* mobile groups, see CompareTautNonIsoPartOfINChI() */
+    num = ( i1->lenTautomer > 0 && i1->nTautomer[0] ) ? i1->lenTautomer : 0;
+    key[len++] = -num;
+    for (i = 0; i < num; i++)
+    {
+        key[len++] = -(int) i1->nTautomer[i];
+    }
+
+    k->len = len;
+    k->bComplete = 1;
+}
+
+
+/****************************************************************************
+    Same result as CompINChITaut2() for bTaut = TAUT_YES and as
+    CompINChINonTaut2() for bTaut = TAUT_NON
+****************************************************************************/
+static int CompINChISortKeys( const INCHI_SORT_KEY *k1,
+                              const INCHI_SORT_KEY *k2,
+                              int bTaut )
+{
+    int ret, i, num = inchi_min( k1->len, k2->len );
+
+    for (i = 0; i < num; i++)
+    {
+        if (k1->key[i] != k2->key[i])
+        {
+            return k1->key[i] < k2->key[i] ? -1 : 1;
+        }
+    }
+    if (!k1->bComplete || !k2->bComplete)
+    {
+        return ( bTaut == TAUT_YES ) ? CompINChITaut2( k1->pINChISort, k2->pINChISort )
+                                     : CompINChINonTaut2( k1->pINChISort, k2->pINChISort );
+    }
+    ret = CompINChI2Tail( k1->pINChISort, k2->pINChISort, bTaut, 1 );
+#if ( CANON_FIXH_TRANS == 1 )
+    if (!ret)
+    {
+        /* to obtain canonical transposition 2004-05-10 */
+        ret = CompINChI2Tail( k1->pINChISort, k2->pINChISort,
+                              ( bTaut == TAUT_YES ) ? TAUT_NON : TAUT_YES, 1 );
+    }
+#endif
+    if (!ret)
+    {
+        /* stable sort */
+        ret = k1->pINChISort->ord_number - k2->pINChISort->ord_number;
+    }
+
+    return ret;
+}
+
+
+/****************************************************************************/
+static int CompINChISortKeysTaut( const void *k1, const void *k2 )
+{
+    return CompINChISortKeys( (const INCHI_SORT_KEY *) k1, (const INCHI_SORT_KEY *) k2, TAUT_YES );
+}
+
+
+/****************************************************************************/
+static int CompINChISortKeysNonTaut( const void *k1, const void *k2 )
+{
+    return CompINChISortKeys( (const INCHI_SORT_KEY *) k1, (const INCHI_SORT_KEY *) k2, TAUT_NON );
+}
+
+
+/****************************************************************************
+    Sort components in the order of CompINChITaut2() (bTaut = TAUT_YES)
+    or CompINChINonTaut2() (bTaut = TAUT_NON), using sort keys.
+    Falls back to sorting with these comparators if out of RAM.
+****************************************************************************/
+void SortINChIComponents( INCHI_SORT *pINChISort, int num_components, int bTaut )
+{
+    INCHI_SORT_KEY *keys = NULL;
+    INCHI_SORT     *sorted = NULL;
+    int            *key_buf = NULL;
+    int             i, len;
+
+    if (num_components < 2)
+    {
+        return;
+    }
+
+    for (i = 0, len = 0; i < num_components; i++)
+    {
+        len += GetINChISortKeyMaxLen( pINChISort + i );
+    }
+    keys = (INCHI_SORT_KEY *) inchi_malloc( num_components * sizeof( keys[0] ) );
+    sorted = (INCHI_SORT *) inchi_malloc( num_components * sizeof( sorted[0] ) );
+    key_buf = (int *) inchi_malloc( len * sizeof( key_buf[0] ) );
+    if (!keys || !sorted || !key_buf)
+    {
+        qsort( pINChISort, num_components, sizeof( pINChISort[0] ),
+               ( bTaut == TAUT_YES ) ? CompINChITaut2 : CompINChINonTaut2 );
+        goto exit_function;
+    }
+
+    for (i = 0, len = 0; i < num_components; i++)
+    {
+        keys[i].pINChISort = pINChISort + i;
+        keys[i].key = key_buf + len;
+        len += GetINChISortKeyMaxLen( pINChISort + i );
+        MakeINChISortKey( keys + i );
+    }
+    qsort( keys, num_components, sizeof( keys[0] ),
+           ( bTaut == TAUT_YES ) ? CompINChISortKeysTaut : CompINChISortKeysNonTaut );
+    for (i = 0; i < num_components; i++)
+    {
+        sorted[i] = *keys[i].pINChISort;
+    }
+    memcpy( pINChISort, sorted, num_components * sizeof( pINChISort[0] ) );
+
+exit_function:
+    if (keys)
+    {
+        inchi_free( keys );
+    }
+    if (sorted)
+    {
+        inchi_free( sorted );
+    }
+    if (key_buf)
+    {
+        inchi_free( key_buf );
+    }
+}
+
+
 /****************************************************************************
  mystrrev( ... )
     NB:
@@ -3761,6 +4030,10 @@ int  Create_INChI( CANON_GLOBALS *pCG,
     int LargeMolecules = ip->bLargeMolecules;
     int Polymers;
 
+    inchiTime ulTStage;             /* stage timing for the CaptureSlow profile */
+    long      lNormTime = 0, lCanonTime = 0;
+    int       nStage = 0;           /* 0=>normalization, 1=>base ranking, 2=>Canon_INChI */
+
     /*    vABParityUnknown holds actual value of an internal constant signifying
         unknown parity: either the same as for undefined parity (default==standard)
         or a specific one (non-std; requested by SLUUD switch).                 */
@@ -3771,6 +4044,8 @@ int  Create_INChI( CANON_GLOBALS *pCG,
         vABParityUnknown = AB_PARITY_UNKN;
     }
 
+    InchiTimeGet( &ulTStage );
+
     Polymers = ip->bPolymers; /* keep compiler happy */ Polymers;
 
 #if ( FIX_ISO_FIXEDH_BUG == 1 )
@@ -4236,10 +4511,17 @@ int  Create_INChI( CANON_GLOBALS *pCG,
         bHasIsotopicAtoms = 0;
     }
 
+    lNormTime = InchiTimeElapsed( ic, &ulTStage );
+    InchiTimeGet( &ulTStage );
+    nStage = 1;
+
     ret = GetBaseCanonRanking( ic, num_atoms, num_at_tg, at,
                                t_group_info, s, pBCN, ulMaxTime,
                                pCG, bFixIsoFixedH, LargeMolecules );
 
+    lCanonTime = InchiTimeElapsed( ic, &ulTStage );
+    nStage = 2;
+
     if (ret < 0)
     {
         goto exit_function; /*  program error */
@@ -4414,6 +4696,10 @@ int  Create_INChI( CANON_GLOBALS *pCG,
 
         pINChI = ppINChI[i];      /* pointers to already allocated still empty InChI */
         pINChI_Aux = ppINChI_Aux[i];
+        if (pINChI_Aux)
+        {
+            pINChI_Aux->lStereoTime = pCS->lTotalTime;
+        }
 
         if (ret <= 0)
         {
@@ -4435,6 +4721,10 @@ int  Create_INChI( CANON_GLOBALS *pCG,
             pINChI_Aux->nErrorCode = 0;
             pINChI->bDeleted = pINChI_Aux->bDeleted = out_norm_data[i]->bDeleted;
             pINChI_Aux->nCanonFlags = pCS->nCanonFlags;
+            pINChI_Aux->dGroupSize = pCS->dGroupSize;
+            pINChI_Aux->lNumGenerators = pCS->lNumGenerators;
+            pINChI_Aux->lNumCanonTotCT = pCS->lNumCanonTotCT;
+            pINChI_Aux->lNumStereoMapSteps = pCS->lNumStereoMapSteps;
             pINChI_Aux->bTautFlags = out_norm_data[i]->bTautFlags;
             pINChI_Aux->bTautFlagsDone = out_norm_data[i]->bTautFlagsDone;
             pINChI_Aux->bNormalizationFlags = out_norm_data[i]->bNormalizationFlags;
@@ -4507,6 +4797,24 @@ int  Create_INChI( CANON_GLOBALS *pCG,
 
 exit_function:
 
+    /* charge the time of an interrupted stage to that stage */
+    if (nStage == 0)
+    {
+        lNormTime = InchiTimeElapsed( ic, &ulTStage );
+    }
+    else if (nStage == 1)
+    {
+        lCanonTime = InchiTimeElapsed( ic, &ulTStage );
+    }
+    for (i = 0; i < TAUT_NUM; i++)
+    {
+        if (ppINChI_Aux[i])
+        {
+            ppINChI_Aux[i]->lNormTime = lNormTime;
+            ppINChI_Aux[i]->lCanonTime = lCanonTime;
+        }
+    }
+
     DeAllocBCN( pBCN );
     if (at[TAUT_YES])
     {
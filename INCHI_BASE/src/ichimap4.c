@@ -39,6 +39,9 @@
 
 #define SB_DEPTH 6
 
+/* check the time limit once per (MAP_TIME_CHECK_MASK+1) mapping steps */
+#define MAP_TIME_CHECK_MASK 0x3FF
+
 /*
 static int deep_map_stereo_atoms4=0;
 */
@@ -103,6 +106,12 @@ int map_stereo_bonds4( struct tagINCHI_CLOCK *ic,
     memset( &prevBond, 0, sizeof( prevBond ) );
     tpos1 = CurTreeGetPos( cur_tree );
 
+    if (!( ++pCS->lNumStereoMapSteps & MAP_TIME_CHECK_MASK ) &&
+         bInchiTimeIsOver( ic, pCS->ulTimeOutTime ))
+    {
+        return CT_TIMEOUT_ERR;
+    }
+
 total_restart:
 
     if (!nNumMappedBonds)
@@ -1150,6 +1159,12 @@ int map_stereo_atoms4( struct tagINCHI_CLOCK *ic,
 
     tpos1 = CurTreeGetPos( cur_tree );
 
+    if (!( ++pCS->lNumStereoMapSteps & MAP_TIME_CHECK_MASK ) &&
+         bInchiTimeIsOver( ic, pCS->ulTimeOutTime ))
+    {
+        return CT_TIMEOUT_ERR;
+    }
+
     if (nNumMappedAtoms < pCS->nLenLinearCTStereoCarb)
     {
         /* AT_RANK *nRankFrom=*pRankStack1++,  AT_RANK *nAtomNumberFrom=pRankStack1++; */
@@ -1894,7 +1909,10 @@ done:;      /*  at this point lvl=0. */
                 nCanonRankTo[n2] = rc;                    /*  assign new canon. number to the atom */
                 /*  use this array to find stereo-equivalent atoms */
                 pCS->nPrevAtomNumber[rc - 1] = n2; /*  ord. number of the atom having canon. rank = rc */
-                nSymmStereo[i1] = i1;            /*  restart search for stereo equivalent atoms */
+                /*  nSymmStereo is not reset here: stereo equivalence found from
+                 *  equal CTs is a property of the structure, not of the current
+                 *  best CT, and stays valid for pruning the rest of the search;
+                 *  it is reset only on a total restart (bFirstCT) */
                 /* check mapping correctness */
                 if (pRankStack1[0][n1] != pRankStack2[0][n2] ||
                      nSymmRank[n1] != nSymmRank[n2])
@@ -103,6 +103,21 @@ int set_common_options_by_parg( const char *pArg,
                                 int *pbHideInChI );
 
 
+/****************************************************************************
+Returns 1 if pArg is not kept in the options to replay captured records
+with: the capture itself and the selection of input records (a captured
+input is a single record)
+****************************************************************************/
+static int IsNotReplayedOption( const char *pArg )
+{
+    return !inchi_memicmp( pArg, "Capture", 7 ) ||
+           !inchi_memicmp( pArg, "START:", 6 ) ||
+           !inchi_memicmp( pArg, "END:", 4 ) ||
+           !inchi_memicmp( pArg, "RECORD:", 7 ) ||
+           !inchi_stricmp( pArg, "SdfIndex" );
+}
+
+
 /****************************************************************************
 Returns 1 if pArg recognized and treated, 0 otherwise
 ****************************************************************************/
@@ -628,7 +643,7 @@ int ReadCommandLineParms( int argc,
     char szOutNameExt[3][128];
 #endif
 
-    int i, k, c, got;
+    int i, k, c, got, len_opt;
     int timeout_set_warning = 0;
     int timeout_set_error   = 0;
 
@@ -1134,6 +1149,14 @@ int ReadCommandLineParms( int argc,
 
             bRecognizedOption = 2;
             bVer1Options += 2;
+
+            /* keep the options to replay captured records with */
+            len_opt = (int) strlen( ip->szCaptureOptions );
+            if (!IsNotReplayedOption( pArg ) &&
+                 len_opt + strlen( pArg ) + 2 < sizeof( ip->szCaptureOptions ))
+            {
+                sprintf( ip->szCaptureOptions + len_opt, "%s%c%s", len_opt ? " " : "", INCHI_OPTION_PREFX, pArg );
+            }
             /* always on: REQ_MODE_TAUT | REQ_MODE_ISO | REQ_MODE_STEREO */
 
             got = set_common_options_by_parg( pArg, developer_options, ip, &bVer1DefaultMode, &nMode,
@@ -1292,6 +1315,34 @@ int ReadCommandLineParms( int argc,
             {
                 ip->bAllowEmptyStructure = 1;
             }
+            else if (!inchi_stricmp( pArg, "CanonStat" ))
+            {
+                ip->bCanonStat = 1;
+            }
+            else if (!inchi_stricmp( pArg, "MemStat" ))
+            {
+                ip->bMemStat = 1;
+            }
+            else if (!inchi_memicmp( pArg, "CaptureSlow:", 12 ))
+            {
+                ip->msec_CaptureSlow = strtol( pArg + 12, NULL, 10 );
+                if (ip->msec_CaptureSlow < 0)
+                {
+                    ip->msec_CaptureSlow = 0;
+                }
+            }
+            else if (!inchi_memicmp( pArg, "CaptureDir:", 11 ))
+            {
+                mystrncpy( ip->szCaptureDir, pArg + 11, sizeof( ip->szCaptureDir ) );
+            }
+            else if (!inchi_stricmp( pArg, "GzThread" ))
+            {
+                ip->bGzThread = 1;
+            }
+            else if (!inchi_stricmp( pArg, "SdfIndex" ))
+            {
+                ip->bSdfIndex = 1;
+            }
             /*--- Conversion modes ---*/
 #if ( READ_INCHI_STRING == 1 )
 
@@ -2572,6 +2623,10 @@ void HelpCommandLineParms( INCHI_IOSTREAM *f )
     inchi_ios_print_nodisplay( f, "  START:n     Start at n-th input structure\n");
     inchi_ios_print_nodisplay( f, "  END:n       Stop after n-th input structure\n");
     inchi_ios_print_nodisplay( f, "  RECORD:n    Treat only n-th input structure\n");
+    inchi_ios_print_nodisplay( f, "  SdfIndex    Go to START:n structure directly using index file <inputFile>.idx\n              (created if missing or outdated)\n" );
+#ifdef INCHI_USE_ZLIB
+    inchi_ios_print_nodisplay( f, "  GzThread    Decompress gzip input file on a separate thread\n              (gzip input is recognized, output files *.gz are compressed)\n" );
+#endif
 
 #if ( BUILD_WITH_AMI == 1 )
     inchi_ios_print_nodisplay(f, "  AMI         Allow multiple input files (wildcards supported)\n");
@@ -2589,6 +2644,10 @@ void HelpCommandLineParms( INCHI_IOSTREAM *f )
     inchi_ios_print_nodisplay( f, "  Tabbed      Separate structure number, %s, and AuxInfo with tabs\n", INCHI_NAME );
     inchi_ios_print_nodisplay( f, "  MergeHash   Combine InChIKey with extra hash(es) if present\n" );
     inchi_ios_print_nodisplay( f, "  NoInChI     Do not print InChI string itself\n" );
+    inchi_ios_print_nodisplay( f, "  CanonStat   Log symmetry group size found by canonicalization\n" );
+    inchi_ios_print_nodisplay( f, "  MemStat     Log peak heap memory used for each structure\n" );
+    inchi_ios_print_nodisplay( f, "  CaptureSlow:n Save input, options and stage timings of structures\n              taking n msec or longer, or timing out\n" );
+    inchi_ios_print_nodisplay( f, "  CaptureDir:path Directory for CaptureSlow files (default: current)\n" );
 #ifndef TARGET_EXE_USING_API
     inchi_ios_print_nodisplay( f, "  OutErrInChI On fail, print empty InChI (default: nothing)\n" );
 #endif
@@ -2625,7 +2684,7 @@ void HelpCommandLineParms( INCHI_IOSTREAM *f )
     inchi_ios_print_nodisplay( f, "Generation\n" );
     inchi_ios_print_nodisplay( f, "  Wnumber     Set time-out per structure in seconds; W0 means unlimited\n" );
     inchi_ios_print_nodisplay( f, "  WMnumber    Set time-out per structure in milliseconds (int); WM0 means unlimited\n" );
-    inchi_ios_print_nodisplay( f, "  LargeMolecules Treat molecules up to 32766 atoms (experimental)\n" );
+    inchi_ios_print_nodisplay( f, "  LargeMolecules Treat molecules up to %d atoms (experimental)\n", MAX_ATOMS );
     inchi_ios_print_nodisplay( f, "  WarnOnEmptyStructure Warn and produce empty %s for empty structure\n", INCHI_NAME );
     /*inchi_ios_print_nodisplay( f, "  MismatchIsError Treat problem/mismatch on inchi2struct conversion as error\n");*/
 
@@ -2700,7 +2759,7 @@ int OpenFiles( FILE **inp_file,
         fprintf2( stderr, "Log file not specified. Using standard error output.\n" );
         *log_file = stderr;
     }
-    else if (!( *log_file = fopen( ip->path[2], "w" ) ))
+    else if (!( *log_file = inchi_fopen( ip->path[2], "w", 0 ) ))
     {
         fprintf2( stderr, "%s %-s\n%-s Build (%-s%-s) of %s %s%-s\n\n",
                     APP_DESCRIPTION, INCHI_SRC_REV,
@@ -2725,11 +2784,12 @@ int OpenFiles( FILE **inp_file,
          ip->num_paths > 0)
     {
         const char *fmode = NULL;
+        int inp_flags = ip->bGzThread ? INCHI_FOPEN_READ_THREAD : 0;
 
 #if ( defined(_MSC_VER)&&defined(_WIN32) || defined(__BORLANDC__)&&defined(__WIN32__) || defined(__GNUC__)&&defined(__MINGW32__)&&defined(_WIN32) )
         /* compilers that definitely allow fopen "rb" (binary read) mode */
         fmode = "rb";
-        if (!ip->path[0] || !ip->path[0][0] || !( *inp_file = fopen( ip->path[0], "rb" ) ))
+        if (!ip->path[0] || !ip->path[0][0] || !( *inp_file = inchi_fopen( ip->path[0], "rb", inp_flags ) ))
         {
             fprintf2( *log_file, "Cannot open input file '%s'. Terminating.\n", ip->path[0] ? ip->path[0] : "<No name>" );
             goto exit_function;
@@ -2741,7 +2801,7 @@ int OpenFiles( FILE **inp_file,
 
 #else
 
-        if (!ip->path[0] || !ip->path[0][0] || !( *inp_file = fopen( ip->path[0], "r" ) ))
+        if (!ip->path[0] || !ip->path[0][0] || !( *inp_file = inchi_fopen( ip->path[0], "r", inp_flags ) ))
         {
             fprintf2( *log_file, "Cannot open input file '%s'. Terminating.\n", ip->path[0] ? ip->path[0] : "<No Name>" );
             goto exit_function;
@@ -2779,7 +2839,7 @@ int OpenFiles( FILE **inp_file,
     }
     else
     {
-        if (!( *out_file = fopen( ip->path[1], "w" ) ))
+        if (!( *out_file = inchi_fopen( ip->path[1], "w", 0 ) ))
         {
             fprintf2( *log_file, "Cannot open output file '%s'. Terminating.\n", ip->path[1] );
             goto exit_function;
@@ -2807,7 +2867,7 @@ int OpenFiles( FILE **inp_file,
         fmode = "wb";
 #endif
 
-        if (!( *prb_file = fopen( ip->path[3], fmode ) ))
+        if (!( *prb_file = inchi_fopen( ip->path[3], fmode, 0 ) ))
         {
             fprintf2( *log_file, "Cannot open problem file '%s'. Terminating.\n", ip->path[3] );
             goto exit_function;
@@ -2916,7 +2976,7 @@ int DetectInputINChIFileType( FILE **inp_file,
     }
 
     fclose( *inp_file );
-    *inp_file = fopen( ip->path[0], fmode );
+    *inp_file = inchi_fopen( ip->path[0], fmode, ip->bGzThread ? INCHI_FOPEN_READ_THREAD : 0 );
 
     return ret;
 }
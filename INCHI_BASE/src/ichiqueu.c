@@ -470,7 +470,7 @@ int DFS_FindTautInARing( struct tagCANON_GLOBALS *pCG,
 {
     /*  Depth First Search */
     /*  Ignore all atoms not belonging to the current ring system (=biconnected component) */
-    AT_RANK      nMinLenDfsPath;
+    int          nMinLenDfsPath;
     int          j, cur_at, nxt_at, prv_at;
     int          nLenDfsPath, nNumFound, ret;
     AT_RANK      nRingSystem;
@@ -628,7 +628,7 @@ int DFS_FindTautAltPath( struct tagCANON_GLOBALS *pCG,
 {
     /*  Naive Depth First Search: same atom may be approached along different alt paths */
     /*  Ignore all atoms not belonging to the current ring system (=biconnected component) */
-    AT_RANK      nMinLenDfsPath;
+    int          nMinLenDfsPath;
     int          j, cur_at, nxt_at, prv_at;
     int          nLenDfsPath, nNumFound, ret;
     AT_RANK      nRingSystem;
@@ -10722,9 +10722,8 @@ int ConvertInChI2InChI( INPUT_PARMS     *ip,
         }
         else
         {
-            char *buf = NULL;
-            size_t slen = pOut->s.nUsedLength;
-            extract_inchi_substring( &buf, pOut->s.pStr, slen );
+            /* hash InChI in place: GetINCHIKeyFromINCHI() stops at its end */
+            const char *buf = pOut->s.pStr && pOut->s.nUsedLength ? strstr( pOut->s.pStr, "InChI=" ) : NULL;
 
             if (NULL != buf)
             {
@@ -10746,7 +10745,6 @@ int ConvertInChI2InChI( INPUT_PARMS     *ip,
                                                ik_string,
                                                szXtra1,
                                                szXtra2 );
-                inchi_free( buf );
             }
             else
             {
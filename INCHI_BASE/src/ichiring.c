@@ -32,6 +32,9 @@
  */
 
 
+#include <string.h>
+#include <limits.h>
+
 #include "mode.h"
 #include "ichiring.h"
 
@@ -408,6 +411,139 @@ int is_bond_in_Nmax_memb_ring( inp_ATOM* atom,
 }
 
 
+/****************************************************************************
+  Bond ring size cache
+****************************************************************************/
+int BondRingCacheCreate( BOND_RING_CACHE *pRC, int num_at )
+{
+    memset( pRC, 0, sizeof( *pRC ) );
+    if (num_at <= 0)
+    {
+        return 0;
+    }
+    pRC->nNeigh = (AT_NUMB *) inchi_calloc( (size_t) num_at * MAXVAL, sizeof( pRC->nNeigh[0] ) );
+    pRC->cRingSize = (S_CHAR *) inchi_calloc( (size_t) num_at * MAXVAL, sizeof( pRC->cRingSize[0] ) );
+    if (!pRC->nNeigh || !pRC->cRingSize)
+    {
+        BondRingCacheFree( pRC );
+        return -1;
+    }
+    pRC->num_at = num_at;
+
+    return 0;
+}
+
+
+/****************************************************************************/
+void BondRingCacheFree( BOND_RING_CACHE *pRC )
+{
+    if (pRC->nNeigh)
+    {
+        inchi_free( pRC->nNeigh );
+    }
+    if (pRC->cRingSize)
+    {
+        inchi_free( pRC->cRingSize );
+    }
+    memset( pRC, 0, sizeof( *pRC ) );
+}
+
+
+/****************************************************************************/
+void BondRingCacheClear( BOND_RING_CACHE *pRC )
+{
+    if (pRC->nNeigh)
+    {
+        memset( pRC->nNeigh, 0, (size_t) pRC->num_at * MAXVAL * sizeof( pRC->nNeigh[0] ) );
+    }
+}
+
+
+/****************************************************************************
+  Find the cache slot of the bond at_no-neigh; create it if requested
+****************************************************************************/
+static S_CHAR *BondRingCacheSlot( BOND_RING_CACHE *pRC, int at_no, int neigh, int bCreate )
+{
+    int      i;
+    AT_NUMB *nNeigh = pRC->nNeigh + at_no * MAXVAL;
+
+    for (i = 0; i < MAXVAL && nNeigh[i]; i++)
+    {
+        if ((int) nNeigh[i] == neigh + 1)
+        {
+            return pRC->cRingSize + at_no * MAXVAL + i;
+        }
+    }
+    if (bCreate && i < MAXVAL)
+    {
+        nNeigh[i] = (AT_NUMB) ( neigh + 1 );
+        pRC->cRingSize[at_no * MAXVAL + i] = 0;
+        return pRC->cRingSize + at_no * MAXVAL + i;
+    }
+
+    return NULL;
+}
+
+
+/****************************************************************************
+  Same as is_bond_in_Nmax_memb_ring() but keeps the results in pRC
+  so that each bond is traversed by BFS at most once per max. ring size.
+  pRC == NULL or empty pRC => no caching
+****************************************************************************/
+int is_bond_in_Nmax_memb_ring_cached( inp_ATOM* atom,
+                                      int at_no,
+                                      int neigh_ord,
+                                      QUEUE *q,
+                                      AT_RANK *nAtomLevel,
+                                      S_CHAR *cSource,
+                                      AT_RANK nMaxRingSize,
+                                      BOND_RING_CACHE *pRC )
+{
+    int     neigh, nMinRingSize;
+    S_CHAR *pSize1, *pSize2;
+
+    if (!pRC || !pRC->nNeigh || at_no >= pRC->num_at ||
+         ( neigh = (int) atom[at_no].neighbor[neigh_ord] ) >= pRC->num_at)
+    {
+        return is_bond_in_Nmax_memb_ring( atom, at_no, neigh_ord, q, nAtomLevel, cSource, nMaxRingSize );
+    }
+    if (nMaxRingSize < 3)
+    {
+        return 0;
+    }
+
+    pSize1 = BondRingCacheSlot( pRC, at_no, neigh, 0 );
+    if (pSize1 && *pSize1 > 0)
+    {
+        return ( *pSize1 < (int) nMaxRingSize ) ? *pSize1 : 0;
+    }
+    if (pSize1 && *pSize1 < 0 && (int) nMaxRingSize <= -*pSize1)
+    {
+        return 0;
+    }
+
+    nMinRingSize = is_bond_in_Nmax_memb_ring( atom, at_no, neigh_ord, q, nAtomLevel, cSource, nMaxRingSize );
+    if (nMinRingSize < 0 || nMinRingSize > SCHAR_MAX ||
+         ( !nMinRingSize && nMaxRingSize > SCHAR_MAX ))
+    {
+        return nMinRingSize; /* error or not representable */
+    }
+
+    pSize1 = BondRingCacheSlot( pRC, at_no, neigh, 1 );
+    pSize2 = BondRingCacheSlot( pRC, neigh, at_no, 1 );
+    if (pSize1)
+    {
+        *pSize1 = (S_CHAR) ( nMinRingSize ? nMinRingSize : -(int) nMaxRingSize );
+    }
+    if (pSize2)
+    {
+        *pSize2 = (S_CHAR) ( nMinRingSize ? nMinRingSize : -(int) nMaxRingSize );
+    }
+
+    return nMinRingSize;
+}
+
+
 /****************************************************************************/
 int is_atom_in_3memb_ring( inp_ATOM* atom, int at_no )
 {
@@ -56,6 +56,14 @@ typedef struct tagQieue {
 #endif
 }QUEUE;
 
+/* Smallest ring sizes of bonds already found by is_bond_in_Nmax_memb_ring(); */
+/* valid as long as the connection table of the structure does not change   */
+typedef struct tagBondRingCache {
+    AT_NUMB *nNeigh;     /* [num_at*MAXVAL] neighbor number + 1 of the cached bond; 0 => empty slot */
+    S_CHAR  *cRingSize;  /* [num_at*MAXVAL] n > 0: min. ring size; n < 0: no ring smaller than -n */
+    int      num_at;
+} BOND_RING_CACHE;
+
 #ifndef COMPILE_ALL_CPP
 #ifdef __cplusplus
 extern "C" {
@@ -65,6 +73,10 @@ extern "C" {
     QUEUE *QueueCreate( int nTotLength, int nSize );
     QUEUE *QueueDelete( QUEUE *q );
     int is_bond_in_Nmax_memb_ring( inp_ATOM* atom, int at_no, int neigh_ord, QUEUE *q, AT_RANK *nAtomLevel, S_CHAR *cSource, AT_RANK nMaxRingSize );
+    int BondRingCacheCreate( BOND_RING_CACHE *pRC, int num_at );
+    void BondRingCacheFree( BOND_RING_CACHE *pRC );
+    void BondRingCacheClear( BOND_RING_CACHE *pRC );
+    int is_bond_in_Nmax_memb_ring_cached( inp_ATOM* atom, int at_no, int neigh_ord, QUEUE *q, AT_RANK *nAtomLevel, S_CHAR *cSource, AT_RANK nMaxRingSize, BOND_RING_CACHE *pRC );
     int is_atom_in_3memb_ring( inp_ATOM* atom, int at_no );
 
 #ifndef COMPILE_ALL_CPP
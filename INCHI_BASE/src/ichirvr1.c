@@ -4823,6 +4823,7 @@ int AllocBfsQueue( BFS_Q *pQ, int num_at, int min_ring_size )
             {
                 inchi_free( pQ->cSource );
             }
+            BondRingCacheFree( &pQ->RingCache );
             /* fall through */
         case BFS_Q_CLEAR:
             memset( pQ, 0, sizeof( *pQ ) );
@@ -4843,13 +4844,18 @@ int AllocBfsQueue( BFS_Q *pQ, int num_at, int min_ring_size )
                 pQ->q = QueueCreate( num_at + 1, sizeof( qInt ) );
                 pQ->nAtomLevel = (AT_RANK*) inchi_calloc( sizeof( pQ->nAtomLevel[0] ), num_at );
                 pQ->cSource = (S_CHAR *) inchi_calloc( sizeof( pQ->cSource[0] ), num_at );
-                if (!pQ->q || !pQ->cSource || !pQ->nAtomLevel)
+                if (!pQ->q || !pQ->cSource || !pQ->nAtomLevel ||
+                     BondRingCacheCreate( &pQ->RingCache, num_at ))
                 {
                     ret = RI_ERR_ALLOC;
                     goto exit_function;
                 }
                 pQ->num_at = num_at;
             }
+            else
+            {
+                BondRingCacheClear( &pQ->RingCache ); /* new structure */
+            }
             pQ->min_ring_size = min_ring_size;
     }
 
@@ -455,9 +455,10 @@ int FixFixedHRestoredStructure( CANON_GLOBALS *pCG,
             {
                 if (pBNS->edge[k = pBNS->vert[i].iedge[j]].forbidden == forbidden_stereo_edge_mask)
                 {
-                    int nMinRingSize = is_bond_in_Nmax_memb_ring( at2, i, j, pStruct->pbfsq->q,
+                    int nMinRingSize = is_bond_in_Nmax_memb_ring_cached( at2, i, j, pStruct->pbfsq->q,
                                                                   pStruct->pbfsq->nAtomLevel,
-                                                                  pStruct->pbfsq->cSource, 99 /* max ring size */ );
+                                                                  pStruct->pbfsq->cSource, 99 /* max ring size */,
+                                                                  &pStruct->pbfsq->RingCache );
                     if (0 < nMinRingSize && ( ret = AddToEdgeList( &FixedLargeRingStereoEdges, k, INC_ADD_EDGE ) ))
                     {
                         goto exit_function;
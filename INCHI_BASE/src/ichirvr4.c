@@ -3306,8 +3306,9 @@ int RestoreAtomMakeBNS( INCHI_CLOCK *ic, CANON_GLOBALS *pCG,
         }
         if (at[i].valence == 2 && !at[i].num_H)
         {
-            pVA[i].cMinRingSize = is_bond_in_Nmax_memb_ring( at, i, 0, bfsq.q, bfsq.nAtomLevel,
-                                                             bfsq.cSource, 99 /* max ring size */ );
+            pVA[i].cMinRingSize = is_bond_in_Nmax_memb_ring_cached( at, i, 0, bfsq.q, bfsq.nAtomLevel,
+                                                             bfsq.cSource, 99 /* max ring size */,
+                                                             &bfsq.RingCache );
         }
         else
         {
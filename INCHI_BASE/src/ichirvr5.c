@@ -113,9 +113,10 @@ int bIsUnsatCarbonInASmallRing( inp_ATOM *at2,
         {
             for (j = 0; j < at2[iat].valence; j++)
             {
-                nCurRingSize = is_bond_in_Nmax_memb_ring( at2, iat, j, pbfsq->q,
+                nCurRingSize = is_bond_in_Nmax_memb_ring_cached( at2, iat, j, pbfsq->q,
                                              pbfsq->nAtomLevel,
-                                             pbfsq->cSource, (AT_RANK) nMinRingSize /* max ring size */ );
+                                             pbfsq->cSource, (AT_RANK) nMinRingSize /* max ring size */,
+                                             &pbfsq->RingCache );
                 if (0 < nCurRingSize && nCurRingSize < nMinRingSize)
                 {
                     nMinRingSize = nCurRingSize;
@@ -253,9 +254,10 @@ int FixMobileHRestoredStructure( CANON_GLOBALS *pCG,
             {
                 if (pBNS->edge[k = pBNS->vert[i].iedge[j]].forbidden == forbidden_stereo_edge_mask)
                 {
-                    int nMinRingSize = is_bond_in_Nmax_memb_ring( at2, i, j, pStruct->pbfsq->q,
+                    int nMinRingSize = is_bond_in_Nmax_memb_ring_cached( at2, i, j, pStruct->pbfsq->q,
                                                              pStruct->pbfsq->nAtomLevel,
-                                                             pStruct->pbfsq->cSource, 99 /* max ring size */ );
+                                                             pStruct->pbfsq->cSource, 99 /* max ring size */,
+                                                             &pStruct->pbfsq->RingCache );
                     if (0 < nMinRingSize && ( ret = AddToEdgeList( &FixedLargeRingStereoEdges, k, INC_ADD_EDGE ) ))
                     {
                         goto exit_function;
@@ -93,6 +93,7 @@ typedef struct tagBfsQueue {
     S_CHAR  *cSource;
     int      num_at;
     AT_RANK  min_ring_size;  /* 8 => detect 7-member and smaller rings */
+    BOND_RING_CACHE RingCache; /* bond ring sizes found so far for the current structure */
 } BFS_Q;
 /**************************************/
 
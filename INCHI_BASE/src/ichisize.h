@@ -35,12 +35,27 @@
 #ifndef _ICHISIZE_H_
 #define _ICHISIZE_H_
 
+/*
+    Atom numbers and ranks are 16-bit by default. Define INCHI_WIDE_AT_NUMB
+    (for all sources of the library or executable) to build a variant with
+    32-bit atom numbers and ranks for structures of up to MAX_ATOMS atoms;
+    inchi_Atom and other API structures are not changed.
+*/
+#ifdef INCHI_WIDE_AT_NUMB
+typedef unsigned int AT_NUMB;
+typedef unsigned int AT_RANK;
+#else
 typedef unsigned short AT_NUMB;
 typedef unsigned short AT_RANK;
+#endif
 #define AT_RANK_MASK   ((AT_RANK)~0)
 
 typedef signed short NUM_H;
+#ifdef INCHI_WIDE_AT_NUMB
+#define MAX_ATOMS  1048574
+#else
 #define MAX_ATOMS  32766
+#endif
 #define NORMALLY_ALLOWED_INP_MAX_ATOMS 1024
 
 
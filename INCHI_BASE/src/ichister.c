@@ -72,6 +72,19 @@
 #define MPY_SINE              3.00
 #define MAX_EDGE_RATIO        6.00   /*  max max/min edge ratio for a tetrahedra close to a parallelogram  */
 #endif
+
+/*  Triple products of several vector triples evaluated in one pass; the   */
+/*  vectors are gathered component-wise into contiguous arrays so that the */
+/*  loop in sine_batch_min_abs() can be vectorized by the compiler         */
+#define MAX_SINE_BATCH        12     /*  4 x 3 triple products in are_4at_in_one_plane() */
+typedef struct tagSineBatch
+{
+    int    n;
+    double ax[MAX_SINE_BATCH], ay[MAX_SINE_BATCH], az[MAX_SINE_BATCH];
+    double bx[MAX_SINE_BATCH], by[MAX_SINE_BATCH], bz[MAX_SINE_BATCH];
+    double cx[MAX_SINE_BATCH], cy[MAX_SINE_BATCH], cz[MAX_SINE_BATCH];
+} SINE_BATCH;
+
 /*  local prototypes */
 static int save_a_stereo_bond( int z_prod, int result_action,
                         int at1, int ord1, AT_NUMB *stereo_bond_neighbor1, S_CHAR *stereo_bond_ord1, S_CHAR *stereo_bond_z_prod1, S_CHAR *stereo_bond_parity1,
@@ -87,7 +100,8 @@ static double* change_sign3( const double a[], double result[] );
 double dot_prod3( const double a[], const double b[] );
 static int dot_prodchar3( const S_CHAR a[], const S_CHAR b[] );
 static double triple_prod( double a[], double b[], double c[], double *sine_value );
-static double triple_prod_and_min_abs_sine( double at_coord[][3], double *min_sine );
+static void sine_batch_add_cyclic( SINE_BATCH *sb, double v[][3] );
+static double sine_batch_min_abs( SINE_BATCH *sb );
 static int are_3_vect_in_one_plane( double at_coord[][3], double min_sine );
 static int triple_prod_char( inp_ATOM *at, int at_1, int i_next_at_1, S_CHAR *z_dir1,
                                            int at_2, int i_next_at_2, S_CHAR *z_dir2 );
@@ -107,11 +121,12 @@ static int can_be_a_stereo_bond_with_isotopic_H( inp_ATOM *at, int cur_at, INCHI
 static int half_stereo_bond_action( int nParity, int bUnknown, int bIsotopic, int vABParityUnknown );
 static int set_stereo_bonds_parity( sp_ATOM *out_at, inp_ATOM *at, int at_1, inp_ATOM *at_removed_H, int num_removed_H,
                                    INCHI_MODE nMode, QUEUE *q, AT_RANK *nAtomLevel,
-                                   S_CHAR *cSource, AT_RANK min_sb_ring_size,
+                                   S_CHAR *cSource, BOND_RING_CACHE *pRingCache,
+                                   AT_RANK min_sb_ring_size,
                                    int bPointedEdgeStereo, int vABParityUnknown );
-static int can_be_a_stereo_atom_with_isotopic_H( inp_ATOM *at, int cur_at, int bPointedEdgeStereo, int bStereoAtZz );
+static int can_be_a_stereo_atom_with_isotopic_H( inp_ATOM *at, int cur_at, int nCenterNumNeigh );
 static int set_stereo_atom_parity( CANON_GLOBALS *pCG, sp_ATOM *out_at, inp_ATOM *at, int cur_at, inp_ATOM *at_removed_H, int num_removed_H,
-                                  int bPointedEdgeStereo, int vABParityUnknown, int LooseTSACheck, int bStereoAtZz );
+                                  int bPointedEdgeStereo, int vABParityUnknown, int LooseTSACheck, int nCenterNumNeigh );
 /*
 int get_opposite_sb_atom( inp_ATOM *at, int cur_atom, int icur2nxt, int *pnxt_atom, int *pinxt2cur, int *pinxt_sb_parity_ord );
 */
@@ -1120,32 +1135,56 @@ double triple_prod_and_min_abs_sine2( double at_coord[][3],
 }
 
 
-/****************************************************************************/
-double triple_prod_and_min_abs_sine( double at_coord[][3], double *min_sine )
+/****************************************************************************
+  Add triples (v0,v1,v2), (v1,v2,v0), (v2,v0,v1) to the batch
+****************************************************************************/
+void sine_batch_add_cyclic( SINE_BATCH *sb, double v[][3] )
 {
-    double min_sine_value = 9999.0, sine_value;
-    double prod = 0.0;
-
-    if (!min_sine)
-    {
-        return triple_prod( at_coord[0], at_coord[1], at_coord[2], NULL );
-    }
-
-    prod = triple_prod( at_coord[0], at_coord[1], at_coord[2], &sine_value );
-    sine_value = fabs( sine_value );
-    min_sine_value = inchi_min( min_sine_value, sine_value );
+    int i, n = sb->n;
+    for (i = 0; i < 3; i++, n++)
+    {
+        sb->ax[n] = v[i][0];
+        sb->ay[n] = v[i][1];
+        sb->az[n] = v[i][2];
+        sb->bx[n] = v[( i + 1 ) % 3][0];
+        sb->by[n] = v[( i + 1 ) % 3][1];
+        sb->bz[n] = v[( i + 1 ) % 3][2];
+        sb->cx[n] = v[( i + 2 ) % 3][0];
+        sb->cy[n] = v[( i + 2 ) % 3][1];
+        sb->cz[n] = v[( i + 2 ) % 3][2];
+    }
+    sb->n = n;
+}
 
-    prod = triple_prod( at_coord[1], at_coord[2], at_coord[0], &sine_value );
-    sine_value = fabs( sine_value );
-    min_sine_value = inchi_min( min_sine_value, sine_value );
 
-    prod = triple_prod( at_coord[2], at_coord[0], at_coord[1], &sine_value );
-    sine_value = fabs( sine_value );
-    min_sine_value = inchi_min( min_sine_value, sine_value );
+/****************************************************************************
+  Min. abs. value of the sine of the angle between c and the (a,b) plane
+  over all triples in the batch. Each sine is computed exactly as
+  triple_prod( a, b, c, &sine_value ) does.
+****************************************************************************/
+double sine_batch_min_abs( SINE_BATCH *sb )
+{
+    double sine[MAX_SINE_BATCH], abx, aby, abz, dot_prod_ab_c, abs_c, abs_ab;
+    double min_sine_value = 9999.0;
+    int i;
 
-    *min_sine = min_sine_value;
+    for (i = 0; i < sb->n; i++)
+    {
+        abx = ( sb->ay[i] * sb->bz[i] - sb->az[i] * sb->by[i] );
+        aby = -( sb->ax[i] * sb->bz[i] - sb->az[i] * sb->bx[i] );
+        abz = ( sb->ax[i] * sb->by[i] - sb->ay[i] * sb->bx[i] );
+        dot_prod_ab_c = abx * sb->cx[i] + aby * sb->cy[i] + abz * sb->cz[i];
+        abs_c = sqrt( sb->cx[i] * sb->cx[i] + sb->cy[i] * sb->cy[i] + sb->cz[i] * sb->cz[i] );
+        abs_ab = sqrt( abx * abx + aby * aby + abz * abz );
+        sine[i] = ( abs_c > 1.e-7 && abs_ab > 1.e-7 ) ? MPY_SINE * dot_prod_ab_c / ( abs_c * abs_ab ) : 0.0;
+    }
+    for (i = 0; i < sb->n; i++)
+    {
+        abs_c = fabs( sine[i] );
+        min_sine_value = inchi_min( min_sine_value, abs_c );
+    }
 
-    return prod;
+    return min_sine_value;
 }
 
 
@@ -1154,12 +1193,12 @@ double triple_prod_and_min_abs_sine( double at_coord[][3], double *min_sine )
 ****************************************************************************/
 int are_3_vect_in_one_plane( double at_coord[][3], double min_sine )
 {
-    double actual_min_sine;
-    double prod;
+    SINE_BATCH sb;
 
-    prod = triple_prod_and_min_abs_sine( at_coord, &actual_min_sine );
+    sb.n = 0;
+    sine_batch_add_cyclic( &sb, at_coord );
 
-    return actual_min_sine <= min_sine;
+    return sine_batch_min_abs( &sb ) <= min_sine;
 }
 
 
@@ -1168,9 +1207,12 @@ int are_3_vect_in_one_plane( double at_coord[][3], double min_sine )
 ****************************************************************************/
 int are_4at_in_one_plane( double at_coord[][3], double min_sine )
 {
-    double actual_min_sine, min_actual_min_sine;
-    double coord[3][3], prod;
+    SINE_BATCH sb;
+    double coord[3][3];
     int i, k, j;
+
+    /*  all 4 faces of the tetrahedra go into one batch */
+    sb.n = 0;
     for (k = 0; k < 4; k++)
     {
         for (i = j = 0; i < 4; i++)
@@ -1181,15 +1223,10 @@ int are_4at_in_one_plane( double at_coord[][3], double min_sine )
                 j++;
             }
         }
-
-        prod = triple_prod_and_min_abs_sine( coord, &actual_min_sine );
-        if (!k || actual_min_sine < min_actual_min_sine)
-        {
-            min_actual_min_sine = actual_min_sine;
-        }
+        sine_batch_add_cyclic( &sb, coord );
     }
 
-    return min_actual_min_sine <= min_sine;
+    return sine_batch_min_abs( &sb ) <= min_sine;
 }
 
 
@@ -2986,6 +3023,7 @@ int set_stereo_bonds_parity( sp_ATOM *out_at,
                              INCHI_MODE nMode, QUEUE *q,
                              AT_RANK *nAtomLevel,
                              S_CHAR *cSource,
+                             BOND_RING_CACHE *pRingCache,
                              AT_RANK min_sb_ring_size,
                              int bPointedEdgeStereo,
                              int vABParityUnknown )
@@ -3378,7 +3416,8 @@ int set_stereo_bonds_parity( sp_ATOM *out_at,
         {
             /*  check min. ring size only if both double bond/cumulene */
             /*  ending atoms belong to the same ring system */
-            j = is_bond_in_Nmax_memb_ring( at, at_1, i_next_at_1, q, nAtomLevel, cSource, min_sb_ring_size );
+            j = is_bond_in_Nmax_memb_ring_cached( at, at_1, i_next_at_1, q, nAtomLevel, cSource,
+                                                  min_sb_ring_size, pRingCache );
             if (j > 0)
             {
                 continue;
@@ -3658,14 +3697,14 @@ int set_stereo_bonds_parity( sp_ATOM *out_at,
 
 /****************************************************************************
  If isotopic H, D, T added, can the atom be a stereo center?
+ nCenterNumNeigh = bCanInpAtomBeAStereoCenter( at, cur_at, ... )
 ****************************************************************************/
 int can_be_a_stereo_atom_with_isotopic_H( inp_ATOM *at,
                                           int cur_at,
-                                          int bPointedEdgeStereo,
-                                          int bStereoAtZz )
+                                          int nCenterNumNeigh )
 {
-    int nNumNeigh;
-    if (( nNumNeigh = bCanInpAtomBeAStereoCenter( at, cur_at, bPointedEdgeStereo, bStereoAtZz ) ) &&
+    int nNumNeigh = nCenterNumNeigh;
+    if (nNumNeigh &&
          at[cur_at].valence + at[cur_at].num_H == nNumNeigh &&
          at[cur_at].num_H <= NUM_H_ISOTOPES
        )
@@ -3680,7 +3719,7 @@ int can_be_a_stereo_atom_with_isotopic_H( inp_ATOM *at,
 #else
 
 /****************************************************************************/
-int can_be_a_stereo_atom_with_isotopic_H( inp_ATOM *at, int cur_at )
+int can_be_a_stereo_atom_with_isotopic_H( inp_ATOM *at, int cur_at, int nCenterNumNeigh )
 {
     int j, ret = 0;
     if (bCanAtomBeAStereoCenter( at[cur_at].elname, at[cur_at].charge, at[cur_at].radical ) &&
@@ -3768,7 +3807,7 @@ int set_stereo_atom_parity( CANON_GLOBALS *pCG,
                             int bPointedEdgeStereo,
                             int vABParityUnknown,
                             int LooseTSACheck,
-                            int bStereoAtZz )
+                            int nCenterNumNeigh ) /* bCanInpAtomBeAStereoCenter() result */
 {
     int    j, k, next_at, num_z, j1, nType, num_explicit_H, tot_num_iso_H, nMustHaveNumNeigh;
     int    num_explicit_iso_H[NUM_H_ISOTOPES + 1];
@@ -3809,7 +3848,7 @@ int set_stereo_atom_parity( CANON_GLOBALS *pCG,
     num_explicit_H = 0;
 
 #if ( NEW_STEREOCENTER_CHECK == 1 )
-    if (!( nMustHaveNumNeigh = bCanInpAtomBeAStereoCenter( at, cur_at, bPointedEdgeStereo, bStereoAtZz ) ) ||
+    if (!( nMustHaveNumNeigh = nCenterNumNeigh ) ||
          at[cur_at].num_H > NUM_H_ISOTOPES)
     {
         goto exit_function;
@@ -4372,6 +4411,8 @@ int set_stereo_parity( CANON_GLOBALS *pCG,
     QUEUE *q = NULL;
     AT_RANK *nAtomLevel = NULL;
     S_CHAR  *cSource = NULL;
+    S_CHAR  *nCenterNumNeigh = NULL;
+    BOND_RING_CACHE RingCache;
     AT_RANK min_sb_ring_size = 0;
 
     /**********************************************************
@@ -4477,13 +4518,29 @@ int set_stereo_parity( CANON_GLOBALS *pCG,
         memset( &at_output[i].stereo_bond_parity2[0], 0, sizeof( at_output[0].stereo_bond_parity2 ) );
     }
 
+    /*  Gather stereocenter candidates in one pass: the element/valence table */
+    /*  lookup is needed both for the estimate and for the parities below     */
+    nCenterNumNeigh = (S_CHAR *) inchi_calloc( (long) num_at + 1, sizeof( nCenterNumNeigh[0] ) );
+    if (!nCenterNumNeigh)
+    {
+        return CT_OUT_OF_RAM;
+    }
+    for (i = 0; i < num_at; i++)
+    {
+#if ( NEW_STEREOCENTER_CHECK == 1 )
+        nCenterNumNeigh[i] = (S_CHAR) bCanInpAtomBeAStereoCenter( at, i, bPointedEdgeStereo, bStereoAtZz );
+#else
+        nCenterNumNeigh[i] = MAX_NUM_STEREO_ATOM_NEIGH;
+#endif
+    }
+
     /*  Estimate max numbers of stereo atoms and bonds if isotopic H are added */
     if (nMaxNumStereoAtoms || nMaxNumStereoBonds)
     {
         for (i = 0, num_stereo = 0; i < num_at; i++)
         {
             int num;
-            num = can_be_a_stereo_atom_with_isotopic_H( at, i, bPointedEdgeStereo, bStereoAtZz );
+            num = can_be_a_stereo_atom_with_isotopic_H( at, i, nCenterNumNeigh[i] );
             if (num)
             {
                 max_stereo_atoms += num;
@@ -4508,6 +4565,7 @@ int set_stereo_parity( CANON_GLOBALS *pCG,
     }
 
     /*  Calculate stereo descriptors */
+    memset( &RingCache, 0, sizeof( RingCache ) );
 #if ( MIN_SB_RING_SIZE > 0 )
     min_sb_ring_size = (AT_RANK) ( ( ( nMode & REQ_MODE_MIN_SB_RING_MASK ) >> REQ_MODE_MIN_SB_RING_SHFT ) & AT_RANK_MASK );
     if (min_sb_ring_size >= 3)
@@ -4516,7 +4574,9 @@ int set_stereo_parity( CANON_GLOBALS *pCG,
         q = QueueCreate( num_at + 1, sizeof( qInt ) );
         nAtomLevel = (AT_RANK*) inchi_calloc( sizeof( nAtomLevel[0] ), num_at );
         cSource = (S_CHAR *) inchi_calloc( sizeof( cSource[0] ), num_at );
-        if (!q || !cSource || !nAtomLevel)
+        /* each ring stereo bond candidate is seen from both ends */
+        BondRingCacheCreate( &RingCache, num_at );
+        if (!q || !cSource || !nAtomLevel || !RingCache.nNeigh)
         {
             num_3D_stereo_atoms = CT_OUT_OF_RAM;
             goto exit_function;
@@ -4532,7 +4592,8 @@ int set_stereo_parity( CANON_GLOBALS *pCG,
     for (i = 0, num_stereo = 0; i < num_at; i++)
     {
         is_stereo = set_stereo_atom_parity( pCG, at_output, at, i, at + num_at, num_removed_H,
-                                            bPointedEdgeStereo, vABParityUnknown, bLooseTSACheck, bStereoAtZz );
+                                            bPointedEdgeStereo, vABParityUnknown, bLooseTSACheck,
+                                            nCenterNumNeigh[i] );
         if (is_stereo)
         {
             num_3D_stereo_atoms += ATOM_PARITY_WELL_DEF( is_stereo );
@@ -4541,7 +4602,7 @@ int set_stereo_parity( CANON_GLOBALS *pCG,
         {
             is_stereo = set_stereo_bonds_parity( at_output, at, i, at + num_at,
                                                  num_removed_H, nMode,q,
-                                                 nAtomLevel, cSource,
+                                                 nAtomLevel, cSource, &RingCache,
                                                  min_sb_ring_size,
                                                  bPointedEdgeStereo,
                                                  vABParityUnknown );
@@ -4573,6 +4634,7 @@ int set_stereo_parity( CANON_GLOBALS *pCG,
     */
 
 #if ( MIN_SB_RING_SIZE > 0 )
+exit_function:
     if (q)
     {
         q = QueueDelete( q );
@@ -4585,10 +4647,11 @@ int set_stereo_parity( CANON_GLOBALS *pCG,
     {
         inchi_free( cSource );
     }
-
-exit_function:
+    BondRingCacheFree( &RingCache );
 #endif
 
+    inchi_free( nCenterNumNeigh );
+
     return num_3D_stereo_atoms;
 }
 
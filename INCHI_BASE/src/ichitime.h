@@ -35,6 +35,16 @@
 #ifndef __ICHITIME_H__
 #define __ICHITIME_H__
 
+/* Clock of the timeouts and processing times (ANSI build):               */
+/*   0 => clock(), CPU time of the whole process: shrinks the time limit  */
+/*        of each structure when several threads calculate InChI at once  */
+/*   1 => CPU time of the calling thread                                  */
+/*   2 => monotonic wall clock time                                       */
+/* 1 and 2 need clock_gettime(); clock() is used where it is missing      */
+#ifndef INCHI_TIMEOUT_CLOCK
+#define INCHI_TIMEOUT_CLOCK 1
+#endif
+
 #ifdef COMPILE_ANSI_ONLY
 
 #ifdef __FreeBSD__
@@ -80,8 +90,13 @@ extern "C" {
         clock_t m_MinNegativeClock;
         clock_t m_HalfMaxPositiveClock;
         clock_t m_HalfMinNegativeClock;
+        volatile int *m_pbCancel;   /* if *m_pbCancel != 0 the time is over; may be set by another thread */
     } INCHI_CLOCK;
 
+    void InchiClockInit( INCHI_CLOCK *ic );
+    void InchiClockSetCancelFlag( volatile int *pbCancel );
+    volatile int *InchiClockGetCancelFlag( void );
+
     void InchiTimeGet( inchiTime *TickEnd );
 
     long InchiTimeMsecDiff( INCHI_CLOCK *ic, inchiTime *TickEnd, inchiTime *TickStart );
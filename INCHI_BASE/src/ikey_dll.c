@@ -113,10 +113,11 @@ int INCHI_DECL GetINCHIKeyFromINCHI( const char* szINCHISource,
     int ret1 = INCHIKEY_OK;
     int cn;
     size_t slen, i, j, jproto = 0, ncp, pos_slash1 = 0;
-    char *str = NULL, *smajor = NULL, *sminor = NULL,
-        *sproto = NULL, *stmp = NULL, tmp[MINOUTLENGTH];
+    const char *str = NULL;
+    char tmp[MINOUTLENGTH];
     unsigned char
         digest_major[32], digest_minor[32];
+    sha2_context ctx;
 
     char flagstd = 'S', /* standard key */
         flagnonstd = 'N', /* non-standard key */
@@ -156,7 +157,12 @@ int INCHI_DECL GetINCHIKeyFromINCHI( const char* szINCHISource,
         return INCHIKEY_EMPTY_INPUT;
     }
 
-    slen = strlen( szINCHISource );
+    /* the source may be followed by anything (e.g. "\nAuxInfo=..."), */
+    /* so do not scan more than needed here                         */
+    for (slen = 0; slen < LEN_INCHI_STRING_PREFIX + 3 && szINCHISource[slen]; slen++)
+    {
+        ;
+    }
 
     /* .. has valid prefix */
     if (slen < LEN_INCHI_STRING_PREFIX + 3)
@@ -209,43 +215,15 @@ int INCHI_DECL GetINCHIKeyFromINCHI( const char* szINCHISource,
         }
     }
 
-    /* Ok. Will use a local copy of the source. */
-
-    extract_inchi_substring( &str, szINCHISource, slen );
-    if (NULL == str)
-    {
-        ret = INCHIKEY_NOT_ENOUGH_MEMORY;
-        goto fin;
-    }
-    slen = strlen( str );
-
+    /* Ok. Will hash the source in place: InChI ends at the first character */
+    /* that may not occur in InChI, see extract_inchi_substring()          */
 
-    /* Make buffers. */
-    smajor = (char*) inchi_calloc( slen + 1, sizeof( char ) );
-    if (NULL == smajor)
-    {
-        ret = INCHIKEY_NOT_ENOUGH_MEMORY; goto fin;
-    }
-    sminor = (char*) inchi_calloc( 2 * slen + 2, sizeof( char ) ); /* we may double the length ... */
-    if (NULL == sminor)
-    {
-        ret = INCHIKEY_NOT_ENOUGH_MEMORY; goto fin;
-    }
-    stmp = (char*) inchi_calloc( slen + 1, sizeof( char ) );
-    if (NULL == stmp)
-    {
-        ret = INCHIKEY_NOT_ENOUGH_MEMORY; goto fin;
-    }
-    sproto = (char*) inchi_calloc( slen + 1, sizeof( char ) );
-    if (NULL == sproto)
-    {
-        ret = INCHIKEY_NOT_ENOUGH_MEMORY; goto fin;
-    }
+    str = szINCHISource;
+    slen = inchi_substring_length( str );
 
     szINCHIKey[0] = '\0';
 
-    /* Extract the major block */
-    smajor[0] = '\0';
+    /* Find the major block */
     for (j = pos_slash1 + 1; j < slen - 1; j++)
     {
         if (str[j] == '/')
@@ -300,9 +278,11 @@ int INCHI_DECL GetINCHIKeyFromINCHI( const char* szINCHISource,
     }
 
 
-    /* Trim 'InChI=1[S]/' */
-    memcpy( smajor, str + pos_slash1 + 1, ncp * sizeof( str[0] ) );
-    smajor[ncp] = '\0';
+    /* Trim 'InChI=1[S]/'; the major block is str[pos_slash1+1...pos_slash1+ncp] */
+    if (ncp > slen - pos_slash1 - 1)
+    {
+        ncp = slen - pos_slash1 - 1; /* no minor block: up to the end of InChI */
+    }
 
 
     /* Treat protonization */
@@ -318,10 +298,8 @@ int INCHI_DECL GetINCHIKeyFromINCHI( const char* szINCHISource,
             goto fin;
         }
 
-        memcpy( sproto, str + pos_slash1 + ncp + 1, lenproto * sizeof( str[0] ) );
-        sproto[lenproto] = '\0';
-
-        nprotons = strtol( sproto + 2, NULL, 10 );
+        /* "/p" segment is str[jproto...j-1]; the number ends at the end of it */
+        nprotons = jproto + 2 < slen ? strtol( str + jproto + 2, NULL, 10 ) : 0;
 
         if (nprotons > 0)
         {
@@ -353,25 +331,9 @@ int INCHI_DECL GetINCHIKeyFromINCHI( const char* szINCHISource,
         }
     }
 
-    /* Extract the minor block. */
-
-    if (j != slen + 1)    /* check that something exists at right.*/
-    {
-        ncp = slen - j;
-        memcpy( sminor, str + j, ( ncp ) * sizeof( str[0] ) );
-        sminor[ncp] = '\0';
-    }
-    else
-    {
-        sminor[0] = '\0';
-    }
-
-
 #if INCHIKEY_DEBUG
-    ITRACE_( "Source:  {%-s}\n", str );
-    ITRACE_( "SMajor:  {%-s}\n", smajor );
-    ITRACE_( "SMinor:  {%-s}\n", sminor );
-    ITRACE_( "SProto:  {%-s}\n", sproto );
+    ITRACE_( "Source:  {%-.*s}\n", (int) slen, str );
+    ITRACE_( "SMajor:  {%-.*s}\n", (int) ncp, str + pos_slash1 + 1 );
 #endif
 
     /* Compute and compose the InChIKey string. */
@@ -382,7 +344,7 @@ int INCHI_DECL GetINCHIKeyFromINCHI( const char* szINCHISource,
         digest_major[i] = 0;
     }
 
-    sha2_csum( (unsigned char *) smajor, (int) strlen( smajor ), digest_major );
+    sha2_csum( (unsigned char *) str + pos_slash1 + 1, (int) ncp, digest_major );
 
     sprintf( tmp, "%-.3s%-.3s%-.3s%-.3s%-.2s",
              base26_triplet_1( digest_major ), base26_triplet_2( digest_major ),
@@ -394,19 +356,24 @@ int INCHI_DECL GetINCHIKeyFromINCHI( const char* szINCHISource,
 #endif
 
 
-    /* Minor hash sub-string. */
+    /* Minor hash sub-string: str[j...slen-1], if anything exists at right */
     for (i = 0; i < 32; i++)
     {
         digest_minor[i] = 0;
     }
-    slen = strlen( sminor );
-    if (( slen > 0 ) && ( slen < 255 ))
+    ncp = ( j != slen + 1 ) ? slen - j : 0;
+
+    sha2_starts( &ctx );
+    if (ncp > 0)
     {
-        strcpy( stmp, sminor );
-        strcpy( sminor + slen, stmp );
+        sha2_update( &ctx, (unsigned char *) str + j, (int) ncp );
+        if (ncp < 255)
+        {
+            /* a short minor block is hashed doubled */
+            sha2_update( &ctx, (unsigned char *) str + j, (int) ncp );
+        }
     }
-
-    sha2_csum( (unsigned char *) sminor, (int) strlen( sminor ), digest_minor );
+    sha2_finish( &ctx, digest_minor );
 
 #if (INCHIKEY_DEBUG>1)
     fprint_digest( stderr, "Minor hash, full SHA-256", digest_minor );
@@ -469,26 +436,6 @@ int INCHI_DECL GetINCHIKeyFromINCHI( const char* szINCHISource,
 
 
 fin:
-    if (NULL != str)
-    {
-        inchi_free( str );
-    }
-    if (NULL != smajor)
-    {
-        inchi_free( smajor );
-    }
-    if (NULL != sminor)
-    {
-        inchi_free( sminor );
-    }
-    if (NULL != stmp)
-    {
-        inchi_free( stmp );
-    }
-    if (NULL != sproto)
-    {
-        inchi_free( sproto );
-    }
     if (( ret == INCHIKEY_OK ) && ( ret1 != INCHIKEY_OK ))
     {
         ret = ret1;
@@ -35,6 +35,7 @@
 #ifndef _INHCH_API_H_
 #define _INHCH_API_H_
 
+#include <stdio.h>
 
 #ifndef FIND_RING_SYSTEMS
 #define FIND_RING_SYSTEMS 1
@@ -957,6 +958,34 @@ Output:
 
 
 
+/*^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+Get_inchi_Input_FromAuxInfoBatch
+
+    Same as Get_inchi_Input_FromAuxInfo applied to each of num_records
+    strings szInchiAuxInfo[0..num_records-1], the records being
+    distributed among num_threads threads inside the library
+    (num_threads <= 0 => number of processors).
+
+    pInchiInp[i]    receives the structure of szInchiAuxInfo[i]; its pInp
+                    should point to an empty inchi_Input as for
+                    Get_inchi_Input_FromAuxInfo; free with Free_inchi_Input()
+    retcodes[i]     (optional, may be NULL) receives the return code
+                    of Get_inchi_Input_FromAuxInfo for szInchiAuxInfo[i]
+
+    Returns the number of records with inchi_Ret_OKAY or inchi_Ret_WARNING
+    or -1 on invalid parameters.
+
+^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^*/
+    EXPIMP_TEMPLATE INCHI_API int INCHI_DECL Get_inchi_Input_FromAuxInfoBatch( int num_records,
+                                                            char **szInchiAuxInfo,
+                                                            int bDoNotAddH,
+                                                            int bDiffUnkUndfStereo,
+                                                            InchiInpData *pInchiInp,
+                                                            int *retcodes,
+                                                            int num_threads );
+
+
+
     /*^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
     Free_inchi_Input / Free_std_inchi_Input
 
@@ -1279,6 +1308,30 @@ typedef struct tagINCHIGEN_DATA
 typedef void* INCHIGEN_HANDLE;
 
 
+/* Pooled InChI generators (see INCHIGEN_POOL_Create) */
+
+/* Last stage passed by a pooled job */
+#define INCHIGEN_STAGE_NONE     0   /* acquired, waiting for Setup */
+#define INCHIGEN_STAGE_SETUP    1
+#define INCHIGEN_STAGE_NORM     2
+#define INCHIGEN_STAGE_CANON    3
+#define INCHIGEN_STAGE_DONE     4   /* serialized or failed; see nRetCode */
+#define INCHIGEN_NUM_STAGES     5
+
+typedef struct tagINCHIGEN_JOB
+{
+    INCHIGEN_HANDLE HGen;           /* generator owned by the pool */
+    INCHIGEN_DATA   GenData;        /* its intermediate data */
+    inchi_Output    Output;         /* result after INCHIGEN_STAGE_DONE */
+    inchi_Input    *pInp;           /* caller's input, used by Setup stage */
+    int             nStage;         /* INCHIGEN_STAGE_* passed so far */
+    int             nRetCode;       /* worst return code of the stages run */
+    void           *pUserData;      /* caller's data, not touched */
+} INCHIGEN_JOB;
+
+typedef void* INCHIGEN_POOL_HANDLE;
+
+
 
 
 /* EXPORTED FUNCTIONS */
@@ -1386,6 +1439,82 @@ EXPIMP_TEMPLATE INCHI_API void INCHI_DECL INCHIGEN_Destroy( INCHIGEN_HANDLE HGen
 EXPIMP_TEMPLATE INCHI_API void INCHI_DECL STDINCHIGEN_Destroy( INCHIGEN_HANDLE HGen );
 
 
+/*^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+INCHIGEN_POOL_Create, INCHIGEN_POOL_Acquire, INCHIGEN_POOL_Submit,
+INCHIGEN_POOL_Next, INCHIGEN_POOL_DoNextStage, INCHIGEN_POOL_Release,
+INCHIGEN_POOL_Close, INCHIGEN_POOL_Destroy
+
+    Bounded pool of InChI generators for pipelined processing.
+
+    All per-structure state of a generator lives in its handle and in
+    INCHIGEN_DATA, so a structure may pass from one thread to another
+    between stages, provided only one thread works on it at a time.
+    The pool packs a generator, its data and its output into an
+    INCHIGEN_JOB and keeps one FIFO queue per stage, so that separate
+    worker pools may run Setup/normalization, canonicalization and
+    serialization of different structures concurrently.
+
+    INCHIGEN_POOL_Create( num_jobs )
+        Creates num_jobs generators (2 per CPU if num_jobs <= 0).
+        Returns NULL on failure.
+
+    INCHIGEN_POOL_Acquire( pool, bWait )
+        Returns a free job with nStage = INCHIGEN_STAGE_NONE. When all
+        jobs are in use it blocks (bWait != 0) or returns NULL, which
+        limits the number of structures in flight (back-pressure).
+        Also returns NULL after INCHIGEN_POOL_Close.
+
+    INCHIGEN_POOL_Submit( pool, job )
+        Queues the job behind the stage given by job->nStage.
+        Returns 0, or -1 if the job does not belong to the pool.
+
+    INCHIGEN_POOL_Next( pool, nStage, bWait )
+        Removes and returns the oldest job queued with job->nStage equal
+        to nStage. Returns NULL if there is none and bWait == 0, or once
+        the pool is closed and no job can reach nStage any more.
+
+    INCHIGEN_POOL_DoNextStage( job )
+        Runs the stage following job->nStage (INCHIGEN_Setup with
+        job->pInp, then normalization, canonicalization, serialization)
+        in the calling thread and advances job->nStage. A failed stage
+        advances it directly to INCHIGEN_STAGE_DONE.
+        Returns the stage return code, or inchi_Ret_WARNING if an earlier
+        stage has issued a warning; also stored in job->nRetCode.
+
+    INCHIGEN_POOL_Release( pool, job )
+        Resets the generator, frees job->Output and returns the job to
+        the pool. Copy the results out before releasing.
+
+    INCHIGEN_POOL_Close( pool )
+        Marks the end of input: wakes all waiting threads so that each
+        stage drains its queue and then gets NULL from INCHIGEN_POOL_Next.
+
+    INCHIGEN_POOL_Destroy( pool )
+        Frees the pool; all jobs should have been released.
+
+    Typical use: the reader thread calls Acquire, sets job->pInp and
+    Submits; a worker pool per stage loops on Next( pool, stage, 1 ),
+    DoNextStage and Submit; the writer thread loops on
+    Next( pool, INCHIGEN_STAGE_DONE, 1 ), stores job->Output and Releases.
+    INCHIGEN_POOL_DoNextStage may of course be called several times in a
+    row by one thread to merge adjacent stages.
+
+^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^*/
+EXPIMP_TEMPLATE INCHI_API INCHIGEN_POOL_HANDLE INCHI_DECL INCHIGEN_POOL_Create( int num_jobs );
+EXPIMP_TEMPLATE INCHI_API INCHIGEN_JOB * INCHI_DECL INCHIGEN_POOL_Acquire( INCHIGEN_POOL_HANDLE pool,
+                                                                           int bWait );
+EXPIMP_TEMPLATE INCHI_API int INCHI_DECL INCHIGEN_POOL_Submit( INCHIGEN_POOL_HANDLE pool,
+                                                               INCHIGEN_JOB *job );
+EXPIMP_TEMPLATE INCHI_API INCHIGEN_JOB * INCHI_DECL INCHIGEN_POOL_Next( INCHIGEN_POOL_HANDLE pool,
+                                                                        int nStage,
+                                                                        int bWait );
+EXPIMP_TEMPLATE INCHI_API int INCHI_DECL INCHIGEN_POOL_DoNextStage( INCHIGEN_JOB *job );
+EXPIMP_TEMPLATE INCHI_API void INCHI_DECL INCHIGEN_POOL_Release( INCHIGEN_POOL_HANDLE pool,
+                                                                 INCHIGEN_JOB *job );
+EXPIMP_TEMPLATE INCHI_API void INCHI_DECL INCHIGEN_POOL_Close( INCHIGEN_POOL_HANDLE pool );
+EXPIMP_TEMPLATE INCHI_API void INCHI_DECL INCHIGEN_POOL_Destroy( INCHIGEN_POOL_HANDLE pool );
+
+
 /*^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 MakeINCHIFromMolfileText
 
@@ -1397,6 +1526,195 @@ EXPIMP_TEMPLATE INCHI_API int INCHI_DECL MakeINCHIFromMolfileText( const char *m
                                                                    inchi_Output *result );
 
 
+/*^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+MakeINCHIFromMolfileTextBatch
+
+    Same as MakeINCHIFromMolfileText applied to each of num_records
+    Molfiles moltexts[0..num_records-1] with the same options, the records
+    being distributed among num_threads threads inside the library
+    (num_threads <= 0 => number of processors). Intended for bindings
+    which may release their interpreter lock for the whole batch.
+
+    results[i]      receives the output for moltexts[i]; each one
+                    should be freed with FreeINCHI() after use
+    retcodes[i]     (optional, may be NULL) receives the return code
+                    of MakeINCHIFromMolfileText for moltexts[i]
+    szINCHIKeys     (optional, may be NULL) buffer of
+                    num_records*INCHI_BATCH_KEY_LEN chars; InChIKey of
+                    moltexts[i] is placed at szINCHIKeys+i*INCHI_BATCH_KEY_LEN
+                    (empty string if no InChI or key was created)
+
+    Returns the number of records for which InChI has been created
+    or -1 on invalid parameters.
+
+^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^*/
+#define INCHI_BATCH_KEY_LEN 28  /* 27 chars of InChIKey + zero terminator */
+
+EXPIMP_TEMPLATE INCHI_API int INCHI_DECL MakeINCHIFromMolfileTextBatch( int num_records,
+                                                                        const char **moltexts,
+                                                                        char *options,
+                                                                        inchi_Output *results,
+                                                                        int *retcodes,
+                                                                        char *szINCHIKeys,
+                                                                        int num_threads );
+
+
+/*^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+MakeINCHIFromMolfileTextWithSdfFields / MakeINCHIFromMolfileTextBatchWithSdfFields
+
+    Same as MakeINCHIFromMolfileText / MakeINCHIFromMolfileTextBatch,
+    SD file record(s) being supplied as text; in addition, the SDF data
+    items "> <label>" requested in szSdfFields are extracted while the
+    record is being parsed.
+
+    szSdfFields         labels of the requested data items separated by
+                        commas or semicolons, e.g. "ID;CAS_NUMBER";
+                        case-insensitive; "*" requests all items
+    *pszSdfFieldValues  receives a buffer of zero-terminated strings
+                        label, value, label, value, ..., followed by an
+                        extra zero, for the requested items found in the
+                        record, in order of appearance; lines of a multi-line
+                        value are joined with '\n'. NULL if none is found.
+                        Should be freed with FreeINCHISdfFieldValues().
+    pszSdfFieldValues[i] (batch) the same for moltexts[i]
+
+    The result cache (SetINCHIResultCacheSize) is bypassed when SDF data
+    are requested.
+
+^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^*/
+EXPIMP_TEMPLATE INCHI_API int INCHI_DECL MakeINCHIFromMolfileTextWithSdfFields( const char *moltext,
+                                                                                char *options,
+                                                                                const char *szSdfFields,
+                                                                                inchi_Output *result,
+                                                                                char **pszSdfFieldValues );
+EXPIMP_TEMPLATE INCHI_API int INCHI_DECL MakeINCHIFromMolfileTextBatchWithSdfFields( int num_records,
+                                                                                     const char **moltexts,
+                                                                                     char *options,
+                                                                                     const char *szSdfFields,
+                                                                                     inchi_Output *results,
+                                                                                     int *retcodes,
+                                                                                     char *szINCHIKeys,
+                                                                                     char **pszSdfFieldValues,
+                                                                                     int num_threads );
+EXPIMP_TEMPLATE INCHI_API void INCHI_DECL FreeINCHISdfFieldValues( char *szSdfFieldValues );
+
+
+/*^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+OpenINCHIFile
+
+    Open a file the way inchi-1 opens its input and output files:
+    gzip-compressed input is recognized by its content and decompressed,
+    output files named *.gz are gzip-compressed (if the library has been
+    built with zlib; otherwise this is plain fopen()). Large stdio
+    buffers are used.
+
+    szFileName      file name
+    szMode          fopen() mode, e.g. "rb" or "w"
+    bReadThread     if non-zero, decompress input on a separate thread
+                    (glibc only)
+
+    Returns FILE* to be closed with fclose(), or NULL on error.
+
+^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^*/
+EXPIMP_TEMPLATE INCHI_API FILE * INCHI_DECL OpenINCHIFile( const char *szFileName,
+                                                           const char *szMode,
+                                                           int bReadThread );
+
+
+/*^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+GetINCHIMultiFlavour / MakeINCHIFromMolfileTextMultiFlavour
+
+    Several InChI flavours of one structure, e.g. Standard InChI and
+    non-standard InChI with "-FixedH -RecMet", at the cost of about one
+    GetINCHI / MakeINCHIFromMolfileText call.
+
+    szOptions[i]    options of flavour i (NULL pointer or NULL
+                    string => no options); inp->szOptions is ignored
+    outputs[i]      receives the output of flavour i; each one
+                    should be freed with FreeINCHI() after use
+    retcodes[i]     (optional, may be NULL) receives the return code
+    szINCHIKeys     (optional, may be NULL) buffer of
+                    num_flavours*INCHI_BATCH_KEY_LEN chars; InChIKey of
+                    flavour i is placed at szINCHIKeys+i*INCHI_BATCH_KEY_LEN
+                    (empty string if no InChI or key was created)
+
+    Option sets which differ only in FixedH and/or RecMet share one pass
+    made with the union of these options; InChI and AuxInfo of the other
+    flavours of such a group are cut out of its output. The return code,
+    szMessage and szLog of a cut flavour are those of the shared pass and
+    may report warnings which concern the cut layers only (for instance,
+    undefined stereo omitted in a Reconnected layer). Other option sets
+    are processed separately, and so are flavours which would be cut out
+    of a structure with identical components (e.g. "2C2H4O2") when
+    AuxInfo is produced: the numbering of such components in AuxInfo
+    depends on the options of the pass.
+
+    Returns the number of flavours for which InChI has been created
+    or -1 on invalid parameters.
+
+^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^*/
+EXPIMP_TEMPLATE INCHI_API int INCHI_DECL GetINCHIMultiFlavour( inchi_Input *inp,
+                                                               int num_flavours,
+                                                               char **szOptions,
+                                                               inchi_Output *outputs,
+                                                               int *retcodes,
+                                                               char *szINCHIKeys );
+EXPIMP_TEMPLATE INCHI_API int INCHI_DECL MakeINCHIFromMolfileTextMultiFlavour( const char *moltext,
+                                                                               int num_flavours,
+                                                                               char **szOptions,
+                                                                               inchi_Output *outputs,
+                                                                               int *retcodes,
+                                                                               char *szINCHIKeys );
+
+
+/*^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+SetINCHIResultCacheSize / GetINCHIResultCacheStats
+
+    Optional process-wide cache of results of GetINCHI, GetStdINCHI,
+    GetINCHIEx (no polymer/V3000 data) and MakeINCHIFromMolfileText.
+
+    A repeated call with the identical input structure (or Molfile text)
+    and identical options string returns a copy of the stored output.
+    Only successful results (inchi_Ret_OKAY/inchi_Ret_WARNING) are stored.
+    The cache is thread-safe and bounded; least recently used entries
+    are evicted. It is off by default.
+
+    SetINCHIResultCacheSize( max_entries )
+        max_entries > 0 enables (or resizes) the cache, 0 disables it;
+        all stored results are dropped in either case.
+        Returns actual capacity or -1 on memory allocation failure.
+
+    GetINCHIResultCacheStats( &hits, &misses, &num_entries )
+        Counters since the last SetINCHIResultCacheSize(); NULL pointers
+        are allowed.
+
+^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^*/
+EXPIMP_TEMPLATE INCHI_API int INCHI_DECL SetINCHIResultCacheSize( int max_entries );
+EXPIMP_TEMPLATE INCHI_API void INCHI_DECL GetINCHIResultCacheStats( unsigned long *hits,
+                                                                    unsigned long *misses,
+                                                                    int *num_entries );
+
+
+/*^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+SetINCHICancelFlag
+
+    Registers *pbCancel as the cancellation flag of InChI calculations
+    started afterwards by the calling thread (NULL removes it).
+
+    When another thread - e.g. a watchdog enforcing deadlines - sets
+    *pbCancel to non-zero, the calculation in progress stops at its next
+    time limit check (in BNS normalization, base ranking,
+    canonicalization or stereo mapping) as if its time limit were
+    exceeded. Steps without such checks, e.g. input parsing or output,
+    are not interrupted.
+    MakeINCHIFromMolfileTextBatch passes the caller's flag on to its
+    threads; records not yet started when it is set get
+    mol2inchi_Ret_ERROR.
+
+^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^*/
+EXPIMP_TEMPLATE INCHI_API void INCHI_DECL SetINCHICancelFlag( volatile int *pbCancel );
+
+
 #ifndef COMPILE_ALL_CPP
 #ifdef __cplusplus
 }
@@ -506,6 +506,7 @@ int CreateOrigInpDataFromMolfile( INCHI_IOSTREAM  *inp_file,
                                     int			   treat_NPZz,
                                     const char     *pSdfLabel,
                                     char           *pSdfValue,
+                                    SDF_FIELDS     *sdf_fields,
                                     unsigned long   *lSdfId,
                                     long           *lMolfileNumber,
                                     INCHI_MODE     *pInpAtomFlags,
@@ -1126,6 +1126,31 @@ do {\
 
 #else /* not TARGET_EXE_USING_API */
 
+/* Per-thread heap accounting behind the MemStat option needs the size  */
+/* of an allocated block; set INCHI_MEM_STAT to 0 where it is missing   */
+#ifndef INCHI_MEM_STAT
+#if ( defined(__linux__) || defined(_WIN32) || defined(__APPLE__) )
+#define INCHI_MEM_STAT 1
+#else
+#define INCHI_MEM_STAT 0
+#endif
+#endif
+
+#if ( INCHI_MEM_STAT == 1 )
+#ifndef inchi_malloc
+#define inchi_malloc   inchi_mem_malloc
+#endif
+#ifndef inchi_calloc
+#define inchi_calloc   inchi_mem_calloc
+#endif
+#ifndef inchi_free
+#define inchi_free(X)  do{ if(X) inchi_mem_free(X); }while(0)
+#endif
+void *inchi_mem_malloc( size_t c );
+void *inchi_mem_calloc( size_t c, size_t n );
+void inchi_mem_free( void *p );
+#endif
+
 #ifndef inchi_malloc
 #define inchi_malloc   malloc
 #endif
@@ -1138,6 +1163,19 @@ do {\
 
 #endif /* TARGET_EXE_USING_API */
 
+/* MemStat: peak of heap bytes allocated by this thread between the calls */
+void inchi_mem_stat_begin( void );
+long inchi_mem_stat_end( void );
+
+/* thread-local storage class */
+#ifndef INCHI_THREAD_LOCAL
+#if defined(_MSC_VER)
+#define INCHI_THREAD_LOCAL __declspec(thread)
+#else
+#define INCHI_THREAD_LOCAL __thread
+#endif
+#endif
+
 /* allocation/deallocation */
 #define USE_ALLOCA 0
 
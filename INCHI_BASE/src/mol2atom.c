@@ -63,6 +63,7 @@ int ReadMolfileToInpAtoms( INCHI_IOSTREAM *inp_file,
                            int *num_bonds,
                            const char *pSdfLabel,
                            char *pSdfValue,
+                           SDF_FIELDS *sdf_fields,
                            unsigned long *Id,
                            long *lMolfileNumber,
                            INCHI_MODE *pInpAtomFlags,
@@ -107,6 +108,7 @@ int CreateOrigInpDataFromMolfile( INCHI_IOSTREAM *inp_file,
                                   int treat_NPZz, 
                                   const char *pSdfLabel,
                                   char *pSdfValue,
+                                  SDF_FIELDS *sdf_fields,
                                   unsigned long *lSdfId,
                                   long *lMolfileNumber,
                                   INCHI_MODE *pInpAtomFlags,
@@ -153,7 +155,7 @@ int CreateOrigInpDataFromMolfile( INCHI_IOSTREAM *inp_file,
                                                    &polymer, &v3000,
                                                    treat_polymers, treat_NPZz,
                                                    max_num_at, &num_dimensions_new, &num_inp_bonds_new,
-                                                   pSdfLabel, pSdfValue, lSdfId, lMolfileNumber,
+                                                   pSdfLabel, pSdfValue, sdf_fields, lSdfId, lMolfileNumber,
                                                    pInpAtomFlags, err, pStrErr, bNoWarnings );
 
 
@@ -316,6 +318,7 @@ int ReadMolfileToInpAtoms( INCHI_IOSTREAM *inp_file,
                            int *num_bonds,
                            const char *pSdfLabel,
                            char *pSdfValue,
+                           SDF_FIELDS *sdf_fields,
                            unsigned long *Id,
                            long *lMolfileNumber,
                            INCHI_MODE *pInpAtomFlags,
@@ -362,7 +365,7 @@ int ReadMolfileToInpAtoms( INCHI_IOSTREAM *inp_file,
     mfdata = ReadMolfile( inp_file, pOnlyHeaderBlock, pOnlyCTab, NULL != szCoord,
                           treat_polymers, treat_NPZz,
                           NULL, 0,
-                          Id, pSdfLabel, pSdfValue, err, pStrErr, bNoWarnings );
+                          Id, pSdfLabel, pSdfValue, sdf_fields, err, pStrErr, bNoWarnings );
 
     pHdr = ( mfdata && !pOnlyHeaderBlock )
         ? &mfdata->hdr
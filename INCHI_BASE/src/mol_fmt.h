@@ -83,6 +83,19 @@
 #define MOL_FMT_JUMP_TO_RIGHT  'J'
 #define MOL_FMT_INT_DATA       'I'
 
+/* bond atom numbers; wide with INCHI_WIDE_AT_NUMB to allow V3000 ctabs over 32767 atoms */
+#ifdef INCHI_WIDE_AT_NUMB
+typedef int   MOL_FMT_AT_NUM;
+#define MOL_FMT_AT_NUM_DATA    MOL_FMT_INT_DATA
+#define MOL_FMT_AT_NUM_MIN     INT_MIN
+#define MOL_FMT_AT_NUM_MAX     INT_MAX
+#else
+typedef short MOL_FMT_AT_NUM;
+#define MOL_FMT_AT_NUM_DATA    MOL_FMT_SHORT_INT_DATA
+#define MOL_FMT_AT_NUM_MIN     SHRT_MIN
+#define MOL_FMT_AT_NUM_MAX     SHRT_MAX
+#endif
+
 #define MOL_FMT_MAX_VALUE_LEN  32    /* max length of string containing a numerical value */
 
 #define MOL_FMT_M_STY_NON 0
@@ -283,8 +296,8 @@ typedef struct A_MOL_FMT_ATOM
 
 typedef struct A_MOL_FMT_BOND
 {
-    short atnum1;                           /* 111: First atom number: Generic  */
-    short atnum2;                           /* 222: Second atom number:Generic  */
+    MOL_FMT_AT_NUM atnum1;                  /* 111: First atom number: Generic  */
+    MOL_FMT_AT_NUM atnum2;                  /* 222: Second atom number:Generic  */
     char  bond_type;                        /* ttt:                             */
                                             /* 1,2,3=single, double, triple;    */
                                             /* 4=aromatic;                      */
@@ -390,6 +403,23 @@ typedef struct A_MOL_FMT_DATA
 } MOL_FMT_DATA;
 
 
+/*
+    SDF data items requested by the caller and their values,
+    collected while the data block of a record is being read
+*/
+typedef struct tagSdfFields
+{
+    int     bAll;           /* collect all data items                       */
+    int     num_labels;     /* number of requested labels                   */
+    char  **labels;         /* requested labels (point into szLabels)       */
+    int    *len_labels;     /* their lengths                                */
+    char   *szLabels;       /* storage of labels                            */
+    int     num_values;     /* number of items collected for the record     */
+    INCHI_IOS_STRING values;/* "label\0value\0label\0value\0...\0"        */
+                            /* multi-line values are joined with '\n'       */
+} SDF_FIELDS;
+
+
 
 /*
     Functions
@@ -407,6 +437,7 @@ MOL_FMT_DATA* ReadMolfile( INCHI_IOSTREAM *inp_file,
                            unsigned long *Id,
                            const char *pSdfLabel,
                            char *pSdfValue,
+                           SDF_FIELDS *sdf_fields,
                            int *err,
                            char *pStrErr,
                            int bNoWarnings );
@@ -508,9 +539,13 @@ int SDFileSkipExtraData( INCHI_IOSTREAM *inp_file,
                          int prev_err,
                          const char *pSdfLabel,
                          char *pSdfValue,
+                         SDF_FIELDS *sdf_fields,
                          char *pStrErr,
                          int bNoWarnings);
 int SDFileIdentifyLabel( char* inp_line, const char *pSdfLabel );
 unsigned long SDFileExtractCASNo( char *line );
+int SDFileFields_Init( SDF_FIELDS *sdf_fields, const char *szLabels );
+void SDFileFields_Free( SDF_FIELDS *sdf_fields );
+char *SDFileFields_CopyValues( SDF_FIELDS *sdf_fields );
 
 #endif    /* _MOL_FMT_H_ */
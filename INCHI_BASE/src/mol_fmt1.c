@@ -105,6 +105,7 @@ MOL_FMT_DATA* ReadMolfile( INCHI_IOSTREAM *inp_file,
                            unsigned long *Id,
                            const char *pSdfLabel,
                            char *pSdfValue,
+                           SDF_FIELDS *sdf_fields,
                            int *err,
                            char *pStrErr,
                            int bNoWarnings )
@@ -134,7 +135,7 @@ MOL_FMT_DATA* ReadMolfile( INCHI_IOSTREAM *inp_file,
         /* unnecessary extra data may have present in SDF; skip them for now */
         int ret_skip_extras = SDFileSkipExtraData( inp_file, Id, NULL, 0,
                                                    pname, lname, *err,
-                                                   pSdfLabel, pSdfValue,
+                                                   pSdfLabel, pSdfValue, sdf_fields,
                                                    pStrErr, bNoWarnings);
 
 
@@ -864,8 +865,8 @@ int MolfileReadBondsBlock( MOL_FMT_CTAB* ctab,
         if (ctab->bonds)
         {
 
-            if (0 > MolfileReadField( &ctab->bonds[i].atnum1, 3, MOL_FMT_SHORT_INT_DATA, &p )
-                || 0 > MolfileReadField( &ctab->bonds[i].atnum2, 3, MOL_FMT_SHORT_INT_DATA, &p )
+            if (0 > MolfileReadField( &ctab->bonds[i].atnum1, 3, MOL_FMT_AT_NUM_DATA, &p )
+                || 0 > MolfileReadField( &ctab->bonds[i].atnum2, 3, MOL_FMT_AT_NUM_DATA, &p )
                 || 0 > MolfileReadField( &ctab->bonds[i].bond_type, 3, MOL_FMT_CHAR_INT_DATA, &p )
                 || 0 > MolfileReadField( &ctab->bonds[i].bond_stereo, 3, MOL_FMT_CHAR_INT_DATA, &p )
 
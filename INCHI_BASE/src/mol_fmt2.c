@@ -143,6 +143,7 @@ int MolfileReadField( void* data,
         case MOL_FMT_CHAR_INT_DATA:
         case MOL_FMT_SHORT_INT_DATA:
         case MOL_FMT_LONG_INT_DATA:
+        case MOL_FMT_INT_DATA:
         {
             char str[MOL_FMT_MAX_VALUE_LEN + 1];
             ldata = 0L;
@@ -221,6 +222,17 @@ int MolfileReadField( void* data,
                         ret = -1;
                     }
                     break;
+                case MOL_FMT_INT_DATA:
+                    if (INT_MIN <= ldata && ldata <= INT_MAX)
+                    {
+                        *(int*) data = (int) ldata;
+                    }
+                    else
+                    {
+                        *(int*) data = 0;
+                        ret = -1;
+                    }
+                    break;
                 default:
                     ret = -1;
             }
@@ -55,6 +55,40 @@
 
 
 static int get_actual_atom_number( int index, int n, int *orig, int *fin );
+static int MolfileV3000NextToken( char **line_ptr, int bKeyword, char **token );
+static int MolfileV3000TokenInt( char **line_ptr, long lmin, long lmax, long *value );
+static int MolfileV3000TokenDouble( char **line_ptr, double *value );
+static int MolfileV3000TokenString( char **line_ptr, char *str, int maxlen );
+static int MolfileV3000KeywordCode( const char *key, int len );
+
+
+/* Atom and bond block keywords, see MolfileV3000KeywordCode() */
+#define V3000_KW_UNKNOWN    0
+#define V3000_KW_CHG        1
+#define V3000_KW_RAD        2
+#define V3000_KW_CFG        3
+#define V3000_KW_MASS       4
+#define V3000_KW_VAL        5
+#define V3000_KW_HCOUNT     6
+#define V3000_KW_STBOX      7
+#define V3000_KW_INVRET     8
+#define V3000_KW_EXACHG     9
+#define V3000_KW_SUBST     10
+#define V3000_KW_UNSAT     11
+#define V3000_KW_RBCNT     12
+#define V3000_KW_ATTCHPT   13
+#define V3000_KW_RGROUPS   14
+#define V3000_KW_ATTCHORD  15
+#define V3000_KW_CLASS     16
+#define V3000_KW_SEQID     17
+#define V3000_KW_TOPO      18
+#define V3000_KW_RXCTR     19
+#define V3000_KW_ENDPTS    20
+#define V3000_KW_DISP      21
+#define V3000_KW_ATTACH    22
+
+/* switch key of a keyword: its first two letters and length */
+#define V3000_KW_KEY( c0, c1, len )  ( ( (c0) << 16 ) | ( (c1) << 8 ) | (len) )
 
 
 /****************************************************************************
@@ -440,6 +474,187 @@ int MolfileV3000ReadKeyword( char* key,
 }
 
 
+/****************************************************************************
+    V3000 atom and bond block lines are tokenized in place, in one pass
+    over the joined line: a token is a span of the line, numbers are
+    converted directly from it and keywords are dispatched by
+    MolfileV3000KeywordCode().  Same conventions as MolfileV3000ReadField()
+    and MolfileV3000ReadKeyword(): *line_ptr becomes NULL at end of line,
+    a keyword consumes the following '=', a missing or non-numeric number
+    reads as zero.
+****************************************************************************/
+
+
+/****************************************************************************
+    Get next whitespace (or, for a keyword, '=') delimited token.
+    Returns its length, -1 if *line_ptr is NULL.
+****************************************************************************/
+static int MolfileV3000NextToken( char **line_ptr, int bKeyword, char **token )
+{
+    char *p = *line_ptr;
+    int  n = 0;
+
+    if (!p)
+    {
+        *token = NULL;
+        return -1;
+    }
+    while (*p && isspace( UCINT *p ))
+    {
+        p++;
+    }
+    while (p[n] && !isspace( UCINT p[n] ) && !( bKeyword && p[n] == '=' ))
+    {
+        n++;
+    }
+    *token = p;
+    if (!p[n])
+    {
+        *line_ptr = NULL;
+    }
+    else
+    {
+        *line_ptr = p + n;
+        if (bKeyword && n && p[n] == '=')
+        {
+            ( *line_ptr )++; /* consume '=' sign */
+        }
+    }
+
+    return n;
+}
+
+
+/****************************************************************************
+    Read integer token. Returns -1 and sets *value to 0 if out of
+    [lmin, lmax], otherwise number of bytes read.
+****************************************************************************/
+static int MolfileV3000TokenInt( char **line_ptr,
+                                 long lmin,
+                                 long lmax,
+                                 long *value )
+{
+    char *token, *p_end;
+    long ldata;
+    int  nread = MolfileV3000NextToken( line_ptr, 0, &token );
+
+    *value = 0L;
+    if (nread <= 0)
+    {
+        return 0;
+    }
+    ldata = strtol( token, &p_end, 10 );
+    if (p_end == token)
+    {
+        return 0;
+    }
+    if (ldata < lmin || ldata > lmax)
+    {
+        return -1;
+    }
+    *value = ldata;
+
+    return nread;
+}
+
+
+/****************************************************************************
+    Read floating point token. Returns -1 on overflow.
+****************************************************************************/
+static int MolfileV3000TokenDouble( char **line_ptr, double *value )
+{
+    char *token, *p_end;
+    double ddata;
+    int  nread = MolfileV3000NextToken( line_ptr, 0, &token );
+
+    *value = 0.0;
+    if (nread <= 0)
+    {
+        return 0;
+    }
+    ddata = strtod( token, &p_end );
+    if (p_end == token)
+    {
+        return 0;
+    }
+    if (ddata == HUGE_VAL || ddata == -HUGE_VAL)
+    {
+        return -1;
+    }
+    *value = ddata;
+
+    return nread;
+}
+
+
+/****************************************************************************
+    Copy string token, truncated to maxlen-1 chars.
+    Returns -1 at end of line.
+****************************************************************************/
+static int MolfileV3000TokenString( char **line_ptr, char *str, int maxlen )
+{
+    char *token;
+    int  nread = MolfileV3000NextToken( line_ptr, 0, &token );
+
+    if (nread < 0)
+    {
+        return -1;
+    }
+    if (nread > maxlen - 1)
+    {
+        nread = maxlen - 1;
+    }
+    memcpy( str, token, nread );
+    str[nread] = '\0';
+
+    return nread;
+}
+
+
+/****************************************************************************
+    Map atom or bond block keyword to V3000_KW_xxx code
+****************************************************************************/
+static int MolfileV3000KeywordCode( const char *key, int len )
+{
+    const char *name;
+    int  code;
+
+    if (len < 3 || len > 8)
+    {
+        return V3000_KW_UNKNOWN;
+    }
+    switch (V3000_KW_KEY( UCINT key[0], UCINT key[1], len ))
+    {
+        case V3000_KW_KEY( 'C', 'H', 3 ): name = "CHG";      code = V3000_KW_CHG;      break;
+        case V3000_KW_KEY( 'R', 'A', 3 ): name = "RAD";      code = V3000_KW_RAD;      break;
+        case V3000_KW_KEY( 'C', 'F', 3 ): name = "CFG";      code = V3000_KW_CFG;      break;
+        case V3000_KW_KEY( 'M', 'A', 4 ): name = "MASS";     code = V3000_KW_MASS;     break;
+        case V3000_KW_KEY( 'V', 'A', 3 ): name = "VAL";      code = V3000_KW_VAL;      break;
+        case V3000_KW_KEY( 'H', 'C', 6 ): name = "HCOUNT";   code = V3000_KW_HCOUNT;   break;
+        case V3000_KW_KEY( 'S', 'T', 5 ): name = "STBOX";    code = V3000_KW_STBOX;    break;
+        case V3000_KW_KEY( 'I', 'N', 6 ): name = "INVRET";   code = V3000_KW_INVRET;   break;
+        case V3000_KW_KEY( 'E', 'X', 6 ): name = "EXACHG";   code = V3000_KW_EXACHG;   break;
+        case V3000_KW_KEY( 'S', 'U', 5 ): name = "SUBST";    code = V3000_KW_SUBST;    break;
+        case V3000_KW_KEY( 'U', 'N', 5 ): name = "UNSAT";    code = V3000_KW_UNSAT;    break;
+        case V3000_KW_KEY( 'R', 'B', 5 ): name = "RBCNT";    code = V3000_KW_RBCNT;    break;
+        case V3000_KW_KEY( 'A', 'T', 7 ): name = "ATTCHPT";  code = V3000_KW_ATTCHPT;  break;
+        case V3000_KW_KEY( 'R', 'G', 7 ): name = "RGROUPS";  code = V3000_KW_RGROUPS;  break;
+        case V3000_KW_KEY( 'A', 'T', 8 ): name = "ATTCHORD"; code = V3000_KW_ATTCHORD; break;
+        case V3000_KW_KEY( 'C', 'L', 5 ): name = "CLASS";    code = V3000_KW_CLASS;    break;
+        case V3000_KW_KEY( 'S', 'E', 5 ): name = "SEQID";    code = V3000_KW_SEQID;    break;
+        case V3000_KW_KEY( 'T', 'O', 4 ): name = "TOPO";     code = V3000_KW_TOPO;     break;
+        case V3000_KW_KEY( 'R', 'X', 5 ): name = "RXCTR";    code = V3000_KW_RXCTR;    break;
+        case V3000_KW_KEY( 'E', 'N', 6 ): name = "ENDPTS";   code = V3000_KW_ENDPTS;   break;
+        case V3000_KW_KEY( 'D', 'I', 4 ): name = "DISP";     code = V3000_KW_DISP;     break;
+        case V3000_KW_KEY( 'A', 'T', 6 ): name = "ATTACH";   code = V3000_KW_ATTACH;   break;
+        default:
+            return V3000_KW_UNKNOWN;
+    }
+
+    return memcmp( key, name, len ) ? V3000_KW_UNKNOWN : code;
+}
+
+
 /****************************************************************************
  Read V3000 head of CTab
 ****************************************************************************/
@@ -859,7 +1074,6 @@ int MolfileV3000ReadAtomsBlock( MOL_FMT_CTAB* ctab,
 {
     int i;
     static const S_SHORT charge_val[] = { 0, 3, 2, 1, 'R', -1, -2, -3 };
-    char field[MOL_FMT_V3000_MAXFIELDLEN];
     int nc, failed = 0;
     char *p = NULL, *line = NULL;
     INCHI_IOSTREAM tmpin;
@@ -925,35 +1139,37 @@ int MolfileV3000ReadAtomsBlock( MOL_FMT_CTAB* ctab,
 
         if (ctab->atoms)
         {
-            int index, aamap;    /* not used actually, just read them */
+            long index, aamap;    /* not used actually, just read them */
+            long ltmp;
             int len;
+            char *key;
             char symbol[6]; /* TODO: treat possibly long V3000 atom names */
             double fx = 0.0, fy = 0.0, fz = 0.0;
 
             /* Read positional parameters */
             failed = 0;
 
-            if (0 > MolfileV3000ReadField( &index, MOL_FMT_INT_DATA, &p ))
+            if (0 > MolfileV3000TokenInt( &p, INT_MIN, INT_MAX, &index ))
             {
                 failed = 1;
             }
-            else if (0 > MolfileV3000ReadField( &symbol, MOL_FMT_STRING_DATA, &p ))
+            else if (0 > MolfileV3000TokenString( &p, symbol, sizeof( symbol ) ))
             {
                 failed = 1;
             }
-            else if (0 > MolfileV3000ReadField( &fx, MOL_FMT_DOUBLE_DATA, &p ))
+            else if (0 > MolfileV3000TokenDouble( &p, &fx ))
             {
                 failed = 1;
             }
-            else if (0 > MolfileV3000ReadField( &fy, MOL_FMT_DOUBLE_DATA, &p ))
+            else if (0 > MolfileV3000TokenDouble( &p, &fy ))
             {
                 failed = 1;
             }
-            else if (0 > MolfileV3000ReadField( &fz, MOL_FMT_DOUBLE_DATA, &p ))
+            else if (0 > MolfileV3000TokenDouble( &p, &fz ))
             {
                 failed = 1;
             }
-            else if (0 > MolfileV3000ReadField( &aamap, MOL_FMT_INT_DATA, &p ))
+            else if (0 > MolfileV3000TokenInt( &p, INT_MIN, INT_MAX, &aamap ))
             {
                 failed = 1;
             }
@@ -985,14 +1201,14 @@ int MolfileV3000ReadAtomsBlock( MOL_FMT_CTAB* ctab,
             if (!strcmp( symbol, "*" ))
             {
                 /* ignore star atoms but save index info */
-                ctab->v3000->atom_index_orig[i] = index;
+                ctab->v3000->atom_index_orig[i] = (int) index;
                 ctab->v3000->atom_index_fin[i] = -1;
                 ctab->v3000->n_star_atoms++;
                 continue;
             }
 
             ctab->v3000->n_non_star_atoms++;
-            ctab->v3000->atom_index_orig[i] = index;
+            ctab->v3000->atom_index_orig[i] = (int) index;
             ctab->v3000->atom_index_fin[i] = ctab->v3000->n_non_star_atoms;
             ii = ctab->v3000->n_non_star_atoms - 1;
 
@@ -1006,149 +1222,84 @@ int MolfileV3000ReadAtomsBlock( MOL_FMT_CTAB* ctab,
             ctab->atoms[ii].fz = fz;
 
             /* Read key-val pairs if any */
-            while (p && ( len = MolfileV3000ReadKeyword( field, &p ) ) > 0)
+            while (p && ( len = MolfileV3000NextToken( &p, 1, &key ) ) > 0)
             {
-
-                int itmp;
-                char ctmp;
-                char stmp[MOL_FMT_V3000_MAXFIELDLEN];
-
                 failed = 0;
-                if (!strcmp( field, "CHG" ))
+                switch (MolfileV3000KeywordCode( key, len ))
                 {
-                    if (0 > MolfileV3000ReadField( &ctab->atoms[ii].charge, MOL_FMT_CHAR_INT_DATA, &p ))
-                    {
-                        failed = 1;
-                    }
-                }
-                else if (!strcmp( field, "RAD" ))
-                {
-                    if (0 > MolfileV3000ReadField( &ctab->atoms[ii].radical, MOL_FMT_CHAR_INT_DATA, &p ))
-                    {
-                        failed = 1;
-                    }
-                }
-                else if (!strcmp( field, "CFG" ))
-                {
-                    if (0 > MolfileV3000ReadField( &ctab->atoms[ii].stereo_parity, MOL_FMT_CHAR_INT_DATA, &p ))
-                    {
-                        failed = 1;
-                    }
-                }
+                    case V3000_KW_CHG:
+                        failed = 0 > MolfileV3000TokenInt( &p, SCHAR_MIN, SCHAR_MAX, &ltmp );
+                        ctab->atoms[ii].charge = (S_CHAR) ltmp;
+                        break;
 
-                else if (!strcmp( field, "MASS" ))
-                {
-                    /*
-                        Default = natural abundance
-                        A specified value indicates the absolute
-                        atomic weight of the designated atom.
-                    */
-                    S_SHORT iso_mass;
-                    if (0 > MolfileV3000ReadField( &iso_mass, MOL_FMT_SHORT_INT_DATA, &p ))
-                    {
-                        failed = 1;
-                        TREAT_ERR( err, 0, "Isotopic data not recognized:" );
-                        AddErrorMessage( pStrErr, line );
-                            /* ignore isotopic error for now */
-                    }
-                    else
-                    {
-                        /*  What we read is an absolute isotopic mass, by V3000 spec.
-                            Adjust this to old convention for further processing:
-                            set 'ctab->atoms[ii].mass_difference' to 127
-                            if isotopic mass is the same as element mass
-                            in Periodic Table (rounded avg by all isotopes), 'atw'
-                            delta otherwise, the value of difference 'delta' = ( isotopic mass - 'atw')
+                    case V3000_KW_RAD:
+                        failed = 0 > MolfileV3000TokenInt( &p, SCHAR_MIN, SCHAR_MAX, &ltmp );
+                        ctab->atoms[ii].radical = (char) ltmp;
+                        break;
+
+                    case V3000_KW_CFG:
+                        failed = 0 > MolfileV3000TokenInt( &p, SCHAR_MIN, SCHAR_MAX, &ltmp );
+                        ctab->atoms[ii].stereo_parity = (char) ltmp;
+                        break;
+
+                    case V3000_KW_MASS:
+                        /*
+                            Default = natural abundance
+                            A specified value indicates the absolute
+                            atomic weight of the designated atom.
                         */
-                        int  atw, delta;
-                        atw = get_atomic_mass( ctab->atoms[ii].symbol );
-                        delta = (int) iso_mass - atw;
-                        ctab->atoms[ii].mass_difference = (char) ( delta ? delta : ZERO_ATW_DIFF );
-                    }
-                }
+                        if (0 > MolfileV3000TokenInt( &p, SHRT_MIN, SHRT_MAX, &ltmp ))
+                        {
+                            failed = 1;
+                            TREAT_ERR( err, 0, "Isotopic data not recognized:" );
+                            AddErrorMessage( pStrErr, line );
+                                /* ignore isotopic error for now */
+                        }
+                        else
+                        {
+                            /*  What we read is an absolute isotopic mass, by V3000 spec.
+                                Adjust this to old convention for further processing:
+                                set 'ctab->atoms[ii].mass_difference' to 127
+                                if isotopic mass is the same as element mass
+                                in Periodic Table (rounded avg by all isotopes), 'atw'
+                                delta otherwise, the value of difference 'delta' = ( isotopic mass - 'atw')
+                            */
+                            int  atw, delta;
+                            atw = get_atomic_mass( ctab->atoms[ii].symbol );
+                            delta = (int) ltmp - atw;
+                            ctab->atoms[ii].mass_difference = (char) ( delta ? delta : ZERO_ATW_DIFF );
+                        }
+                        break;
 
-                else if (!strcmp( field, "VAL" ))
-                {
-                    if (0 > MolfileV3000ReadField( &itmp, MOL_FMT_INT_DATA, &p ))
-                    {
-                        failed = 1;
-                    }
-                    else
-                    {
-                        /* adjust to old convention: was 15 for zero, now -1 for zero */
-                        if (itmp == -1)
+                    case V3000_KW_VAL:
+                        if (0 > MolfileV3000TokenInt( &p, INT_MIN, INT_MAX, &ltmp ))
                         {
-                            ctmp = 15;
+                            failed = 1;
                         }
                         else
                         {
-                            ctmp = (char) itmp;
+                            /* adjust to old convention: was 15 for zero, now -1 for zero */
+                            ctab->atoms[ii].valence = (char) ( ltmp == -1 ? 15 : ltmp );
                         }
-                        ctab->atoms[ii].valence = ctmp;
-                    }
-                }
-                else if (!strcmp( field, "HCOUNT" ))
-                {
-                    if (0 > MolfileV3000ReadField( &itmp, MOL_FMT_INT_DATA, &p ))
-                    {
-                        ;    /* skip query-related stuff */
-                    }
-                }
-                else if (!strcmp( field, "STBOX" ))
-                {
-                    if (0 > MolfileV3000ReadField( &itmp, MOL_FMT_INT_DATA, &p ))
-                    {
-                        ;    /* skip for now */
-                    }
-                }
-                else if (!strcmp( field, "INVRET" ) || !strcmp( field, "EXACHG" ))
-                {
-                    if (0 > MolfileV3000ReadField( &itmp, MOL_FMT_INT_DATA, &p ))
-                    {
-                        ;    /* skip reaction-related stuff */
-                    }
-                }
-                else if (!strcmp( field, "SUBST" ) || !strcmp( field, "UNSAT" ) || !strcmp( field, "RBCNT" ))
-                {
-                    if (0 > MolfileV3000ReadField( &itmp, MOL_FMT_INT_DATA, &p ))
-                    {
-                        ;    /* skip query-related stuff */
-                    }
-                }
-                else if (!strcmp( field, "ATTCHPT" ))
-                {
-                    if (0 > MolfileV3000ReadField( &itmp, MOL_FMT_INT_DATA, &p ))
-                    {
-                        ;
-                    }
-                }
-                else if (!strcmp( field, "RGROUPS" ))
-                {
-                    if (0 > MolfileV3000ReadField( &stmp, MOL_FMT_STRING_DATA, &p ))
-                    {
-                        ;
-                    }
-                }
-                else if (!strcmp( field, "ATTCHORD" ))
-                {
-                    if (0 > MolfileV3000ReadField( &stmp, MOL_FMT_STRING_DATA, &p ))
-                    {
-                        ;
-                    }
-                }
-                else if (!strcmp( field, "CLASS" ))
-                {
-                    if (0 > MolfileV3000ReadField( &stmp, MOL_FMT_STRING_DATA, &p ))
-                    {
-                        ;
-                    }
-                }
-                else if (!strcmp( field, "SEQID" ))
-                {
-                    if (0 > MolfileV3000ReadField( &itmp, MOL_FMT_INT_DATA, &p ))
-                    {
-                        ;
-                    }
+                        break;
+
+                    case V3000_KW_HCOUNT:   /* skip query-related stuff */
+                    case V3000_KW_SUBST:
+                    case V3000_KW_UNSAT:
+                    case V3000_KW_RBCNT:
+                    case V3000_KW_STBOX:    /* skip for now */
+                    case V3000_KW_INVRET:   /* skip reaction-related stuff */
+                    case V3000_KW_EXACHG:
+                    case V3000_KW_ATTCHPT:
+                    case V3000_KW_RGROUPS:
+                    case V3000_KW_ATTCHORD:
+                    case V3000_KW_CLASS:
+                    case V3000_KW_SEQID:
+                        MolfileV3000NextToken( &p, 0, &key );
+                        break;
+
+                    default:
+                        break;
                 }
 
                 if (failed)
@@ -1212,7 +1363,6 @@ int MolfileV3000ReadBondsBlock( MOL_FMT_CTAB* ctab,
                                 char *pStrErr )
 {
     int i;
-    char field[MOL_FMT_V3000_MAXFIELDLEN];
     int nc;
     char *p = NULL, *line = NULL;
     INCHI_IOSTREAM tmpin;
@@ -1285,8 +1435,10 @@ int MolfileV3000ReadBondsBlock( MOL_FMT_CTAB* ctab,
 
         if (ctab->bonds)
         {
-            int index, n_orig_at, len;
-            short int atnum1 = -1, atnum2 = -1;
+            int n_orig_at, len;
+            long index, ltmp;
+            char *key;
+            MOL_FMT_AT_NUM atnum1 = -1, atnum2 = -1;
             char bond_type = 0, stereo = 0;
             int failed = 0;
             int has_non_existent_atom = 0;
@@ -1294,21 +1446,24 @@ int MolfileV3000ReadBondsBlock( MOL_FMT_CTAB* ctab,
             n_orig_at = ctab->v3000->n_non_star_atoms + ctab->v3000->n_star_atoms;
 
             /* read positional parameters */
-            if (0 > MolfileV3000ReadField( &index, MOL_FMT_INT_DATA, &p ))
+            if (0 > MolfileV3000TokenInt( &p, INT_MIN, INT_MAX, &index ))
             {
                 failed = 1;
             }
-            else if (0 > MolfileV3000ReadField( &bond_type, MOL_FMT_CHAR_INT_DATA, &p ))
-            {
-                failed = 1;
-            }
-            else if (0 > MolfileV3000ReadField( &atnum1, MOL_FMT_SHORT_INT_DATA, &p ))
-            {
-                failed = 1;
-            }
-            else if (0 > MolfileV3000ReadField( &atnum2, MOL_FMT_SHORT_INT_DATA, &p ))
+            else
             {
-                failed = 1;
+                failed = 0 > MolfileV3000TokenInt( &p, SCHAR_MIN, SCHAR_MAX, &ltmp );
+                bond_type = (char) ltmp;
+                if (!failed)
+                {
+                    failed = 0 > MolfileV3000TokenInt( &p, MOL_FMT_AT_NUM_MIN, MOL_FMT_AT_NUM_MAX, &ltmp );
+                    atnum1 = (MOL_FMT_AT_NUM) ltmp;
+                }
+                if (!failed)
+                {
+                    failed = 0 > MolfileV3000TokenInt( &p, MOL_FMT_AT_NUM_MIN, MOL_FMT_AT_NUM_MAX, &ltmp );
+                    atnum2 = (MOL_FMT_AT_NUM) ltmp;
+                }
             }
 
             atnum1 = get_actual_atom_number( atnum1, n_orig_at,
@@ -1347,21 +1502,14 @@ int MolfileV3000ReadBondsBlock( MOL_FMT_CTAB* ctab,
 
             /* TODO: treat new bond types  9 10 */
             /* read key-val pairs if any */
-            while (p && ( len = MolfileV3000ReadKeyword( field, &p ) ) > 0)
+            while (p && ( len = MolfileV3000NextToken( &p, 1, &key ) ) > 0)
             {
-
-                int itmp;
-                char stmp[MOL_FMT_V3000_MAXFIELDLEN];
                 failed = 0;
-
-                if (!strcmp( field, "CFG" ))
+                switch (MolfileV3000KeywordCode( key, len ))
                 {
-                    if (0 > MolfileV3000ReadField( &stereo, MOL_FMT_CHAR_INT_DATA, &p ))
-                    {
-                        failed = 1;
-                    }
-                    else
-                    {
+                    case V3000_KW_CFG:
+                        failed = 0 > MolfileV3000TokenInt( &p, SCHAR_MIN, SCHAR_MAX, &ltmp );
+                        stereo = (char) ltmp;
                         /*    adjust stereo to old convention for wedges which was:
                                 0 = not stereo, 1 = Up,  4 = Either, 6 = Down
                             now:
@@ -1375,90 +1523,67 @@ int MolfileV3000ReadBondsBlock( MOL_FMT_CTAB* ctab,
                         {
                             stereo = 6;
                         }
-                    }
-                }
-                else if (!strcmp( field, "TOPO" ))
-                {
-                    if (0 > MolfileV3000ReadField( &itmp, MOL_FMT_INT_DATA, &p ))
-                    {
-                        ;    /* skip query-related stuff */
-                    }
-                }
-                else if (!strcmp( field, "RXCTR" ))
-                {
-                    if (0 > MolfileV3000ReadField( &itmp, MOL_FMT_INT_DATA, &p ))
-                    {
-                        ;    /* skip reaction-related stuff */
-                    }
-                }
-                else if (!strcmp( field, "STBOX" ))
-                {
-                    if (0 > MolfileV3000ReadField( &itmp, MOL_FMT_INT_DATA, &p ))
-                    {
-                        ;    /* skip for now */
-                    }
-                }
-                else if (!strcmp( field, "ENDPTS" ))
-                {
-                    int res, *num_list = NULL;
-                    if (0 > MolfileV3000ReadHapticBond( ctab, &p, &num_list, pStrErr ))
-                    {
-                        failed = 1;
-                    }
-                    else if (!num_list)
-                    {
-                        failed = 1;
-                    }
-                    else
+                        break;
+
+                    case V3000_KW_ENDPTS:
                     {
-                        int existent_atom = atnum1;
-                        if (existent_atom < 0)
+                        int res, *num_list = NULL;
+                        if (0 > MolfileV3000ReadHapticBond( ctab, &p, &num_list, pStrErr ))
                         {
-                            existent_atom = atnum2;
+                            failed = 1;
                         }
-                        if (existent_atom < 0) /* should not be here */
+                        else if (!num_list)
                         {
                             failed = 1;
                         }
                         else
                         {
-                            int k, nnum;
-                            nnum = num_list[2];
-                            num_list[1] = existent_atom;
-                            for (k = 3; k < nnum; k++)
+                            int existent_atom = atnum1;
+                            if (existent_atom < 0)
                             {
-                                num_list[k] = get_actual_atom_number( num_list[k],
-                                                                      n_orig_at,
-                                                                      ctab->v3000->atom_index_orig,
-                                                                      ctab->v3000->atom_index_fin );
+                                existent_atom = atnum2;
                             }
-                            res = NumLists_Append( ctab->v3000->haptic_bonds, num_list );
-                            if (res < 0)
+                            if (existent_atom < 0) /* should not be here */
                             {
                                 failed = 1;
                             }
                             else
                             {
-                                is_haptic = 1;
+                                int k, nnum;
+                                nnum = num_list[2];
+                                num_list[1] = existent_atom;
+                                for (k = 3; k < nnum; k++)
+                                {
+                                    num_list[k] = get_actual_atom_number( num_list[k],
+                                                                          n_orig_at,
+                                                                          ctab->v3000->atom_index_orig,
+                                                                          ctab->v3000->atom_index_fin );
+                                }
+                                res = NumLists_Append( ctab->v3000->haptic_bonds, num_list );
+                                if (res < 0)
+                                {
+                                    failed = 1;
+                                }
+                                else
+                                {
+                                    is_haptic = 1;
+                                }
                             }
                         }
                     }
-                }
-                else if (!strcmp( field, "DISP" ))
-                {
-                    if (0 > MolfileV3000ReadField( &stmp, MOL_FMT_STRING_DATA, &p ))
-                    {
-                        ;
-                    }
-                }
-                else if (!strcmp( field, "ATTACH" ))
-                {
-                    if (0 > MolfileV3000ReadField( &stmp, MOL_FMT_STRING_DATA, &p ))
-                    {
-                        ;
-                    }
-                }
+                    break;
 
+                    case V3000_KW_TOPO:     /* skip query-related stuff */
+                    case V3000_KW_RXCTR:    /* skip reaction-related stuff */
+                    case V3000_KW_STBOX:    /* skip for now */
+                    case V3000_KW_DISP:
+                    case V3000_KW_ATTACH:
+                        MolfileV3000NextToken( &p, 0, &key );
+                        break;
+
+                    default:
+                        break;
+                }
 
                 if (failed)
                 {
@@ -1475,7 +1600,7 @@ int MolfileV3000ReadBondsBlock( MOL_FMT_CTAB* ctab,
                         break;
                     }
                 }
-            } /* while ( p && (len=MolfileV3000ReadKeyword(field, &p)) > 0 ) */
+            } /* while ( p && (len=MolfileV3000NextToken(&p, 1, &key)) > 0 ) */
 
             if (is_haptic)
             {
@@ -1523,6 +1648,7 @@ int MolfileV3000ReadBondsBlock( MOL_FMT_CTAB* ctab,
     remove_one_lf( line );
 
 err_fin:
+    inchi_strbuf_close( pin );
 
     return err;
 }
@@ -1535,6 +1661,11 @@ err_fin:
 int get_actual_atom_number( int index, int n, int *orig, int *fin )
 {
     int i;
+    /* atoms are usually numbered 1, 2, ..., n: avoid O(n) search per bond */
+    if (0 < index && index <= n && orig[index - 1] == index)
+    {
+        return fin[index - 1];
+    }
     for (i = 0; i < n; i++)
     {
         if (orig[i] == index)
@@ -1862,7 +1993,7 @@ int get_V3000_input_line_to_strbuf( INCHI_IOS_STRING *buf,
             return -1;
         }
 
-        memmove( (void*) ( buf->pStr + old_used ), (void*) ( buf->pStr + old_used + 7 ), buf->nUsedLength - old_used + 1 );
+        memmove( (void*) ( buf->pStr + old_used ), (void*) ( buf->pStr + old_used + 7 ), buf->nUsedLength - old_used - 7 + 1 );
         buf->nUsedLength -= 7;
 
         if (buf->pStr[buf->nUsedLength - 1] != '-')
@@ -31,12 +31,22 @@
 *
 */
 
+#if !defined( _MSC_VER )
+#define _FILE_OFFSET_BITS 64   /* 64-bit off_t for fseeko() and stat() */
+#if !defined( _WIN32 ) && !defined( _POSIX_C_SOURCE ) && !defined( _GNU_SOURCE )
+#define _POSIX_C_SOURCE 200112L
+#endif
+#endif
+
 #include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
 #include <math.h>
 #include <float.h>
 #include <limits.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #include "mode.h"
 #include "mol_fmt.h"
@@ -93,6 +103,32 @@ enum { SDF_START
     , SD_FMT_END_OF_DATA_BLOCK
 };
 
+static int SDFileFieldsAppend( SDF_FIELDS *sdf_fields, const char *s, int len );
+static int SDFileFieldsStartItem( SDF_FIELDS *sdf_fields, const char *line );
+static void SDFileFieldsAddValueLine( SDF_FIELDS *sdf_fields, const char *line, int bNewLine );
+static void SDFileFieldsEndItem( SDF_FIELDS *sdf_fields );
+
+/* 64-bit offsets in SD file index */
+#if defined( _MSC_VER )
+typedef __int64 SDF_OFFSET;
+typedef struct _stati64 SDF_STAT;
+#define sdf_fseeko  _fseeki64
+#define sdf_ftello  _ftelli64
+#define sdf_stat    _stati64
+#else
+typedef off_t SDF_OFFSET;
+typedef struct stat SDF_STAT;
+#define sdf_fseeko  fseeko
+#define sdf_ftello  ftello
+#define sdf_stat    stat
+#endif
+
+static int SDFileIndexBuild( struct tagINCHI_CLOCK *ic,
+                             const INPUT_PARMS *ip,
+                             const char *szIdxPath,
+                             SDF_OFFSET size,
+                             SDF_OFFSET mtime );
+
 int OrigAtData_WriteToSDfileHeaderAndCountThings( const ORIG_ATOM_DATA *inp_at_data,
                                                   INCHI_IOSTREAM * fcb,
                                                   const char* name,
@@ -158,6 +194,7 @@ int SDFileSkipExtraData( INCHI_IOSTREAM *inp_file,
                          int prev_err,
                          const char *pSdfLabel,
                          char *pSdfValue,
+                         SDF_FIELDS *sdf_fields,
                          char *pStrErr,
                          int bNoWarnings)
 {
@@ -172,6 +209,13 @@ int SDFileSkipExtraData( INCHI_IOSTREAM *inp_file,
     int   wait_for_name = name && lname > 0 && !name[0];
     int   wait_for_comment = comment && lcomment > 0 && !comment[0];
     int   wait_for_user = pSdfLabel && pSdfLabel[0] && pSdfValue;
+    int   field_open = 0; /* reading value of a requested data item */
+
+    if (sdf_fields)
+    {
+        inchi_strbuf_reset( &sdf_fields->values );
+        sdf_fields->num_values = 0;
+    }
 
     if (CAS_num != NULL)
     {
@@ -216,6 +260,19 @@ int SDFileSkipExtraData( INCHI_IOSTREAM *inp_file,
 
         n_blank_lines += ( *line == '\0' );
 
+        if (field_open)
+        {
+            if (*line && strcmp( line, SD_FMT_END_OF_DATA ))
+            {
+                SDFileFieldsAddValueLine( sdf_fields, line, field_open++ > 1 );
+            }
+            else
+            {
+                SDFileFieldsEndItem( sdf_fields );
+                field_open = 0;
+            }
+        }
+
         switch (current_state)
         {
             case SDF_START:
@@ -228,6 +285,10 @@ int SDFileSkipExtraData( INCHI_IOSTREAM *inp_file,
                 }
                 else if ('>' == *line)
                 {
+                    if (sdf_fields)
+                    {
+                        field_open = SDFileFieldsStartItem( sdf_fields, line );
+                    }
                     current_state = ( wait_for_name || wait_for_comment || wait_for_CAS || wait_for_user ) ? SDFileIdentifyLabel( line, pSdfLabel ) : SDF_DATA_HEADER;
                 }
                 else if (*line == '\0')
@@ -300,6 +361,11 @@ int SDFileSkipExtraData( INCHI_IOSTREAM *inp_file,
         }
     }
 
+    if (field_open)
+    {
+        SDFileFieldsEndItem( sdf_fields );
+    }
+
     if (!err && SD_FMT_END_OF_DATA_BLOCK != current_state && NULL == p)
     {
         ; /* err = 4; */ /* unexpected end of file: missing $$$$ */
@@ -410,6 +476,456 @@ unsigned long SDFileExtractCASNo( char *line )
 }
 
 
+/****************************************************************************
+ Prepare SDF_FIELDS for collecting the data items whose labels are listed
+ in szLabels, separated by commas or semicolons; "*" requests all items.
+ Return 0 if OK, -1 on memory allocation failure
+****************************************************************************/
+int SDFileFields_Init( SDF_FIELDS *sdf_fields, const char *szLabels )
+{
+    int i, n, len;
+    char *p, *q;
+
+    memset( sdf_fields, 0, sizeof( *sdf_fields ) );
+    if (0 > inchi_strbuf_init( &sdf_fields->values, 0, 0 ))
+    {
+        return -1;
+    }
+    if (!szLabels || !szLabels[0])
+    {
+        return 0;
+    }
+
+    len = (int) strlen( szLabels );
+    sdf_fields->szLabels = (char *) inchi_malloc( len + 1 );
+    if (!sdf_fields->szLabels)
+    {
+        goto exit_error;
+    }
+    memcpy( sdf_fields->szLabels, szLabels, len + 1 );
+    for (n = 1, i = 0; i < len; i++)
+    {
+        n += ( szLabels[i] == ',' || szLabels[i] == ';' );
+    }
+    sdf_fields->labels = (char **) inchi_calloc( n, sizeof( sdf_fields->labels[0] ) );
+    sdf_fields->len_labels = (int *) inchi_calloc( n, sizeof( sdf_fields->len_labels[0] ) );
+    if (!sdf_fields->labels || !sdf_fields->len_labels)
+    {
+        goto exit_error;
+    }
+
+    for (p = sdf_fields->szLabels; p; p = q)
+    {
+        if (( q = strpbrk( p, ",;" ) ))
+        {
+            *q++ = '\0';
+        }
+        lrtrim( p, &len );
+        if (!len)
+        {
+            continue;
+        }
+        if (!strcmp( p, "*" ))
+        {
+            sdf_fields->bAll = 1;
+            continue;
+        }
+        sdf_fields->labels[sdf_fields->num_labels] = p;
+        sdf_fields->len_labels[sdf_fields->num_labels] = len;
+        sdf_fields->num_labels++;
+    }
+
+    return 0;
+
+exit_error:
+    SDFileFields_Free( sdf_fields );
+
+    return -1;
+}
+
+
+/****************************************************************************/
+void SDFileFields_Free( SDF_FIELDS *sdf_fields )
+{
+    if (!sdf_fields)
+    {
+        return;
+    }
+    if (sdf_fields->szLabels)
+    {
+        inchi_free( sdf_fields->szLabels );
+    }
+    if (sdf_fields->labels)
+    {
+        inchi_free( sdf_fields->labels );
+    }
+    if (sdf_fields->len_labels)
+    {
+        inchi_free( sdf_fields->len_labels );
+    }
+    inchi_strbuf_close( &sdf_fields->values );
+    memset( sdf_fields, 0, sizeof( *sdf_fields ) );
+}
+
+
+/****************************************************************************
+ Return a copy of collected "label\0value\0...\0\0" data or NULL if
+ no requested items were found in the record
+****************************************************************************/
+char *SDFileFields_CopyValues( SDF_FIELDS *sdf_fields )
+{
+    char *p;
+    int len;
+
+    if (!sdf_fields || !sdf_fields->num_values)
+    {
+        return NULL;
+    }
+    len = sdf_fields->values.nUsedLength;
+    p = (char *) inchi_malloc( len + 1 );
+    if (p)
+    {
+        memcpy( p, sdf_fields->values.pStr, len );
+        p[len] = '\0';
+    }
+
+    return p;
+}
+
+
+/****************************************************************************
+ Append len chars and keep room for a terminating zero
+****************************************************************************/
+static int SDFileFieldsAppend( SDF_FIELDS *sdf_fields, const char *s, int len )
+{
+    INCHI_IOS_STRING *buf = &sdf_fields->values;
+
+    if (0 > inchi_strbuf_update( buf, len + 2 ))
+    {
+        return -1;
+    }
+    memcpy( buf->pStr + buf->nUsedLength, s, len );
+    buf->nUsedLength += len;
+
+    return 0;
+}
+
+
+/****************************************************************************
+ Check data header line '> ... <label> ...' against requested labels;
+ if matched, store the label and return 1 (value is expected), else 0
+****************************************************************************/
+static int SDFileFieldsStartItem( SDF_FIELDS *sdf_fields, const char *line )
+{
+    const char *p, *q;
+    int i, len;
+
+    if (!( p = strchr( line, '<' ) ) || !( q = strchr( ++p, '>' ) ))
+    {
+        return 0;
+    }
+    while (p < q && isspace( UCINT *p ))
+    {
+        p++;
+    }
+    while (q > p && isspace( UCINT q[-1] ))
+    {
+        q--;
+    }
+    len = (int) ( q - p );
+    if (!len)
+    {
+        return 0;
+    }
+
+    if (!sdf_fields->bAll)
+    {
+        for (i = 0; i < sdf_fields->num_labels; i++)
+        {
+            if (len == sdf_fields->len_labels[i] &&
+                 !inchi_memicmp( p, sdf_fields->labels[i], len ))
+            {
+                break;
+            }
+        }
+        if (i == sdf_fields->num_labels)
+        {
+            return 0;
+        }
+    }
+
+    if (SDFileFieldsAppend( sdf_fields, p, len ))
+    {
+        return 0;
+    }
+    sdf_fields->values.pStr[sdf_fields->values.nUsedLength++] = '\0';
+    sdf_fields->num_values++;
+
+    return 1;
+}
+
+
+/****************************************************************************/
+static void SDFileFieldsAddValueLine( SDF_FIELDS *sdf_fields, const char *line, int bNewLine )
+{
+    if (bNewLine)
+    {
+        SDFileFieldsAppend( sdf_fields, "\n", 1 );
+    }
+    SDFileFieldsAppend( sdf_fields, line, (int) strlen( line ) );
+}
+
+
+/****************************************************************************/
+static void SDFileFieldsEndItem( SDF_FIELDS *sdf_fields )
+{
+    /* SDFileFieldsAppend() always leaves room for this zero */
+    sdf_fields->values.pStr[sdf_fields->values.nUsedLength++] = '\0';
+}
+
+
+/*
+    SD file record index
+
+    The sidecar file "<sdfile>.idx" holds the offsets of all records of
+    the SD file (in the uncompressed data if the file is gzipped), so that
+    a run starting at n-th record seeks to it instead of parsing the n-1
+    preceding ones. Layout: signature, size and modification time of the
+    SD file, number of records, offset of each record; all numbers are
+    8-byte little-endian. The index is rebuilt when the SD file changes.
+*/
+#define SDF_INDEX_SIGNATURE "InChI SDF idx 2\n"
+#define SDF_INDEX_SIG_LEN   16
+#define SDF_INDEX_HDR_LEN   ( SDF_INDEX_SIG_LEN + 3 * 8 )
+
+
+/****************************************************************************/
+static int SDFileIndexPutNum( FILE *f, SDF_OFFSET n )
+{
+    unsigned char b[8];
+    int i;
+
+    if (n < 0)
+    {
+        return 0;
+    }
+    for (i = 0; i < 8; i++)
+    {
+        b[i] = (unsigned char) ( n % 256 );
+        n /= 256;
+    }
+
+    return 8 == fwrite( b, 1, 8, f );
+}
+
+
+/****************************************************************************/
+static int SDFileIndexGetNum( FILE *f, SDF_OFFSET *n )
+{
+    unsigned char b[8];
+    int i;
+
+    if (8 != fread( b, 1, 8, f ) || b[7] > 0x7f)
+    {
+        return 0;
+    }
+    for (*n = 0, i = 7; i >= 0; i--)
+    {
+        *n = *n * 256 + b[i];
+    }
+
+    return 1;
+}
+
+
+/****************************************************************************
+ Read the SD file with ReadTheStructure() as GetOneStructure() does and
+ write the offset of each record to a temporary file, then rename it, so
+ that concurrent runs do not collide. Thus the records are counted exactly
+ as in a sequential run, including blank and unreadable ones.
+****************************************************************************/
+static int SDFileIndexBuild( struct tagINCHI_CLOCK *ic,
+                             const INPUT_PARMS *ip,
+                             const char *szIdxPath,
+                             SDF_OFFSET size,
+                             SDF_OFFSET mtime )
+{
+    INCHI_IOSTREAM inp;
+    INPUT_PARMS    ip1;
+    STRUCT_DATA    sd;
+    ORIG_ATOM_DATA orig;
+    FILE *fi = NULL;
+    char *szTmpPath = NULL;
+    SDF_OFFSET start, num = 0;
+    int  nRet, out_index = 0, ret = 0;
+
+    /* the reader updates some parameters; SDF data are not needed */
+    ip1 = *ip;
+    ip1.pSdfLabel = NULL;
+    ip1.pSdfValue = NULL;
+    ip1.pSdfFields = NULL;
+    memset( &orig, 0, sizeof( orig ) );
+
+    inchi_ios_init( &inp, INCHI_IOS_TYPE_FILE, inchi_fopen( ip->path[0], "rb", 0 ) );
+    szTmpPath = (char *) inchi_malloc( strlen( szIdxPath ) + 20 );
+    if (!inp.f || !szTmpPath)
+    {
+        goto exit_function;
+    }
+    sprintf( szTmpPath, "%s.%lx", szIdxPath,
+             (unsigned long) time( NULL ) ^ (unsigned long) (size_t) szTmpPath );
+    if (!( fi = fopen( szTmpPath, "wb" ) ))
+    {
+        goto exit_function;
+    }
+    /* header; the number of records is written at the end */
+    if (SDF_INDEX_SIG_LEN != fwrite( SDF_INDEX_SIGNATURE, 1, SDF_INDEX_SIG_LEN, fi ) ||
+        !SDFileIndexPutNum( fi, size ) ||
+        !SDFileIndexPutNum( fi, mtime ) ||
+        !SDFileIndexPutNum( fi, 0 ))
+    {
+        goto exit_function;
+    }
+
+    for (;;)
+    {
+        start = sdf_ftello( inp.f );
+        nRet = ReadTheStructure( ic, &sd, &ip1, &inp, &orig, -1, &out_index );
+        FreeOrigAtData( &orig );
+        if (nRet || ( 10 < sd.nStructReadError && sd.nStructReadError < 20 ))
+        {
+            break; /* end of file */
+        }
+        if (!SDFileIndexPutNum( fi, start ))
+        {
+            goto exit_function;
+        }
+        num++;
+    }
+    if (ferror( inp.f ) ||
+        fseek( fi, SDF_INDEX_HDR_LEN - 8, SEEK_SET ) ||
+        !SDFileIndexPutNum( fi, num ))
+    {
+        goto exit_function;
+    }
+    ret = 1;
+
+exit_function:
+    inchi_ios_close( &inp );
+    if (fi)
+    {
+        if (fclose( fi ))
+        {
+            ret = 0;
+        }
+        if (ret && rename( szTmpPath, szIdxPath ))
+        {
+            /* not on Windows if the index already exists */
+            remove( szIdxPath );
+            ret = !rename( szTmpPath, szIdxPath );
+        }
+        if (!ret)
+        {
+            remove( szTmpPath );
+        }
+    }
+    if (szTmpPath)
+    {
+        inchi_free( szTmpPath );
+    }
+
+    return ret;
+}
+
+
+/****************************************************************************
+ Option SdfIndex: position the input SD file at record ip->first_struct_number
+ (1-based) using the index, creating the index if it is missing or out of
+ date. Return the number of records skipped; 0 if the input was not moved.
+****************************************************************************/
+long SDFileIndexSeek( struct tagINCHI_CLOCK *ic,
+                      const INPUT_PARMS *ip,
+                      INCHI_IOSTREAM *inp_file,
+                      INCHI_IOSTREAM *log_file )
+{
+    SDF_STAT st;
+    FILE *fi = NULL;
+    char *szIdxPath = NULL, sig[SDF_INDEX_SIG_LEN];
+    SDF_OFFSET size, mtime, num = 0, offset;
+    long nRecord = ip->first_struct_number;
+    int  bBuilt = 0;
+    long ret = 0;
+
+    if (!inp_file->f || !ip->path[0] || sdf_stat( ip->path[0], &st ) ||
+        !( szIdxPath = (char *) inchi_malloc( strlen( ip->path[0] ) + 5 ) ))
+    {
+        goto exit_function;
+    }
+    sprintf( szIdxPath, "%s.idx", ip->path[0] );
+
+    for (;;)
+    {
+        if (( fi = fopen( szIdxPath, "rb" ) ) &&
+            SDF_INDEX_SIG_LEN == fread( sig, 1, SDF_INDEX_SIG_LEN, fi ) &&
+            !memcmp( sig, SDF_INDEX_SIGNATURE, SDF_INDEX_SIG_LEN ) &&
+            SDFileIndexGetNum( fi, &size ) && size == (SDF_OFFSET) st.st_size &&
+            SDFileIndexGetNum( fi, &mtime ) && mtime == (SDF_OFFSET) st.st_mtime &&
+            SDFileIndexGetNum( fi, &num ))
+        {
+            break; /* valid index */
+        }
+        if (fi)
+        {
+            fclose( fi );
+            fi = NULL;
+        }
+        if (bBuilt ||
+            !SDFileIndexBuild( ic, ip, szIdxPath,
+                               (SDF_OFFSET) st.st_size,
+                               (SDF_OFFSET) st.st_mtime ))
+        {
+            inchi_ios_eprint( log_file, "Cannot create SD file index '%s'\n", szIdxPath );
+            goto exit_function;
+        }
+        bBuilt = 1;
+    }
+
+    inchi_ios_eprint( log_file, "%s SD file index '%s': %.0f record%s\n",
+                      bBuilt ? "Created" : "Using", szIdxPath, (double) num, num == 1 ? "" : "s" );
+
+    if (nRecord > num)
+    {
+        nRecord = (long) num; /* past the end: the last record is read and skipped */
+    }
+    if (nRecord > 1)
+    {
+        if (!sdf_fseeko( fi, SDF_INDEX_HDR_LEN + (SDF_OFFSET) 8 * ( nRecord - 1 ), SEEK_SET ) &&
+            SDFileIndexGetNum( fi, &offset ) &&
+            !sdf_fseeko( inp_file->f, offset, SEEK_SET ))
+        {
+            ret = nRecord - 1;
+        }
+        else
+        {
+            rewind( inp_file->f );
+            inchi_ios_eprint( log_file, "Cannot use SD file index '%s'\n", szIdxPath );
+        }
+    }
+
+exit_function:
+    if (fi)
+    {
+        fclose( fi );
+    }
+    if (szIdxPath)
+    {
+        inchi_free( szIdxPath );
+    }
+
+    return ret;
+}
+
+
 /****************************************************************************
  NUM_LISTS - dynamically growing array of int lists
 ****************************************************************************/
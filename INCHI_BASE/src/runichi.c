@@ -166,6 +166,11 @@ static void SaveOkProcessedMolfile( int             nRet,
                                     INPUT_PARMS     *ip,
                                     INCHI_IOSTREAM  *prb_file,
                                     INCHI_IOSTREAM  *inp_file );
+static void OutputCanonStat( STRUCT_DATA     *sd,
+                             INPUT_PARMS     *ip,
+                             PINChI_Aux2     *pINChI_Aux[INCHI_NUM],
+                             INCHI_IOSTREAM  *log_file,
+                             long            num_inp );
 
 static int mark_atoms_to_delete_or_renumber( ORIG_ATOM_DATA *orig_at_data,
                                              OAD_StructureEdits *ed,
@@ -447,6 +452,11 @@ int ProcessOneStructure( INCHI_CLOCK            *ic,
 
     SaveOkProcessedMolfile( nRet, sd, ip, prb_file, inp_file );
 
+    if (ip->bCanonStat && nRet != _IS_FATAL && nRet != _IS_ERROR)
+    {
+        OutputCanonStat( sd, ip, pINChI_Aux, log_file, num_inp );
+    }
+
 
     /* Cleanup */
 
@@ -774,6 +784,54 @@ void SaveOkProcessedMolfile( int            nRet,
 }
 
 
+/****************************************************************************
+ Log automorphism group size and canonicalization search statistics
+ of each component ("CanonStat" option)
+****************************************************************************/
+void OutputCanonStat( STRUCT_DATA     *sd,
+                      INPUT_PARMS     *ip,
+                      PINChI_Aux2     *pINChI_Aux[INCHI_NUM],
+                      INCHI_IOSTREAM  *log_file,
+                      long            num_inp )
+{
+    int i, j, k;
+    INChI_Aux *pAux;
+    static const char *szRecMet[INCHI_NUM] = { "", " (reconnected)" };
+
+    for (i = 0; i < INCHI_NUM; i++)
+    {
+        if (!pINChI_Aux[i])
+        {
+            continue;
+        }
+        for (j = 0; j < sd->num_components[i]; j++)
+        {
+            /* mobile-H results if present, otherwise fixed-H */
+            pAux = NULL;
+            for (k = TAUT_NUM - 1; 0 <= k && !pAux; k--)
+            {
+                pAux = pINChI_Aux[i][j][k];
+                if (pAux && ( pAux->bDeleted || !pAux->nNumberOfAtoms ))
+                {
+                    pAux = NULL;
+                }
+            }
+            if (!pAux)
+            {
+                continue;
+            }
+            inchi_ios_eprint( log_file, "Structure #%ld%s component %d: |Aut| = %.0f, %ld generator(s), %ld leaf CT(s), %ld stereo mapping step(s)%s%s%s%s\n",
+                              num_inp, szRecMet[i], j + 1,
+                              pAux->dGroupSize, pAux->lNumGenerators, pAux->lNumCanonTotCT,
+                              pAux->lNumStereoMapSteps,
+                              SDF_LBL_VAL( ip->pSdfLabel, ip->pSdfValue ) );
+        }
+    }
+
+    return;
+}
+
+
 /****************************************************************************
  Generate InChI for the whole (multi-component) structure
 ****************************************************************************/
@@ -1962,7 +2020,12 @@ int ProcessOneStructureEx( struct tagINCHI_CLOCK    *ic,
 {
     int ret = _IS_OKAY;
     char *sinchi_noedits=NULL, *saux_noedits=NULL;
+    long lPeakMem = -1;
     
+    if (ip->bMemStat)
+    {
+        inchi_mem_stat_begin( );
+    }
 
     /* PREPROCESS */
 
@@ -2041,6 +2104,20 @@ int ProcessOneStructureEx( struct tagINCHI_CLOCK    *ic,
     inchi_free(sinchi_noedits);
     inchi_free(saux_noedits);
 
+    if (ip->bMemStat)
+    {
+        lPeakMem = inchi_mem_stat_end( );
+        if (lPeakMem >= 0)
+        {
+            inchi_ios_eprint( log_file, "Structure #%ld: peak heap %ld KB%s%s%s%s\n",
+                              num_inp, ( lPeakMem + 1023 ) / 1024,
+                              SDF_LBL_VAL( ip->pSdfLabel, ip->pSdfValue ) );
+        }
+    }
+
+    CaptureSlowRecord( sd, ip, pINChI_Aux2, inp_file, log_file, orig_inp_data,
+                       num_inp, ret, lPeakMem );
+
     
 #ifdef TARGET_LIB_FOR_WINCHI
 
@@ -2082,6 +2159,7 @@ int PreprocessPolymerCRUData(	struct tagINCHI_CLOCK    *ic,
 {
     int ret = _IS_OKAY;
     char *sinchi_105p = NULL, *saux_105p = NULL;
+    int b105p_unedited = 0; /* sinchi_105p, saux_105p are for the current orig_inp_data */
     OAD_StructureEdits edits_unit_frame_shift, *ed_fs = &edits_unit_frame_shift;
     OAD_StructureEdits edits_unit_folding, *ed_fold = &edits_unit_folding;
     
@@ -2153,6 +2231,7 @@ int PreprocessPolymerCRUData(	struct tagINCHI_CLOCK    *ic,
                             }
                             goto frame_shift; 
                         }
+                        b105p_unedited = 1;
 
                         ret = OAD_Polymer_PrepareFoldCRUEdits( orig_inp_data, *sinchi_noedits, *saux_noedits, sinchi_105p, saux_105p, ed_fold);
                         if (ret == _IS_FATAL || ret == _IS_ERROR)
@@ -2181,6 +2260,7 @@ int PreprocessPolymerCRUData(	struct tagINCHI_CLOCK    *ic,
                             {
                                 /* Edit the original input data */
                                 ed_fold->del_side_chains = 1;
+                                b105p_unedited = 0;
                                 n_done = OAD_StructureEdits_Apply(sd, ip, orig_inp_data, ed_fold, &ret);
                                 if (ret == _IS_FATAL || ret == _IS_ERROR)
                                 {
@@ -2208,22 +2288,32 @@ frame_shift:        ;
                     /* Prepare and perform frame shift related edits */
                     if (ip->bFrameShiftScheme != FSS_NONE) 
                     {
-                        /* Clear buffers */
-                        if (sinchi_105p)
+                        if (b105p_unedited && ip->bFrameShiftScheme == FSS_STARS_CYCLED)
                         {
-                            inchi_free(sinchi_105p);
+                            /* CRU folding has not changed the structure; interim 105+    */
+                            /* InChI and AuxInfo obtained for it with the same frame     */
+                            /* shift scheme are still valid, do not calculate them again */
+                            ret = _IS_OKAY;
                         }
-                        if (saux_105p)
+                        else
                         {
-                            inchi_free(saux_105p);
+                            /* Clear buffers */
+                            if (sinchi_105p)
+                            {
+                                inchi_free(sinchi_105p);
+                            }
+                            if (saux_105p)
+                            {
+                                inchi_free(saux_105p);
+                            }
+                            /*	Get interim 105+ flavour of InChI and AuxInfo (possibly 2nd time) */
+                            ret = OAD_ProcessOneStructure105Plus(ic, CG, sd, ip, szTitle,
+                                                                    pINChI2, pINChI_Aux2,
+                                                                    inp_file, log_file, out_file, prb_file,
+                                                                    orig_inp_data, prep_inp_data,
+                                                                    num_inp, strbuf, save_opt_bits,
+                                                                    &sinchi_105p, &saux_105p);
                         }
-                        /*	Get interim 105+ flavour of InChI and AuxInfo (possibly 2nd time) */
-                        ret = OAD_ProcessOneStructure105Plus(ic, CG, sd, ip, szTitle,
-                                                                pINChI2, pINChI_Aux2,
-                                                                inp_file, log_file, out_file, prb_file,
-                                                                orig_inp_data, prep_inp_data,
-                                                                num_inp, strbuf, save_opt_bits,
-                                                                &sinchi_105p, &saux_105p);
                         if (ret == _IS_FATAL || ret == _IS_ERROR)
                         {
                             ret = _IS_WARNING;
@@ -90,12 +90,14 @@ typedef struct tagDiylFrag
     int *alist;		/* list of atoms orig numbers	    */
     int *xclist;	/* list of atoms extended classes   */
     INCHI_IOS_STRING sig; /* string signature           */
+    unsigned long hash;   /* hash of string signature   */
 } DiylFrag;
 
 static DiylFrag* DiylFrag_New( int na, int e1nd, int end2, char *s );
 static void DiylFrag_Free( DiylFrag *pfrag );
-static void DiylFrag_MakeSignature( DiylFrag *pfrag, int nxc, int *xc, int *tmp );
+static void DiylFrag_MakeSignature( DiylFrag *pfrag, int nxc, int *xc, int *tmp, int *tmp2 );
 static int DiylFrag_Diff( DiylFrag *pfrag1, DiylFrag *pfrag2 );
+static int DiylFrag_Classify( DiylFrag **frag, int n_frags, int *frag_class );
 static void DiylFrag_DebugTrace( DiylFrag *pfrag );
 
 static int NDefStereoBonds( inp_ATOM *at, int iatom, int bOnlyPointedEndMatters );
@@ -114,7 +116,7 @@ static int analyze_CRU_folding( ORIG_ATOM_DATA *orig_at_data,
                                 int nxclasses,
                                 int *xc,
                                 OAD_StructureEdits *ed );
-static int count_colors_in_sequence( int *entries, int n_entries, int max_distinct, int *counts );
+static int cmp_ints( const void *a1, const void *a2 );
 static int len_repeating_subsequence( int *color, int *color2, int n );
 
 
@@ -468,6 +470,7 @@ int ReadTheStructure( struct tagINCHI_CLOCK *ic,
                                                       ip->bNPZz,
                                                       ip->pSdfLabel,
                                                       ip->pSdfValue,
+                                                      ip->pSdfFields,
                                                       &ip->lSdfId,
                                                       &ip->lMolfileNumber,
                                                       &InpAtomFlags,
@@ -560,6 +563,7 @@ int ReadTheStructure( struct tagINCHI_CLOCK *ic,
                                                           0, /* ip->bNPZz */
                                                           NULL,     /* *pSdfLabel */
                                                           NULL,     /* *pSdfValue */
+                                                          NULL,     /* *sdf_fields */
                                                           NULL,     /* *lSdfId */
                                                           NULL,     /* *lMolfileNumber */
                                                           &InpAtomFlags, /*NULL, */
@@ -1825,11 +1829,11 @@ int  OAD_Polymer_PrepareFoldCRUEdits( ORIG_ATOM_DATA *orig_at_data,
     int *orig = NULL;
     int nat = orig_at_data->num_inp_atoms;
     int neclasses = 0;		/* No of constitutional equivalence classses for the atoms		*/
-    int ec[MAX_ATOMS],		/* equivalence classes for atoms, in order of 1-based orig nums	*/
-        ec_cano[MAX_ATOMS],	/* equivalence classes for atoms, in order of 1-based cano nums	*/
-        at_stereo_mark_orig[MAX_ATOMS];	/* stereo parities, in order of 1-based orig nums	*/
+    int *ec = NULL,		/* equivalence classes for atoms, in order of 1-based orig nums	*/
+        *ec_cano,	/* equivalence classes for atoms, in order of 1-based cano nums	*/
+        *at_stereo_mark_orig;	/* stereo parities, in order of 1-based orig nums	*/
     int nxclasses = 0;      /* No of extended (stereo-aware) atom classses == 3*neclasses   */
-    int xc[MAX_ATOMS];      /* Extended (stereo-aware) atom classes.
+    int *xc;                /* Extended (stereo-aware) atom classes.
                                 There are 'n_ec' non-stereo atom equivalence classes
                                 For ec[i]=k, keep value k for no-stereo atoms while use
                                 (k + neclasses)   for '-' parity
@@ -1845,6 +1849,16 @@ int  OAD_Polymer_PrepareFoldCRUEdits( ORIG_ATOM_DATA *orig_at_data,
         ret = _IS_ERROR;
         goto exit_function;
     }
+    /* Per-atom work arrays are allocated (not kept on stack) as MAX_ATOMS may be large */
+    ec = (int *)inchi_calloc(4 * (nat + 2), sizeof(int));
+    if (!ec)
+    {
+        ret = _IS_ERROR;
+        goto exit_function;
+    }
+    ec_cano = ec + (nat + 2);
+    at_stereo_mark_orig = ec_cano + (nat + 2);
+    xc = at_stereo_mark_orig + (nat + 2);
     ret = extract_orig_nums_from_auxinfo_string(saux, orig);
     if (ret != _IS_OKAY && ret != _IS_WARNING)
     {
@@ -1980,6 +1994,10 @@ exit_function:
     {
         inchi_free(all_bkb_orig);
     }
+    if (ec)
+    {
+        inchi_free(ec);
+    }
 
     return ret;
 }
@@ -2047,31 +2065,58 @@ void DiylFrag_Free(DiylFrag *pfrag)
     inchi_strbuf_close(&pfrag->sig);
     return;
 }
-/***************************************************************************/
+/***************************************************************************
+ Make string signature of the fragment and its hash
+
+ Only xclasses which are present in the fragment are visited, so the cost
+ is proportional to fragment size rather than to the number of molecule-wide
+ xclasses.
+***************************************************************************/
 void DiylFrag_MakeSignature(DiylFrag *pfrag, 
                             int nxc,            /* n xclasses (molecule-wide)       */
                             int *xc,            /* xclasses (molecule-wide)         */
-                            int *cnt )          /* temp storage: counts of xclasses */
+                            int *cnt,           /* temp storage: counts of xclasses,
+                                                   all zeros on entry and on exit   */
+                            int *present )      /* temp storage: xclasses present
+                                                   in the fragment, >= na elements  */
 {
-    int i, k, nxc_frag;
+    int i, k, n_present = 0;
+    unsigned long h;
+    const unsigned char *s;
     
     inchi_strbuf_printf(&pfrag->sig, "%-d,%-d,%-d{", pfrag->na, xc[pfrag->end1], xc[pfrag->end2]);
     for (i = 0; i < pfrag->na; i++)
     {
-        pfrag->xclist[i] = xc[pfrag->alist[i]];
-    }  
-    nxc_frag = count_colors_in_sequence(pfrag->xclist, pfrag->na, nxc+1, cnt);
-    for (k = 0; k < nxc; k++)
-    {
-        if (cnt[k] > 0)
+        int xci = xc[pfrag->alist[i]];
+        pfrag->xclist[i] = xci;
+        if (xci < 0 || xci >= nxc) /* removed orig atom (H D etc.) */
         {
-            /* (xclass:cnt)*/
-            inchi_strbuf_printf(&pfrag->sig, "(%-d:%-d)", k, cnt[k]);
+            continue;
+        }
+        if (0 == cnt[xci]++)
+        {
+            present[n_present++] = xci;
         }
+    }  
+    qsort(present, n_present, sizeof(present[0]), cmp_ints);
+    for (i = 0; i < n_present; i++)
+    {
+        k = present[i];
+        /* (xclass:cnt)*/
+        inchi_strbuf_printf(&pfrag->sig, "(%-d:%-d)", k, cnt[k]);
+        cnt[k] = 0;
     }
 
     inchi_strbuf_printf(&pfrag->sig, "}");
 
+    /* FNV-1a */
+    h = 2166136261UL;
+    for (s = (const unsigned char *) pfrag->sig.pStr; s && *s; s++)
+    {
+        h = ( ( h ^ *s ) * 16777619UL ) & 0xFFFFFFFFUL;
+    }
+    pfrag->hash = h;
+
     return;
 }
 /***************************************************************************
@@ -2087,6 +2132,10 @@ int DiylFrag_Diff(DiylFrag *pfrag1, DiylFrag *pfrag2)
     {
         return 1;
     }
+    if (pfrag1->hash != pfrag2->hash)
+    {
+        return 1;
+    }
     if (pfrag1->sig.nUsedLength && pfrag2->sig.nUsedLength)
     {
         int cmp = strcmp(pfrag1->sig.pStr, pfrag2->sig.pStr);
@@ -2095,6 +2144,52 @@ int DiylFrag_Diff(DiylFrag *pfrag1, DiylFrag *pfrag2)
 
     return 0;
 }
+/***************************************************************************
+ Assign class numbers to fragments, equal fragments getting the same class;
+ classes are numbered in the order of first occurrence.
+ Return number of classes or -1 on error.
+***************************************************************************/
+int DiylFrag_Classify(DiylFrag **frag, int n_frags, int *frag_class)
+{
+    int i, h, size, n_classes = 0;
+    int *table = NULL;  /* open addressing; representative fragment or -1 */
+
+    for (size = 16; size < 2 * n_frags; size *= 2)
+    {
+        ;
+    }
+    table = (int *) inchi_malloc(size * sizeof(int));
+    if (!table)
+    {
+        return -1;
+    }
+    for (h = 0; h < size; h++)
+    {
+        table[h] = -1;
+    }
+
+    for (i = 0; i < n_frags; i++)
+    {
+        h = (int) (frag[i]->hash & (unsigned long) (size - 1));
+        while (table[h] >= 0 && DiylFrag_Diff(frag[i], frag[table[h]]))
+        {
+            h = (h + 1) & (size - 1);
+        }
+        if (table[h] >= 0)
+        {
+            frag_class[i] = frag_class[table[h]];
+        }
+        else
+        {
+            table[h] = i;
+            frag_class[i] = n_classes++;
+        }
+    }
+
+    inchi_free(table);
+
+    return n_classes;
+}
 /****************************************************************************
 Debug print polymer data for a given SRU
 ****************************************************************************/
@@ -2145,6 +2240,7 @@ int analyze_CRU_folding(ORIG_ATOM_DATA *orig_at_data,
     int *frag_class=NULL;   /* fragments are classified, by their signatures, to produce unique labelling; 
                             if the two fragments have the same class, they have the same signature and whence are equivalent */
     int *frag_xc_counts = NULL; /* counts of xclass atoms in CRU, order of class numbers    */
+    int *frag_xc_present = NULL; /* xclasses present in CRU                                 */
     char pStrErr[STR_ERR_LEN];
 
     OAD_PolymerUnit *u = orig_at_data->polymer->units[iunit];
@@ -2153,7 +2249,8 @@ int analyze_CRU_folding(ORIG_ATOM_DATA *orig_at_data,
 
     /* Reserve space for frag-specific xclass counts */
     frag_xc_counts = (int *)inchi_calloc(nxclasses + 1, sizeof(int));
-    if (!frag_xc_counts)
+    frag_xc_present = (int *)inchi_calloc(u->na + 1, sizeof(int));
+    if (!frag_xc_counts || !frag_xc_present)
     {
         ret = _IS_ERROR;
         goto exit_function;
@@ -2229,7 +2326,7 @@ int analyze_CRU_folding(ORIG_ATOM_DATA *orig_at_data,
     for (i = 0; i < n_frags; i++)
     {
         /* Create fragment */
-        int forbidden[4], novel=1;
+        int forbidden[4];
         DiylFrag *pfrag = NULL; 
 
         /* Calculate and store signature of the fragment */
@@ -2274,23 +2371,19 @@ int analyze_CRU_folding(ORIG_ATOM_DATA *orig_at_data,
             goto exit_function;
         }
 
-        DiylFrag_MakeSignature(pfrag, nxclasses, xc, frag_xc_counts); 
-
-        novel = 1;
-        for (j = 0; j < i; j++)
-        {
-            if ( !DiylFrag_Diff(frag[i], frag[j]) )
-            {
-                frag_class[i] = frag_class[j];
-                novel = 0;
-                break;
-            }
-        }
-        if (novel)
-        {
-            frag_class[i] = n_frag_classes++;
-        }
+        DiylFrag_MakeSignature(pfrag, nxclasses, xc, frag_xc_counts, frag_xc_present); 
+    }
 
+    /* Classify fragments by their signatures */
+    n_frag_classes = DiylFrag_Classify(frag, n_frags, frag_class);
+    if (n_frag_classes < 0)
+    {
+        ret = _IS_ERROR;
+        goto exit_function;
+    }
+    for (i = 0; i < n_frags; i++)
+    {
+        DiylFrag *pfrag = frag[i];
         ITRACE_("\nCANDIDATE CRU SUBUNIT %-d/%-d (CLASS #%-d)\t", i+1, n_frags, frag_class[i]);
         DiylFrag_DebugTrace(pfrag);
     }
@@ -2302,6 +2395,11 @@ int analyze_CRU_folding(ORIG_ATOM_DATA *orig_at_data,
     }
         
     n_frags_in_repeating_subunit = len_repeating_subsequence(frag_class, NULL, n_frags);
+    if (n_frags_in_repeating_subunit < 0)
+    {
+        ret = _IS_ERROR;
+        goto exit_function;
+    }
     if (0 == n_frags_in_repeating_subunit)
     {
         /* valid repeating pattern not found */
@@ -2423,32 +2521,21 @@ exit_function:
     {
         inchi_free(frag_xc_counts);
     }
+    if (frag_xc_present)
+    {
+        inchi_free(frag_xc_present);
+    }
 
     return ret;
 }
 
-/***************************************************************************
- Return number of colors ncol<=maxcol in the sequence of n colored entries 
- and counts of individiual colors
-***************************************************************************/
-int count_colors_in_sequence( int *color, int n, int maxcol, int *counts)
+/***************************************************************************/
+int cmp_ints( const void *a1, const void *a2 )
 {
-    int i, ncol=0;
-    memset(counts, 0, maxcol * sizeof(int)); 
-    for (i = 0; i<n; i++) 
-    {
-        int colori = color[i];
-        if (colori < 0) /* removed orig atom (H D etc.) */
-        {
-            continue;
-        }
-        if (0==counts[colori ])
-        {
-            ncol++;
-        }
-        counts[ color[i] ]++;
-    }
-    return ncol;
+    int i1 = *(const int *) a1;
+    int i2 = *(const int *) a2;
+
+    return ( i1 > i2 ) - ( i1 < i2 );
 }
 
 
@@ -2456,34 +2543,47 @@ int count_colors_in_sequence( int *color, int n, int maxcol, int *counts)
  Find repeating starting subsequence in the sequence of n entries
  and return its length m
  each i-th entry, 0<i<m, is characterized by color[i] and optional color2[i]
+
+ The shortest period of the sequence is n - pi[n-1], where pi is the
+ prefix function (Knuth-Morris-Pratt failure function); it is accepted
+ if it does not exceed (n+1)/2.  Return -1 on allocation error.
 ***************************************************************************/
 int len_repeating_subsequence(int *color, int *color2, int n)
 {
-    int m, k;
+    int i, k, period;
+    int *pi = NULL;
 
     if (n < 2 || !color)
     {
         return 0;
     }
 
-    for (m = 0; m < (n + 1) / 2; m++)
+    pi = (int *) inchi_malloc(n * sizeof(int));
+    if (!pi)
+    {
+        return -1;
+    }
+
+    pi[0] = 0;
+    for (i = 1; i < n; i++)
     {
-        for (k = m + 1; k < n; k++)
+        k = pi[i - 1];
+        while (k > 0 &&
+               ( color[i] != color[k] || (color2 && color2[i] != color2[k]) ))
         {
-            if (color[k] != color[k - m - 1]) 
-            { 
-                goto nextm; 
-            }
-            if (color2 && color2[k] != color2[k - m - 1])
-            {
-                goto nextm;
-            }
+            k = pi[k - 1];
+        }
+        if (color[i] == color[k] && (!color2 || color2[i] == color2[k]))
+        {
+            k++;
         }
-        return (m + 1);
-nextm:	;
+        pi[i] = k;
     }
+    period = n - pi[n - 1];
 
-    return 0;
+    inchi_free(pi);
+
+    return period <= (n + 1) / 2 ? period : 0;
 }
 
 
@@ -57,6 +57,7 @@
 #include "ichicant.h"
 #include "inchi_api.h"
 #include "readinch.h"
+#include "sha2.h"
 #ifdef TARGET_LIB_FOR_WINCHI
 #include "../../../IChI_lib/src/ichi_lib.h"
 #include "inchi_api.h"
@@ -226,21 +227,8 @@ int SortAndPrintINChI( CANON_GLOBALS            *pCG,
         /* Sort component INChIs */
         for (k1 = 0; k1 < TAUT_NUM; k1++)
         {
-            switch (k1)
-            {
-                case TAUT_NON:
-                    qsort( pINChISort[j][k1],
-                           num_components[j],
-                           sizeof( pINChISort[0][0][0] ),
-                           CompINChINonTaut2 );
-                    break;
-                case TAUT_YES:
-                    qsort( pINChISort[j][k1],
-                           num_components[j],
-                           sizeof( pINChISort[0][0][0] ),
-                           CompINChITaut2 );
-                    break;
-            }
+            /* in CompINChINonTaut2() order for TAUT_NON, CompINChITaut2() for TAUT_YES */
+            SortINChIComponents( pINChISort[j][k1], num_components[j], k1 );
         }
 
 #ifndef COMPILE_ANSI_ONLY
@@ -424,8 +412,7 @@ void winchi_calc_inchikey( int            ret,
     int ik_ret = 0;           /* InChIKey-calc result code */
     int xhash1 = 0, xhash2 = 0;
     char szXtra1[256], szXtra2[256];
-    size_t slen = out_file->s.nUsedLength;
-    char *buf = NULL;
+    const char *buf = NULL;
 
     ( *ikflag )++;
     if (*ikflag != 1)
@@ -439,7 +426,11 @@ void winchi_calc_inchikey( int            ret,
         return;
     }
 
-    extract_inchi_substring( &buf, out_file->s.pStr, slen );
+    /* hash InChI in place: GetINCHIKeyFromINCHI() stops at its end */
+    if (out_file->s.pStr && out_file->s.nUsedLength)
+    {
+        buf = strstr( out_file->s.pStr, "InChI=" );
+    }
 
     /* Calculate and print InChIKey */
     if (NULL != buf)
@@ -456,7 +447,6 @@ void winchi_calc_inchikey( int            ret,
             xhash2 = 1;
         }
         ik_ret = GetINCHIKeyFromINCHI( buf, xhash1, xhash2, ik_string, szXtra1, szXtra2 );
-        inchi_free( buf );
     }
     else
     {
@@ -1447,6 +1437,200 @@ int TreatErrorsInCreateOneComponentINChI( STRUCT_DATA *sd,
 }
 
 
+/****************************************************************************
+ Input record text for CaptureSlowRecord(): the bytes read from the input
+ file, the Molfile passed to the library as text, or else the structure
+ written back as a Molfile (V2000, so only up to 999 atoms)
+****************************************************************************/
+static char *GetCaptureInputText( STRUCT_DATA     *sd,
+                                  INCHI_IOSTREAM  *inp_file,
+                                  ORIG_ATOM_DATA  *orig_inp_data,
+                                  long            *len )
+{
+    char *p = NULL;
+    INCHI_IOSTREAM tmp;
+
+    *len = 0;
+    if (inp_file && inp_file->type == INCHI_IOS_TYPE_FILE && inp_file->f &&
+         0L <= sd->fPtrStart && sd->fPtrStart < sd->fPtrEnd)
+    {
+        if (( p = (char *) inchi_malloc( sd->fPtrEnd - sd->fPtrStart + 1 ) ) &&
+             !fseek( inp_file->f, sd->fPtrStart, SEEK_SET ))
+        {
+            *len = (long) fread( p, 1, sd->fPtrEnd - sd->fPtrStart, inp_file->f );
+        }
+        fseek( inp_file->f, sd->fPtrEnd, SEEK_SET ); /* the reader goes on from here */
+    }
+    else if (inp_file && inp_file->type == INCHI_IOS_TYPE_STRING && inp_file->s.pStr)
+    {
+        *len = (long) strlen( inp_file->s.pStr );
+        if (( p = (char *) inchi_malloc( *len + 1 ) ))
+        {
+            memcpy( p, inp_file->s.pStr, *len );
+        }
+    }
+    else if (orig_inp_data && orig_inp_data->num_inp_atoms <= 999)
+    {
+        inchi_ios_init( &tmp, INCHI_IOS_TYPE_STRING, NULL );
+        OrigAtData_WriteToSDfile( orig_inp_data, &tmp, "Captured structure", NULL,
+                                  ( sd->bChiralFlag & FLAG_INP_AT_CHIRAL ) ? 1 : 0, 0, NULL, NULL );
+        p = tmp.s.pStr;
+        *len = p ? tmp.s.nUsedLength : 0;
+        tmp.s.pStr = NULL;
+        inchi_ios_close( &tmp );
+    }
+    if (p && !*len)
+    {
+        inchi_free( p );
+        p = NULL;
+    }
+
+    return p;
+}
+
+
+/****************************************************************************
+ Option CaptureSlow: if the structure took at least ip->msec_CaptureSlow
+ msec or timed out, save its input as <dir>/slow-<hash>.mol and its
+ options, result and stage timings of each component as slow-<hash>.txt.
+ The hash covers input and options, so a repeated record reuses its files.
+****************************************************************************/
+void CaptureSlowRecord( STRUCT_DATA     *sd,
+                        INPUT_PARMS     *ip,
+                        PINChI_Aux2     *pINChI_Aux[INCHI_NUM],
+                        INCHI_IOSTREAM  *inp_file,
+                        INCHI_IOSTREAM  *log_file,
+                        ORIG_ATOM_DATA  *orig_inp_data,
+                        long            num_inp,
+                        int             nRet,
+                        long            lPeakMem )
+{
+    static const char *szRecMet[INCHI_NUM] = { "", " (reconnected)" };
+    char szPath[sizeof( ip->szCaptureDir ) + 64], *pName;
+    char *pInp;
+    long len, lNormTime = 0, lCanonTime = 0, lStereoTime = 0, lOther;
+    unsigned char digest[32];
+    sha2_context ctx;
+    FILE *f;
+    int i, j, k, len_dir;
+    INChI_Aux *pAux, *pAuxStat;
+
+    if (!ip->msec_CaptureSlow ||
+         (long) sd->ulStructTime < ip->msec_CaptureSlow && sd->nErrorCode != CT_TIMEOUT_ERR)
+    {
+        return;
+    }
+
+    pInp = GetCaptureInputText( sd, inp_file, orig_inp_data, &len );
+
+    sha2_starts( &ctx );
+    if (pInp)
+    {
+        sha2_update( &ctx, (unsigned char *) pInp, (int) len );
+    }
+    sha2_update( &ctx, (unsigned char *) ip->szCaptureOptions, (int) strlen( ip->szCaptureOptions ) );
+    sha2_finish( &ctx, digest );
+
+    len_dir = (int) strlen( ip->szCaptureDir );
+    if (len_dir)
+    {
+        strcpy( szPath, ip->szCaptureDir );
+        if (szPath[len_dir - 1] != INCHI_PATH_DELIM && szPath[len_dir - 1] != '/')
+        {
+            szPath[len_dir++] = INCHI_PATH_DELIM;
+        }
+    }
+    pName = szPath + len_dir;
+    sprintf( pName, "slow-%02x%02x%02x%02x%02x%02x%02x%02x.mol",
+             digest[0], digest[1], digest[2], digest[3], digest[4], digest[5], digest[6], digest[7] );
+
+    /* input */
+    if (pInp)
+    {
+        if (( f = fopen( szPath, "wb" ) ))
+        {
+            fwrite( pInp, 1, len, f );
+            fclose( f );
+        }
+        else
+        {
+            inchi_ios_eprint( log_file, "Warning: cannot create capture file %s\n", szPath );
+        }
+        inchi_free( pInp );
+    }
+
+    /* profile */
+    strcpy( pName + strlen( pName ) - 4, ".txt" );
+    if (!( f = fopen( szPath, "w" ) ))
+    {
+        inchi_ios_eprint( log_file, "Warning: cannot create capture file %s\n", szPath );
+        return;
+    }
+    fprintf( f, "Structure #%ld.%s%s%s%s\n", num_inp, SDF_LBL_VAL( ip->pSdfLabel, ip->pSdfValue ) );
+    fprintf( f, "Options: %s\n", ip->szCaptureOptions );
+    fprintf( f, "Input: %s\n", pInp ? "saved" : "not saved" );
+    fprintf( f, "Result: %d, error %d%s%s\n", nRet, sd->nErrorCode,
+             sd->pStrErrStruct[0] ? ", " : "", sd->pStrErrStruct );
+    fprintf( f, "Time: %lu msec\n", sd->ulStructTime );
+    if (lPeakMem >= 0)
+    {
+        fprintf( f, "Peak heap: %ld KB\n", ( lPeakMem + 1023 ) / 1024 );
+    }
+    if (orig_inp_data)
+    {
+        fprintf( f, "Atoms: %d\n", orig_inp_data->num_inp_atoms );
+    }
+    for (i = 0; i < INCHI_NUM; i++)
+    {
+        if (!pINChI_Aux[i])
+        {
+            continue;
+        }
+        for (j = 0; j < sd->num_components[i]; j++)
+        {
+            /* normalization and base ranking are shared by mobile- and fixed-H */
+            /* results, Canon_INChI() runs for each of them                     */
+            pAux = pAuxStat = NULL;
+            len = 0;
+            for (k = TAUT_NUM - 1; 0 <= k; k--)
+            {
+                if (pINChI_Aux[i][j][k])
+                {
+                    pAux = pINChI_Aux[i][j][k];
+                    if (!pAuxStat || !pAuxStat->nNumberOfAtoms)
+                    {
+                        pAuxStat = pAux;
+                    }
+                    len += pAux->lStereoTime;
+                }
+            }
+            if (!pAuxStat)
+            {
+                continue;
+            }
+            fprintf( f, "Component %d%s: %d atoms; msec: normalization %ld, base ranking %ld, stereo/isotopic %ld; |Aut| = %.6g, %ld generator(s), %ld leaf CT(s), %ld stereo mapping step(s)\n",
+                     j + 1, szRecMet[i], pAuxStat->nNumberOfAtoms,
+                     pAuxStat->lNormTime, pAuxStat->lCanonTime, len,
+                     pAuxStat->dGroupSize, pAuxStat->lNumGenerators, pAuxStat->lNumCanonTotCT,
+                     pAuxStat->lNumStereoMapSteps );
+            lNormTime += pAuxStat->lNormTime;
+            lCanonTime += pAuxStat->lCanonTime;
+            lStereoTime += len;
+        }
+    }
+    lOther = (long) sd->ulStructTime - lNormTime - lCanonTime - lStereoTime;
+    fprintf( f, "Total msec: normalization %ld, base ranking %ld, stereo/isotopic %ld, other %ld\n",
+             lNormTime, lCanonTime, lStereoTime, lOther > 0 ? lOther : 0 );
+    fclose( f );
+
+    pName[strlen( pName ) - 4] = '\0';
+    inchi_ios_eprint( log_file, "Structure #%ld: %lu msec, captured as %s.mol/.txt%s%s%s%s\n",
+                      num_inp, sd->ulStructTime, szPath, SDF_LBL_VAL( ip->pSdfLabel, ip->pSdfValue ) );
+
+    return;
+}
+
+
 /****************************************************************************/
 int TreatCreateINChIWarning( STRUCT_DATA    *sd,
                              INPUT_PARMS    *ip,
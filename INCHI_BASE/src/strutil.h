@@ -265,6 +265,7 @@ extern "C" {
     int CompINChINonTaut2( const void *p1, const void *p2 );
     int CompINChITaut2( const void *p1, const void *p2 );
     int CompINChI2( const INCHI_SORT *p1, const INCHI_SORT *p2, int bTaut, int bCompareIsotopic );
+    void SortINChIComponents( INCHI_SORT *pINChISort, int num_components, int bTaut );
     int CompINChITautVsNonTaut( const INCHI_SORT *p1, const INCHI_SORT *p2, int bCompareIsotopic );
 
     typedef enum tagDiffINChISegments
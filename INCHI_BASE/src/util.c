@@ -38,6 +38,19 @@
 
 #include "mode.h"
 
+#if ( INCHI_MEM_STAT == 1 )
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#define inchi_mem_block_size(P) malloc_size(P)
+#elif defined(_WIN32)
+#include <malloc.h>
+#define inchi_mem_block_size(P) _msize(P)
+#else
+#include <malloc.h>
+#define inchi_mem_block_size(P) malloc_usable_size(P)
+#endif
+#endif
+
 #if defined(COMPILE_ANSI_ONLY) && defined(__APPLE__)
 /*    For build under OSX, advice from Burt Leland */
 #include "ichicomp.h"    /* Needed for __isascii define */
@@ -1522,6 +1535,97 @@ void inchi_free( void *p )
 #endif
 
 
+#if ( INCHI_MEM_STAT == 1 )
+
+/* Bytes currently held and their peak; counted only while bOn is set.  */
+/* Blocks obtained before inchi_mem_stat_begin() and released after it  */
+/* are subtracted too, so the current value is clipped at zero.         */
+static INCHI_THREAD_LOCAL int    bMemStatOn;
+static INCHI_THREAD_LOCAL size_t nMemStatCur;
+static INCHI_THREAD_LOCAL size_t nMemStatPeak;
+
+
+/****************************************************************************/
+static void *inchi_mem_count( void *p )
+{
+    if (p && bMemStatOn)
+    {
+        nMemStatCur += inchi_mem_block_size( p );
+        if (nMemStatCur > nMemStatPeak)
+        {
+            nMemStatPeak = nMemStatCur;
+        }
+    }
+
+    return p;
+}
+
+
+/****************************************************************************/
+void *inchi_mem_malloc( size_t c )
+{
+    return inchi_mem_count( malloc( c ) );
+}
+
+
+/****************************************************************************/
+void *inchi_mem_calloc( size_t c, size_t n )
+{
+    return inchi_mem_count( calloc( c, n ) );
+}
+
+
+/****************************************************************************/
+void inchi_mem_free( void *p )
+{
+    size_t len;
+
+    if (p && bMemStatOn)
+    {
+        len = inchi_mem_block_size( p );
+        nMemStatCur = nMemStatCur > len ? nMemStatCur - len : 0;
+    }
+    free( p );
+}
+
+
+/****************************************************************************/
+void inchi_mem_stat_begin( void )
+{
+    nMemStatCur = nMemStatPeak = 0;
+    bMemStatOn = 1;
+}
+
+
+/****************************************************************************
+ Returns peak heap bytes since inchi_mem_stat_begin() on this thread
+****************************************************************************/
+long inchi_mem_stat_end( void )
+{
+    bMemStatOn = 0;
+
+    return (long) nMemStatPeak;
+}
+
+#else
+
+/****************************************************************************/
+void inchi_mem_stat_begin( void )
+{
+}
+
+
+/****************************************************************************
+ Heap accounting is not available in this build
+****************************************************************************/
+long inchi_mem_stat_end( void )
+{
+    return -1;
+}
+
+#endif
+
+
 /*
     STRINGS AND TEXT HANDLING
 */
@@ -1763,6 +1867,48 @@ char* lrtrim( char *p, int* nLen )
 }
 
 
+ /****************************************************************************
+   Number of leading characters of p which may occur in InChI, that is,
+   the length of the InChI string starting at p if it is embedded into
+   a longer string (see extract_inchi_substring() below)
+****************************************************************************/
+size_t inchi_substring_length( const char *p )
+{
+    size_t i;
+    char pp;
+
+    for (i = 0; ; i++)
+    {
+        pp = p[i];
+
+        if (pp >= 'A' && pp <= 'Z')   continue;
+        if (pp >= 'a' && pp <= 'z')   continue;
+        if (pp >= '0' && pp <= '9')   continue;
+        switch (pp)
+        {
+            case '(':
+            case ')':
+            case '*':
+            case '+':
+            case ',':
+            case '-':
+            case '.':
+            case '/':
+            case ';':
+            case '=':
+            case '?':
+            case '@':    continue;
+
+            default:    break;
+        }
+
+        break;
+    }
+
+    return i;
+}
+
+
  /****************************************************************************
    Extract InChI substring embedded into a longer string.
 
@@ -1791,7 +1937,6 @@ void extract_inchi_substring( char ** buf, const char *str, size_t slen )
 {
     size_t i;
     const char *p;
-    char pp;
 
 
     *buf = NULL;
@@ -1809,32 +1954,10 @@ void extract_inchi_substring( char ** buf, const char *str, size_t slen )
     if (NULL == p)
         return;
 
-    for (i = 0; i < slen; i++)
+    i = inchi_substring_length( p );
+    if (i > slen)
     {
-        pp = p[i];
-
-        if (pp >= 'A' && pp <= 'Z')   continue;
-        if (pp >= 'a' && pp <= 'z')   continue;
-        if (pp >= '0' && pp <= '9')   continue;
-        switch (pp)
-        {
-            case '(':
-            case ')':
-            case '*':
-            case '+':
-            case ',':
-            case '-':
-            case '.':
-            case '/':
-            case ';':
-            case '=':
-            case '?':
-            case '@':    continue;
-
-            default:    break;
-        }
-
-        break;
+        i = slen;
     }
 
     *buf = (char*) inchi_calloc( i + 1, sizeof( char ) );
@@ -108,6 +108,7 @@ extern "C" {
     int *is_in_the_ilist( int *pathAtom, int nNextAtom, int nPathLen );
     int is_ilist_inside( int *ilist, int nlist, int *ilist2, int nlist2 );
 
+    size_t inchi_substring_length(const char *p);
     void extract_inchi_substring(char ** buf, const char *str, size_t slen);
     void extract_auxinfo_substring(char ** buf, const char *str, size_t slen);
     int extract_orig_nums_from_auxinfo_string(char *saux, int *orig);
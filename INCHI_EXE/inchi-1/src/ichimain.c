@@ -65,6 +65,7 @@
 #include "../../INCHI_BASE/src/ichimain.h"
 #include "../../INCHI_BASE/src/ichicomp.h"
 #include "../../INCHI_BASE/src/ichi_io.h"
+#include "../../INCHI_BASE/src/mol_fmt.h"
 #ifdef TARGET_EXE_STANDALONE
 #include "../../INCHI_BASE/src/inchi_api.h"
 #endif
@@ -765,6 +766,15 @@ int ProcessSingleInputFile( int argc, char *argv[] )
     }
     output_error_inchi = ip->bINChIOutputOptions2 & INCHI_OUT_INCHI_GEN_ERROR;
 
+    /* SdfIndex: go directly to the first record to be processed */
+    if (ip->bSdfIndex && !pStructPtrs && !ip->bGetMolfileNumber &&
+        ( ip->nInputType == INPUT_MOLFILE || ip->nInputType == INPUT_SDFILE ) &&
+        inp_file->f != stdin)
+    {
+        num_inp = SDFileIndexSeek( &ic, ip, inp_file, plog );
+        inchi_ios_flush2( plog, stderr );
+    }
+
 
     /*************************************************************/
     /*  Main cycle : read input structures and create their INChI                                  */
@@ -1201,10 +1211,8 @@ int CalcAndPrintINCHIAndINCHIKEY( struct tagINCHI_CLOCK *ic,
 
     if (ip->bCalcInChIHash != INCHIHASH_NONE)
     {
-        char *buf = NULL;
-        size_t slen = pout0->s.nUsedLength;
-
-        extract_inchi_substring( &buf, pout0->s.pStr, slen );
+        /* hash InChI in place: GetINCHIKeyFromINCHI() stops at its end */
+        const char *buf = pout0->s.pStr && pout0->s.nUsedLength ? strstr( pout0->s.pStr, "InChI=" ) : NULL;
 
         if (NULL == buf)
         {
@@ -1224,7 +1232,6 @@ int CalcAndPrintINCHIAndINCHIKEY( struct tagINCHI_CLOCK *ic,
                 xhash2 = 1;
             }
             ik_ret = GetINCHIKeyFromINCHI( buf, xhash1, xhash2, ik_string, szXtra1, szXtra2 );
-            inchi_free( buf );
         }
 
 
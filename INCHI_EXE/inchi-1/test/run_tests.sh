@@ -0,0 +1,129 @@
+#!/bin/sh
+#
+# Regression tests of inchi-1 options.
+#
+# Usage: run_tests.sh [path to inchi-1]
+#        (default: ../../bin/Linux/inchi-1, as made by ../gcc/makefile)
+# Returns the number of failed tests (0 if all passed).
+#
+
+INCHI=${1:-../../bin/Linux/inchi-1}
+TMP=${TMPDIR:-/tmp}/inchi-1-test.$$
+FAILED=0
+
+mkdir -p "$TMP" || exit 1
+trap 'rm -rf "$TMP"' 0
+
+fail()
+{
+    echo "FAILED: $1"
+    FAILED=`expr $FAILED + 1`
+}
+
+# Molfile of an n x n grid of carbon atoms, $1 = n, $2 = name;
+# a highly symmetric structure which takes some msec (n <= 22: V2000 counts)
+grid_mol()
+{
+    awk -v n="$1" -v name="$2" 'BEGIN {
+        nb = 2 * n * ( n - 1 );
+        printf "%s\n  grid\n\n%3d%3d  0  0  0  0  0  0  0  0999 V2000\n", name, n * n, nb;
+        for (i = 0; i < n; i++)
+            for (j = 0; j < n; j++)
+                printf "%10.4f%10.4f%10.4f C   0  0  0  0  0  0  0  0  0  0  0  0\n", 1.5 * i, 1.5 * j, 0;
+        for (i = 0; i < n; i++)
+            for (j = 0; j < n; j++)
+            {
+                k = i * n + j + 1;
+                if (i + 1 < n) printf "%3d%3d  1  0  0  0  0\n", k, k + n;
+                if (j + 1 < n) printf "%3d%3d  1  0  0  0  0\n", k, k + 1;
+            }
+        printf "M  END\n$$$$\n";
+    }'
+}
+
+# Molfile of a chain of $1 carbon atoms, $2 = name
+chain_mol()
+{
+    awk -v n="$1" -v name="$2" 'BEGIN {
+        printf "%s\n  chain\n\n%3d%3d  0  0  0  0  0  0  0  0999 V2000\n", name, n, n - 1;
+        for (i = 0; i < n; i++)
+            printf "%10.4f%10.4f%10.4f C   0  0  0  0  0  0  0  0  0  0  0  0\n", 1.5 * i, 0, 0;
+        for (i = 1; i < n; i++)
+            printf "%3d%3d  1  0  0  0  0\n", i, i + 1;
+        printf "M  END\n$$$$\n";
+    }'
+}
+
+# InChI strings of an output file
+inchi_of()
+{
+    grep '^InChI=' "$1"
+}
+
+
+#
+# CaptureSlow: a record captured in a run with START: is replayed with the
+# saved options
+#
+{
+    chain_mol 3 propane
+    chain_mol 4 butane
+    grid_mol 20 grid
+} > "$TMP/capture.sdf"
+mkdir -p "$TMP/capture"
+"$INCHI" "$TMP/capture.sdf" "$TMP/capture.out" "$TMP/capture.log" "$TMP/capture.prb" \
+    -START:3 -Key -CaptureSlow:1 -CaptureDir:"$TMP/capture" > /dev/null 2>&1
+set -- "$TMP"/capture/slow-*.txt
+if [ ! -f "$1" ]; then
+    fail "CaptureSlow: record not captured"
+else
+    OPTIONS=`sed -n 's/^Options: //p' "$1"`
+    case "$OPTIONS" in
+        *START*|*Capture*) fail "CaptureSlow: record selection saved in options \"$OPTIONS\"" ;;
+    esac
+    "$INCHI" "${1%.txt}.mol" "$TMP/replay.out" "$TMP/replay.log" "$TMP/replay.prb" \
+        $OPTIONS > /dev/null 2>&1
+    if [ -z "`inchi_of "$TMP/capture.out"`" ] ||
+       [ "`inchi_of "$TMP/capture.out"`" != "`inchi_of "$TMP/replay.out"`" ]; then
+        fail "CaptureSlow: replay of captured record with \"$OPTIONS\""
+    fi
+fi
+
+
+#
+# WM: a structure taking many times the time limit is stopped
+#
+grid_mol 22 grid > "$TMP/timeout.sdf"
+"$INCHI" "$TMP/timeout.sdf" "$TMP/timeout.out" "$TMP/timeout.log" "$TMP/timeout.prb" \
+    -WM5 > /dev/null 2>&1
+if [ -n "`inchi_of "$TMP/timeout.out"`" ]; then
+    fail "WM: time limit of 5 msec has not stopped the calculation"
+fi
+
+
+#
+# SdfIndex: START:n with the SD file index gives the same output as without,
+# also past blank and unreadable records
+#
+{
+    chain_mol 3 propane
+    printf '\n$$$$\n'
+    chain_mol 4 butane
+    printf '  \n\t\n$$$$\n'
+    printf 'junk\nmore junk\n$$$$\n'
+    chain_mol 5 pentane
+    chain_mol 6 hexane
+} > "$TMP/index.sdf"
+for n in 1 2 3 4 5 6; do
+    "$INCHI" "$TMP/index.sdf" "$TMP/seq.out" "$TMP/seq.log" "$TMP/seq.prb" \
+        -START:$n -AuxNone > /dev/null 2>&1
+    "$INCHI" "$TMP/index.sdf" "$TMP/idx.out" "$TMP/idx.log" "$TMP/idx.prb" \
+        -START:$n -AuxNone -SdfIndex > /dev/null 2>&1
+    if ! cmp -s "$TMP/seq.out" "$TMP/idx.out"; then
+        fail "SdfIndex: output of START:$n differs from sequential run"
+    fi
+done
+
+
+echo "$FAILED test(s) failed"
+exit $FAILED